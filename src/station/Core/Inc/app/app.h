@@ -33,6 +33,7 @@ extern "C"
         sensor_handle sensor;
         spi_bus_manager spi_mgr;
         spi_bus_transaction app_spiq_storage[64];
+        spi_bus_transaction app_spiq_prio_storage[8];
         app_device_data local, remote, last_local, last_remote;
         hourly_clock_timestamp_t last_sensor_read_time;
         hourly_clock_timestamp_t last_battery_read_time;
@@ -49,6 +50,7 @@ extern "C"
     void app_spi_txrx_cplt_callback(app_handle *handle, SPI_HandleTypeDef *hspi);
     void app_spi_txrx_half_cplt_callback(app_handle *handle, SPI_HandleTypeDef *hspi);
     void app_spi_error_callback(app_handle *handle, SPI_HandleTypeDef *hspi);
+    void app_tim_period_elapsed_callback(app_handle *handle, TIM_HandleTypeDef *htim);
 
 #ifdef __cplusplus
 }
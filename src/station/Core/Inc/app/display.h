@@ -31,6 +31,14 @@ extern "C"
      */
     void display_init(display_handle *handle);
 
+    /**
+     * @brief Pass the ambient temperature to the panel driver (temperature-compensated LUTs)
+     *
+     * @param handle Pointer to the display handle
+     * @param celsius Latest local temperature reading in °C
+     */
+    void display_set_temperature(display_handle *handle, const float celsius);
+
     /**
      * @brief Main display loop to update the display if needed
      *
@@ -33,6 +33,39 @@ extern "C"
 #define EPD3IN7_DRIVER_BUSY_TIMEOUT 12000
 #define EPD3IN7_DRIVER_SPI_TIMEOUT HAL_MAX_DELAY
 
+/**
+ * @brief Fastest SPI clock for panel writes (50 ns write cycle); the bus manager picks the prescaler for DMA transfers
+ */
+#define EPD3IN7_DRIVER_SPI_MAX_HZ 20000000
+
+/**
+ * @brief Temperature bands of the waveform LUTs (°C, see epd3in7_driver_set_temperature())
+ */
+#define EPD3IN7_DRIVER_TEMP_COLD_BELOW 10    /* Phase lengths x1.5 below */
+#define EPD3IN7_DRIVER_TEMP_FREEZING_BELOW 0 /* Phase lengths x2 below */
+#define EPD3IN7_DRIVER_TEMP_HYSTERESIS 1     /* Extra warming needed to leave a colder band */
+
+/**
+ * @brief 1: pick the COLD / FREEZING LUTs from the temperature. 0: always NORMAL. Their phase
+ *        scaling is an estimate, not the panel maker's cold waveforms: keep 0 until checked on a panel.
+ */
+#ifndef EPD3IN7_DRIVER_TEMP_BANDS
+#define EPD3IN7_DRIVER_TEMP_BANDS 0
+#endif
+
+/**
+ * @brief Bus manager tags of queued frame work (see epd3in7_driver_cancel_frame_dma())
+ */
+#define EPD3IN7_DRIVER_TAG_UPLOAD 1  /* RAM window setup and frame data (streamed bands included) */
+#define EPD3IN7_DRIVER_TAG_REFRESH 2 /* LUT write and display update */
+#define EPD3IN7_DRIVER_TAG_SLEEP 3   /* Sleep sequence */
+#define EPD3IN7_DRIVER_TAG_WINDOW 4  /* Area RAM window setup (reads the handle's area_window) */
+
+/**
+ * @brief Ops of the area RAM window program (WAIT, 4x command + data, WRITE_RAM)
+ */
+#define EPD3IN7_DRIVER_AREA_PROGRAM_LEN 10
+
     /**
      * @brief Display modes
      */
@@ -54,6 +87,17 @@ extern "C"
         EPD3IN7_DRIVER_LUT_1_GRAY_A2 = 3  /**< 1-bit (black & white), A2 fast mode */
     } epd3in7_driver_lut_type;
 
+    /**
+     * @brief Temperature band of the LUTs in use
+     */
+    typedef enum
+    {
+        EPD3IN7_DRIVER_TEMP_BAND_NORMAL = 0,   /**< Room temperature waveforms */
+        EPD3IN7_DRIVER_TEMP_BAND_COLD = 1,     /**< Below EPD3IN7_DRIVER_TEMP_COLD_BELOW */
+        EPD3IN7_DRIVER_TEMP_BAND_FREEZING = 2, /**< Below EPD3IN7_DRIVER_TEMP_FREEZING_BELOW */
+        EPD3IN7_DRIVER_TEMP_BAND_COUNT
+    } epd3in7_driver_temp_band;
+
     /**
      * @brief Sleep modes
      */
@@ -73,6 +117,7 @@ extern "C"
         EPD3IN7_DRIVER_ERR_TIMEOUT = -2, /**< Operation timed out */
         EPD3IN7_DRIVER_ERR_PARAM = -3,   /**< Invalid parameter provided */
         EPD3IN7_DRIVER_SPI_BUS_ERR = -4, /**< SPI bus manager error */
+        EPD3IN7_DRIVER_ERR_BUSY = -5,    /**< Previous area update still queued */
     } epd3in7_driver_status;
 
     /**
@@ -93,6 +138,24 @@ extern "C"
         uint16_t cs_pin;       /**< CS pin number */
     } epd3in7_driver_pins;
 
+    /**
+     * @brief Rectangle in panel RAM coordinates (280 x 480 portrait)
+     */
+    typedef struct
+    {
+        uint16_t x; /**< Left edge, multiple of 8 */
+        uint16_t y; /**< Top edge */
+        uint16_t w; /**< Width, multiple of 8 */
+        uint16_t h; /**< Height */
+    } epd3in7_driver_area;
+
+    /**
+     * @brief Band producer of epd3in7_driver_display_1_gray_stream_dma(): write panel rows
+     *        [row, row + rows) of the streamed rectangle to @p dst, packed (area w / 8 bytes per row).
+     *        Runs from the DMA half-transfer interrupt: keep it short and ISR-safe.
+     */
+    typedef void (*epd3in7_driver_fill_fn)(void *user, uint16_t row, uint16_t rows, uint8_t *dst);
+
     /**
      * @brief Handle structure for the e-Paper display
      */
@@ -107,6 +170,24 @@ extern "C"
         bool is_cs_low_has_value;         /**< Flag indicating CS pin state is defined */
         epd3in7_driver_lut_type last_lut; /**< Last LUT type that was sent */
         bool last_lut_has_value;          /**< Flag indicating if LUT was already sent */
+        epd3in7_driver_temp_band last_lut_band; /**< Temperature band of the last LUT sent */
+        epd3in7_driver_temp_band temp_band;     /**< Temperature band for the next LUT load */
+        spi_bus_device bus_dev;           /**< Bus manager device profile (registered on first DMA use) */
+        uint8_t bus_dev_id;               /**< Device index in the bus manager */
+        bool bus_dev_has_value;           /**< Flag indicating the profile is registered */
+        uint8_t area_window[12];          /**< RAM X/Y start-end and counters of the queued area update */
+        spi_bus_op area_prog[EPD3IN7_DRIVER_AREA_PROGRAM_LEN]; /**< Program writing area_window (DMA) */
+        spi_bus_device stream_dev;        /**< Profile of streamed bands: same lines, half-transfer refill */
+        uint8_t stream_dev_id;            /**< Device index of stream_dev in the bus manager */
+        bool stream_dev_has_value;        /**< Flag indicating stream_dev is registered */
+        epd3in7_driver_fill_fn stream_fill; /**< Band producer of the queued stream */
+        void *stream_user;                /**< User pointer of stream_fill */
+        uint8_t *stream_bands;            /**< Two band slots of stream_band_size bytes */
+        uint16_t stream_band_size;        /**< Bytes per band slot */
+        uint16_t stream_band_rows;        /**< Rows per band */
+        uint16_t stream_band_count;       /**< Bands of the queued stream */
+        volatile uint16_t stream_halves;  /**< Band half-transfers seen (ISR side) */
+        epd3in7_driver_area stream_area;  /**< Rectangle of the queued stream */
     } epd3in7_driver_handle;
 
     /**
@@ -119,6 +200,18 @@ extern "C"
      */
     epd3in7_driver_handle epd3in7_driver_create(const epd3in7_driver_pins pins, SPI_HandleTypeDef *spi_handle, const bool busy_active_high);
 
+    /**
+     * @brief Select the waveform LUTs for the ambient temperature (e.g. the latest sensor reading).
+     *        Below EPD3IN7_DRIVER_TEMP_COLD_BELOW / EPD3IN7_DRIVER_TEMP_FREEZING_BELOW the phases of
+     *        every LUT are driven 1.5x / 2x longer, so DU and A2 still settle in the cold. The new LUT
+     *        is sent with the next refresh (the driver caches which LUT and band the panel holds).
+     *        With EPD3IN7_DRIVER_TEMP_BANDS 0 (default) the band stays NORMAL.
+     *
+     * @param handle Pointer to the e-Paper display handle
+     * @param celsius Ambient temperature in °C
+     */
+    void epd3in7_driver_set_temperature(epd3in7_driver_handle *handle, const float celsius);
+
     /**
      * @brief Check if the display is currently busy
      *
@@ -248,6 +341,28 @@ extern "C"
 
     // === DMA / SPI BUS MANAGER DECLARATIONS ===
 
+    /**
+     * @brief Initialize the display for 4-gray level operation through spi_bus_manager.
+     *        Non-blocking: queues the same command program as epd3in7_driver_init_4_gray()
+     *        (RESET pulse, delays and BUSY waits included); the manager runs it from interrupts
+     *        and spi_bus_manager_on_tick(). Transactions queued afterwards run after the init.
+     *
+     * @param handle Driver handle
+     * @param mgr    SPI bus manager (must be configured for the same SPI)
+     * @return epd3in7_driver_status Operation status (enqueue-time only)
+     */
+    epd3in7_driver_status epd3in7_driver_init_4_gray_dma(epd3in7_driver_handle *handle, spi_bus_manager *mgr);
+
+    /**
+     * @brief Initialize the display for 1-gray level operation through spi_bus_manager.
+     *        Non-blocking counterpart of epd3in7_driver_init_1_gray() (same command program).
+     *
+     * @param handle Driver handle
+     * @param mgr    SPI bus manager (must be configured for the same SPI)
+     * @return epd3in7_driver_status Operation status (enqueue-time only)
+     */
+    epd3in7_driver_status epd3in7_driver_init_1_gray_dma(epd3in7_driver_handle *handle, spi_bus_manager *mgr);
+
     /**
      * @brief Send the 1-gray level (black & white) image buffer via DMA using spi_bus_manager.
      *        Non-blocking: the function only enqueues transactions and returns.
@@ -263,6 +378,87 @@ extern "C"
                                                             const uint8_t *image,
                                                             const epd3in7_driver_mode mode);
 
+    /**
+     * @brief Write a rectangle of 1-gray RAM via DMA and refresh the display (non-blocking).
+     *        Only the rectangle's bytes go over SPI: the RAM window and address counters are narrowed
+     *        to @p area before WRITE_RAM; the rest of the panel RAM keeps its previous content, so the
+     *        panel must have received a full frame since init. The refresh itself covers the whole panel.
+     *
+     * @param handle Driver handle
+     * @param mgr    SPI bus manager (must be configured for the same SPI)
+     * @param image  Packed rows of the rectangle (area->w / 8 bytes each, area->h rows)
+     * @param area   Rectangle in panel coordinates; x and w must be multiples of 8
+     * @param mode   GC / DU / A2
+     * @return epd3in7_driver_status Operation status (enqueue-time only);
+     *         EPD3IN7_DRIVER_ERR_BUSY while the window of the previous area update is still queued
+     *         (the handle holds one window)
+     */
+    epd3in7_driver_status epd3in7_driver_display_1_gray_area_dma(epd3in7_driver_handle *handle,
+                                                                 spi_bus_manager *mgr,
+                                                                 const uint8_t *image,
+                                                                 const epd3in7_driver_area *area,
+                                                                 const epd3in7_driver_mode mode);
+
+    /**
+     * @brief Write a rectangle of 1-gray RAM (or the whole frame) via DMA from two band buffers and refresh
+     *        (non-blocking). @p fill produces the rectangle @p band_rows rows at a time: bands 0 and 1 before
+     *        this returns, band j+1 from the half-transfer interrupt of band j, into the slot band j-1 has
+     *        just left. No frame-sized staging buffer is needed and producing a band overlaps sending one.
+     *        Rectangle rules as in epd3in7_driver_display_1_gray_area_dma(); a full-panel rectangle uses
+     *        the full-frame window.
+     *
+     * @param handle    Driver handle
+     * @param mgr       SPI bus manager (must be configured for the same SPI)
+     * @param area      Rectangle in panel coordinates; x and w must be multiples of 8
+     * @param bands     Two band slots of @p band_size bytes (at least band_rows * area->w / 8 each),
+     *                  in use until the upload is done or cancelled
+     * @param band_size Bytes per band slot
+     * @param band_rows Rows per band (the last band may be shorter)
+     * @param fill      Band producer
+     * @param user      User pointer for @p fill
+     * @param mode      GC / DU / A2
+     * @return epd3in7_driver_status Operation status (enqueue-time only);
+     *         EPD3IN7_DRIVER_ERR_BUSY while a previous stream (or area window) is still queued
+     */
+    epd3in7_driver_status epd3in7_driver_display_1_gray_stream_dma(epd3in7_driver_handle *handle,
+                                                                   spi_bus_manager *mgr,
+                                                                   const epd3in7_driver_area *area,
+                                                                   uint8_t *bands,
+                                                                   uint16_t band_size,
+                                                                   uint16_t band_rows,
+                                                                   epd3in7_driver_fill_fn fill,
+                                                                   void *user,
+                                                                   const epd3in7_driver_mode mode);
+
+    /**
+     * @brief Split a 4-gray (I2) image into the controller's two RAM planes, 32 bits of input per step.
+     *        I2 is 2 bits per pixel, MSB first, 3 = white, 2 = light gray, 1 = dark gray, 0 = black
+     *        (the layout of epd3in7_driver_display_4_gray()). The low bit of each pixel goes to
+     *        @p plane_ram (WRITE_RAM), the high bit to @p plane_ram2 (WRITE_RAM2).
+     *
+     * @param image       I2 image
+     * @param plane_ram   Output, image_bytes / 2 bytes
+     * @param plane_ram2  Output, image_bytes / 2 bytes
+     * @param image_bytes Size of the I2 image (multiple of 4)
+     */
+    void epd3in7_driver_i2_to_planes(const uint8_t *image, uint8_t *plane_ram, uint8_t *plane_ram2, uint32_t image_bytes);
+
+    /**
+     * @brief Send a 4-gray frame via DMA using spi_bus_manager and refresh the display (GC, non-blocking).
+     *        The display must be initialized with epd3in7_driver_init_4_gray_dma(). Both planes are
+     *        read by DMA after the call returns: keep them untouched until the frame is done.
+     *
+     * @param handle     Driver handle
+     * @param mgr        SPI bus manager (must be configured for the same SPI)
+     * @param plane_ram  Low bit plane (WIDTH*HEIGHT/8 bytes), see epd3in7_driver_i2_to_planes()
+     * @param plane_ram2 High bit plane (WIDTH*HEIGHT/8 bytes)
+     * @return epd3in7_driver_status Operation status (enqueue-time only)
+     */
+    epd3in7_driver_status epd3in7_driver_display_4_gray_dma(epd3in7_driver_handle *handle,
+                                                            spi_bus_manager *mgr,
+                                                            const uint8_t *plane_ram,
+                                                            const uint8_t *plane_ram2);
+
     /**
      * @brief Put the display to sleep using DMA transactions (non-blocking).
      *        Enqueued after display update to protect the panel.
@@ -271,6 +467,21 @@ extern "C"
                                                    spi_bus_manager *mgr,
                                                    const epd3in7_driver_sleep_mode mode);
 
+    /**
+     * @brief Drop queued frame work that has not reached the panel yet, so a newer frame can take its place.
+     *        Queued LUT writes, updates and sleeps are cancelled (an update already running finishes),
+     *        then the frame upload is cancelled, aborted mid-DMA if it is on the wire. Init programs stay.
+     *        Thread level.
+     *
+     * @param handle  Driver handle
+     * @param mgr     SPI bus manager
+     * @param dropped Optional: set to true if a display update was dropped (its frame will not be shown)
+     * @return epd3in7_driver_status Operation status
+     */
+    epd3in7_driver_status epd3in7_driver_cancel_frame_dma(epd3in7_driver_handle *handle,
+                                                          spi_bus_manager *mgr,
+                                                          bool *dropped);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
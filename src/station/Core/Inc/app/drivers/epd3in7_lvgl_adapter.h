@@ -11,6 +11,27 @@ extern "C"
 {
 #endif
 
+/**
+ * @brief Adaptive refresh scheduler (flush_dma with a shadow buffer): the frame is split into
+ *        REGION_COLS x REGION_ROWS regions that accumulate the pixels flipped by partial refreshes
+ *        (A2 flips weigh 2, DU flips 1). GC is scheduled when a region's wear reaches its pixel count,
+ *        when a frame flips GC_PERCENT of the screen, or after refresh_cycles_before_gc partial refreshes.
+ *        Frames flipping DU_PERCENT or more use DU instead of A2.
+ */
+#define EPD3IN7_LVGL_ADAPTER_REGION_COLS 5
+#define EPD3IN7_LVGL_ADAPTER_REGION_ROWS 4
+#define EPD3IN7_LVGL_ADAPTER_REGIONS (EPD3IN7_LVGL_ADAPTER_REGION_COLS * EPD3IN7_LVGL_ADAPTER_REGION_ROWS)
+#define EPD3IN7_LVGL_ADAPTER_GC_PERCENT 30
+#define EPD3IN7_LVGL_ADAPTER_DU_PERCENT 5
+
+/**
+ * @brief Streamed upload of flush_dma: the frame is rotated into panel rows a band at a time, into two
+ *        band slots that alternate on the wire (16 rows = 560 bytes, about the bus manager chunk size).
+ */
+#define EPD3IN7_LVGL_ADAPTER_BAND_ROWS 16
+#define EPD3IN7_LVGL_ADAPTER_BAND_BYTES (EPD3IN7_LVGL_ADAPTER_BAND_ROWS * ((EPD3IN7_WIDTH + 7) / 8))
+#define EPD3IN7_LVGL_ADAPTER_BAND_BUFFER_SIZE (2 * EPD3IN7_LVGL_ADAPTER_BAND_BYTES)
+
     /**
      * @brief Handle structure for the e-Paper display (no change detection).
      */
@@ -29,8 +50,28 @@ extern "C"
         /* Cached GPIO roles for the manager (derived from driver pins). */
         spi_bus_gpio cs_gpio;          /**< CS line descriptor for bus manager (active_low = true). */
         spi_bus_gpio dc_gpio;          /**< DC line descriptor for bus manager (active_low = false). */
-        volatile bool dma_in_progress; /**< true while a frame is enqueued and not yet completed */
-        lv_display_t *pending_disp;    /**< display to call flush_ready for when DMA completes */
+        uint8_t frames_queued;              /**< Frames enqueued by flush_dma (thread side) */
+        volatile uint8_t frames_done;       /**< Frames whose completion fence ran (ISR side) */
+        epd3in7_driver_mode queued_mode;    /**< Refresh mode of the last enqueued frame */
+        epd3in7_driver_area queued_area;    /**< Panel RAM rectangle of the last enqueued frame */
+        bool panel_synced;                  /**< Panel RAM holds a complete frame (area updates allowed) */
+        lv_area_t dirty;                    /**< Logical area invalidated since the last DMA flush */
+        bool dirty_has_value;               /**< Flag indicating dirty holds an area */
+        uint8_t *shadow_buffer;             /**< Optional copy of the last enqueued LVGL frame (frame diff) */
+        bool shadow_valid;                  /**< Flag indicating shadow_buffer matches the panel RAM */
+        uint32_t frames_skipped;            /**< Flushes dropped by the frame diff (identical frames) */
+        uint32_t region_wear[EPD3IN7_LVGL_ADAPTER_REGIONS]; /**< Weighted partial-refresh flips per region since the last GC */
+        uint8_t *i2_frame;                  /**< 4-gray: I2 frame in panel orientation (width * height / 4 bytes) */
+        uint8_t *planes;                    /**< 4-gray: RAM and RAM2 planes read by DMA (2 * width * height / 8 bytes) */
+        uint8_t *band_buffer;               /**< Band slots of the streamed upload (EPD3IN7_LVGL_ADAPTER_BAND_BUFFER_SIZE) */
+        const uint8_t *stream_src;          /**< I1 frame the bands are rotated from (shadow_buffer or the LVGL buffer) */
+        int32_t stream_src_w;               /**< Width of stream_src in pixels */
+        int32_t stream_src_h;               /**< Height of stream_src in pixels */
+        uint32_t stream_src_stride;         /**< Bytes per stream_src row */
+        uint32_t stream_dst_stride;         /**< Bytes per panel row */
+        lv_display_rotation_t stream_rotation; /**< Rotation from stream_src to the panel */
+        epd3in7_driver_area stream_area;    /**< Panel RAM rectangle being streamed */
+        lv_display_t *volatile stream_disp; /**< Display whose buffer is still read by the stream (flush_ready pending) */
     } epd3in7_lvgl_adapter_handle;
 
     /**
@@ -47,17 +88,46 @@ extern "C"
      *        Initialization (epd init) stays blocking; frame transfers and sleep use DMA via manager.
      *
      * @param driver Pointer to the initialized e-Paper driver handle
-     * @param work_buffer Pointer to a work buffer for rotation (size: width * height / 8 bytes)
+     * @param band_buffer Band slots for the streamed upload (EPD3IN7_LVGL_ADAPTER_BAND_BUFFER_SIZE bytes);
+     *                    NULL uses the adapter's own slots, shared by all adapters created that way
      * @param refresh_cycles_before_gc Number of refresh cycles before forcing a GC refresh
+     *                                 (upper bound once the adaptive scheduler runs, see set_shadow_buffer)
      * @param default_mode Default refresh mode: EPD3IN7_DRIVER_MODE_A2 or EPD3IN7_DRIVER_MODE_DU
      * @param spi_mgr Pointer to a configured SPI bus manager (may not be NULL here)
      */
     epd3in7_lvgl_adapter_handle epd3in7_lvgl_adapter_create_with_bus_manager(epd3in7_driver_handle *driver,
-                                                                             uint8_t *work_buffer,
+                                                                             uint8_t *band_buffer,
                                                                              int8_t refresh_cycles_before_gc,
                                                                              epd3in7_driver_mode default_mode,
                                                                              spi_bus_manager *spi_mgr);
 
+    /**
+     * @brief Create an adapter for the 4-gray pipeline: LVGL renders L8 (anti-aliased) in partial
+     *        mode, epd3in7_lvgl_adapter_flush_4_gray_dma() quantizes the bands into an I2 frame and
+     *        the last band sends it as two bit planes via DMA (GC refresh, non-blocking).
+     *
+     * @param driver   Pointer to the e-Paper driver handle
+     * @param i2_frame I2 frame buffer (width * height / 4 bytes)
+     * @param planes   Plane buffer (width * height / 4 bytes: RAM plane, then RAM2 plane)
+     * @param spi_mgr  Pointer to a configured SPI bus manager
+     */
+    epd3in7_lvgl_adapter_handle epd3in7_lvgl_adapter_create_4_gray_with_bus_manager(epd3in7_driver_handle *driver,
+                                                                                    uint8_t *i2_frame,
+                                                                                    uint8_t *planes,
+                                                                                    spi_bus_manager *spi_mgr);
+
+    /**
+     * @brief Enable the frame diff of flush_dma: each frame is compared with the last enqueued one,
+     *        identical frames are not sent at all and otherwise only the box of changed pixels is
+     *        uploaded (tighter than the invalidated areas). The flipped pixels also drive the adaptive
+     *        GC/DU/A2 choice (EPD3IN7_LVGL_ADAPTER_GC_PERCENT and friends). The upload streams from
+     *        the shadow, so LVGL gets its buffer back at once.
+     *
+     * @param handle Adapter handle
+     * @param shadow_buffer Buffer of the LVGL frame size without palette (width * height / 8 bytes), or NULL to disable
+     */
+    void epd3in7_lvgl_adapter_set_shadow_buffer(epd3in7_lvgl_adapter_handle *handle, uint8_t *shadow_buffer);
+
     /**
      * @brief Free resources associated with the e-Paper LVGL adapter handle.
      */
@@ -69,12 +139,35 @@ extern "C"
     void epd3in7_lvgl_adapter_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
 
     /**
-     * @brief LVGL flush callback — non-blocking full-frame path via SPI bus manager (DMA).
-     *        If the panel is not initialized yet, waits until SPI is idle and runs blocking init,
-     *        then enqueues display+sleep transactions via the manager and returns immediately.
+     * @brief LVGL flush callback — non-blocking path via SPI bus manager (DMA).
+     *        Enqueues init (first call), display and sleep. The upload is streamed: each band of panel
+     *        rows is rotated into band_buffer while the band before it is on the wire. The LVGL buffer
+     *        is handed back at once with a shadow buffer, otherwise once its last band is produced.
+     *        A display left at LV_DISPLAY_ROTATION_0 (a UI laid out in panel orientation, 280 x 480;
+     *        the station's renderer is landscape and runs at ROTATION_90) renders in panel rows: with a
+     *        shadow buffer, full-width uploads are read by DMA straight from it, with no band pass.
+     *        A frame that has not reached the panel when the next flush arrives is superseded:
+     *        its queued work is dropped and its upload aborted.
+     *        Only the byte-aligned bounding box of the areas invalidated since the previous flush
+     *        is uploaded (see epd3in7_lvgl_adapter_invalidate_cb()); the first frame after init and
+     *        GC frames are sent whole.
      */
     void epd3in7_lvgl_adapter_flush_dma(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
 
+    /**
+     * @brief LVGL flush callback — 4-gray path via SPI bus manager (DMA), for an L8 display in
+     *        LV_DISPLAY_RENDER_MODE_PARTIAL. Each band is quantized to 2 bits (3 = white) and rotated
+     *        into i2_frame; on the last band of a refresh the frame is split into planes and queued
+     *        with sleep. A frame still in flight is superseded as in flush_dma.
+     */
+    void epd3in7_lvgl_adapter_flush_4_gray_dma(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+
+    /**
+     * @brief LVGL LV_EVENT_INVALIDATE_AREA handler: accumulates the invalidated areas for the next
+     *        flush_dma. Register with lv_display_add_event_cb(); without it every frame is sent whole.
+     */
+    void epd3in7_lvgl_adapter_invalidate_cb(lv_event_t *e);
+
     /**
      * @brief Convenience: query whether the adapter's SPI bus manager is currently idle.
      *        Returns true for legacy (blocking) handle with no manager.
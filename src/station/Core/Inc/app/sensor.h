@@ -21,6 +21,7 @@ extern "C"
         SPI_HandleTypeDef *sensor_spi; /**< SPI handle for BME280 communication */
         GPIO_TypeDef *cs_port;         /**< GPIO port for chip select */
         uint16_t cs_pin;               /**< GPIO pin for chip select */
+        bool ready;                    /**< Calibration read and mode set (sensor_init succeeded) */
     } sensor_handle;
 
     /**
@@ -30,8 +31,11 @@ extern "C"
 
     /**
      * @brief Initialize the sensor (BME280)
+     *
+     * @return true if the sensor was initialized, false if the bus lease timed out or the chip did not answer
+     *         (sensor_forced_get() retries the init)
      */
-    void sensor_init(sensor_handle *handle);
+    bool sensor_init(sensor_handle *handle);
 
     /**
      * @brief Trigger a non-blocking read of the sensor. Call sensor_try_get() later to check if data is ready.
@@ -51,7 +55,7 @@ extern "C"
     /**
      * @brief Perform a blocking read of the sensor in FORCEDMODE. This will trigger a measurement and wait for it to complete.
      *
-     * @param out Pointer to app_device_data structure to fill with the latest readings
+     * @param out Pointer to app_device_data structure to fill with the latest readings (left untouched on failure)
      * @return true if the read was successful, false otherwise
      */
     bool sensor_forced_get(sensor_handle *handle, app_device_data *out);
@@ -1,4 +1,7 @@
 #pragma once
 
 #include "stm32g4xx_hal.h"
-#include "stm32g4xx_hal_gpio.h"
\ No newline at end of file
+#include "stm32g4xx_hal_gpio.h"
+
+// spi_bus_manager platform hooks (SPI_BUS_PORT_* in spi_bus_manager.c) may be overridden here.
+// Defaults: STM32 HAL SPI/DMA, HAL_GPIO_WritePin, HAL_GetTick, DWT->CYCCNT, PRIMASK.
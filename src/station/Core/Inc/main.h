@@ -76,6 +76,7 @@ void Error_Handler(void);
 #define DISP_RST_GPIO_Port GPIOB
 #define DISP_BUSY_Pin GPIO_PIN_2
 #define DISP_BUSY_GPIO_Port GPIOB
+#define DISP_BUSY_EXTI_IRQn EXTI2_IRQn
 #define RAD_DI0_Pin GPIO_PIN_10
 #define RAD_DI0_GPIO_Port GPIOB
 #define RAD_DI0_EXTI_IRQn EXTI15_10_IRQn
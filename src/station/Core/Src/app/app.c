@@ -1,6 +1,34 @@
 #include "app/app.h"
 #include <string.h>
 
+// TIM6 ticks at 1 kHz in one-pulse mode; the prescaler phase is not reset, so ARR = ms gives [ms, ms + 1) ms
+static void app_spi_bus_timer_start(void *ctx, uint32_t ms)
+{
+    TIM_HandleTypeDef *htim = (TIM_HandleTypeDef *)ctx;
+
+    if (ms > 0xFFFFu)
+        ms = 0xFFFFu;
+
+    __HAL_TIM_DISABLE(htim);
+    __HAL_TIM_SET_COUNTER(htim, 0);
+    __HAL_TIM_SET_AUTORELOAD(htim, ms);
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+    __HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE);
+    __HAL_TIM_ENABLE(htim);
+}
+
+// Sleep mode instead of spinning in HAL_Delay(): SysTick wakes the core every ms, the EPD BUSY edge,
+// SPI DMA, TIM6 and radio interrupts run their handlers in between (the panel refresh runs from them)
+static void app_sleep_ms(uint32_t ms)
+{
+    const uint32_t start = HAL_GetTick();
+
+    while ((HAL_GetTick() - start) < ms)
+    {
+        HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+    }
+}
+
 void app_init(app_handle *handle)
 {
     HAL_Delay(50); // Wait for power to stabilize
@@ -9,12 +37,17 @@ void app_init(app_handle *handle)
     handle->hclock = hourly_clock_create(&hrtc);
     handle->radio = radio_create(RAD_CS_GPIO_Port, RAD_CS_Pin, RAD_DI0_GPIO_Port, RAD_DI0_Pin, &hspi3, &handle->hclock);
     handle->spi_mgr = spi_bus_manager_create(&hspi2, handle->app_spiq_storage, (uint16_t)(sizeof(handle->app_spiq_storage) / sizeof(handle->app_spiq_storage[0])));
+    spi_bus_manager_set_priority_queue(&handle->spi_mgr, handle->app_spiq_prio_storage, (uint16_t)(sizeof(handle->app_spiq_prio_storage) / sizeof(handle->app_spiq_prio_storage[0])));
+    spi_bus_manager_set_chunk_size(&handle->spi_mgr, 512); // ~0.26 ms @ 16 MHz (EPD limit on 64 MHz APB1): worst-case wait for the BME280 behind an EPD frame
+    spi_bus_manager_set_timer(&handle->spi_mgr, app_spi_bus_timer_start, &htim6); // EPD reset/settle delays without HAL_Delay()
+    spi_bus_manager_register(&handle->spi_mgr);
     handle->sensor = sensor_create(&handle->spi_mgr, &htim1, &hspi2, BME280_CS_GPIO_Port, BME280_CS_Pin);
     handle->display = display_create(&handle->spi_mgr);
 
     display_init(&handle->display);
 
-    sensor_init(&handle->sensor);
+    // A failed init (bus lease timeout, no answer) is retried by the first sensor_forced_get()
+    (void)sensor_init(&handle->sensor);
 
     battery_request_read(&handle->battery);
 
@@ -41,15 +74,23 @@ void app_init(app_handle *handle)
 
 void app_loop(app_handle *handle)
 {
-    HAL_Delay(50);
+    app_sleep_ms(50);
 
     hourly_clock_update(&handle->hclock);
 
+    // Low-rate fallback for post-transfer waits (missed BUSY edge, wait timeouts)
+    spi_bus_manager_tick_all();
+
     if (hourly_clock_check_elapsed(&handle->hclock, handle->last_sensor_read_time, SENSOR_CHECK_EVERY_SEC))
     {
-        sensor_forced_get(&handle->sensor, &handle->local);
+        // On a failed read keep the previous values and let the consumers keep theirs
+        bool read_ok = sensor_forced_get(&handle->sensor, &handle->local);
         handle->last_sensor_read_time = hourly_clock_get_timestamp(&handle->hclock);
-        battery_update_temperature(&handle->battery, handle->local.temperature);
+        if (read_ok)
+        {
+            battery_update_temperature(&handle->battery, handle->local.temperature);
+            display_set_temperature(&handle->display, handle->local.temperature);
+        }
     }
 
     radio_loop(&handle->radio);
@@ -86,7 +127,7 @@ void app_loop(app_handle *handle)
 
     display_loop(&handle->display, &handle->local, &handle->remote, changes_detected);
 
-    HAL_Delay(1);
+    app_sleep_ms(1);
 }
 
 void app_adc_conv_cplt_callback(app_handle *handle, ADC_HandleTypeDef *hadc)
@@ -96,30 +137,43 @@ void app_adc_conv_cplt_callback(app_handle *handle, ADC_HandleTypeDef *hadc)
 
 void app_gpio_exti_callback(app_handle *handle, const uint16_t pin)
 {
+    if (pin == DISP_BUSY_Pin)
+    {
+        // EPD BUSY released - resume SPI queues parked on post-transfer wait
+        spi_bus_manager_tick_all();
+        return;
+    }
+
     radio_exti_interrupt_handler(pin);
 }
 
 void app_spi_tx_cplt_callback(app_handle *handle, SPI_HandleTypeDef *hspi)
 {
-    spi_bus_manager_on_tx_cplt(&handle->spi_mgr, hspi);
+    spi_bus_manager_dispatch_tx_cplt(hspi);
 }
 
 void app_spi_tx_half_cplt_callback(app_handle *handle, SPI_HandleTypeDef *hspi)
 {
-    spi_bus_manager_on_tx_half(&handle->spi_mgr, hspi);
+    spi_bus_manager_dispatch_tx_half(hspi);
 }
 
 void app_spi_txrx_cplt_callback(app_handle *handle, SPI_HandleTypeDef *hspi)
 {
-    spi_bus_manager_on_txrx_cplt(&handle->spi_mgr, hspi);
+    spi_bus_manager_dispatch_txrx_cplt(hspi);
 }
 
 void app_spi_txrx_half_cplt_callback(app_handle *handle, SPI_HandleTypeDef *hspi)
 {
-    spi_bus_manager_on_txrx_half(&handle->spi_mgr, hspi);
+    spi_bus_manager_dispatch_txrx_half(hspi);
 }
 
 void app_spi_error_callback(app_handle *handle, SPI_HandleTypeDef *hspi)
 {
-    spi_bus_manager_on_error(&handle->spi_mgr, hspi);
+    spi_bus_manager_dispatch_error(hspi);
+}
+
+void app_tim_period_elapsed_callback(app_handle *handle, TIM_HandleTypeDef *htim)
+{
+    if (htim == &htim6)
+        spi_bus_manager_on_timer(&handle->spi_mgr);
 }
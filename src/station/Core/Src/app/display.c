@@ -10,14 +10,27 @@
 #include "gpio.h"
 #include "spi.h"
 
+// 1: 4-gray pipeline (L8 rendering, anti-aliased), 0: black/white with partial refreshes
+#define DISPLAY_4_GRAY 0
+
 // Buffer for the full black/white image (1bpp). I1: 2 colors * 4 bytes (ARGB32)
 #define STRIDE_BYTES ((EPD3IN7_WIDTH + 7) / 8)
 #define DISPLAY_BUFFER_SIZE (STRIDE_BYTES * EPD3IN7_HEIGHT)
 #define LVGL_PALETTE_BYTES 8
 
-static LV_ATTRIBUTE_MEM_ALIGN uint8_t lvgl_buffer[LVGL_PALETTE_BYTES + DISPLAY_BUFFER_SIZE];
+#if DISPLAY_4_GRAY
+// L8 band of the rotated (480 px wide) screen; the I2 frame and the two planes are 2 bits per pixel each
+#define DISPLAY_L8_BAND_ROWS 40
+#define DISPLAY_I2_BUFFER_SIZE (DISPLAY_BUFFER_SIZE * 2)
 
-static uint8_t epd3in7_adapter_work_buffer[DISPLAY_BUFFER_SIZE];
+static LV_ATTRIBUTE_MEM_ALIGN uint8_t lvgl_buffer[EPD3IN7_HEIGHT * DISPLAY_L8_BAND_ROWS];
+
+static uint8_t epd3in7_adapter_i2_frame[DISPLAY_I2_BUFFER_SIZE];
+static uint8_t epd3in7_adapter_planes[DISPLAY_I2_BUFFER_SIZE];
+#else
+static LV_ATTRIBUTE_MEM_ALIGN uint8_t lvgl_buffer[LVGL_PALETTE_BYTES + DISPLAY_BUFFER_SIZE];
+static uint8_t epd3in7_adapter_shadow_buffer[DISPLAY_BUFFER_SIZE];
+#endif
 
 static epd3in7_lvgl_adapter_handle epd3in7_adapter;
 static epd3in7_driver_handle epd3in7_drv;
@@ -45,22 +58,46 @@ void display_init(display_handle *handle)
                                             .cs_pin = DISP_CS_Pin},
                                         &hspi2, true);
 
+#if DISPLAY_4_GRAY
+    epd3in7_adapter = epd3in7_lvgl_adapter_create_4_gray_with_bus_manager(
+        &epd3in7_drv,
+        epd3in7_adapter_i2_frame,
+        epd3in7_adapter_planes,
+        handle->spi_mgr);
+#else
     epd3in7_adapter = epd3in7_lvgl_adapter_create_with_bus_manager(
         &epd3in7_drv,
-        epd3in7_adapter_work_buffer,
-        10,
+        NULL, // The adapter's own two band slots: rotated band by band while the previous band is on the wire
+        30, // Ceiling only: GC follows region wear (frame diff)
         EPD3IN7_DRIVER_MODE_A2,
         handle->spi_mgr);
+    epd3in7_lvgl_adapter_set_shadow_buffer(&epd3in7_adapter, epd3in7_adapter_shadow_buffer);
+#endif
 
     lv_init();
     lv_tick_set_cb(HAL_GetTick);
     lv_display_t *display = lv_display_create(EPD3IN7_WIDTH, EPD3IN7_HEIGHT);
     lv_display_set_driver_data(display, &epd3in7_adapter);
+#if DISPLAY_4_GRAY
+    lv_display_set_color_format(display, LV_COLOR_FORMAT_L8);
+    lv_display_set_buffers(display, lvgl_buffer, NULL, sizeof(lvgl_buffer), LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(display, epd3in7_lvgl_adapter_flush_4_gray_dma);
+#else
     lv_display_set_buffers(display, lvgl_buffer, NULL, sizeof(lvgl_buffer), LV_DISPLAY_RENDER_MODE_FULL);
     lv_display_set_flush_cb(display, epd3in7_lvgl_adapter_flush_dma);
+    lv_display_add_event_cb(display, epd3in7_lvgl_adapter_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+#endif
+    // The renderer composes a landscape layout (text cannot be drawn rotated); the adapter rotates it into
+    // panel rows band by band during the upload.
     lv_display_set_rotation(display, LV_DISPLAY_ROTATION_90);
 }
 
+void display_set_temperature(display_handle *handle, const float celsius)
+{
+    (void)handle;
+    epd3in7_driver_set_temperature(&epd3in7_drv, celsius);
+}
+
 void display_loop(display_handle *handle, app_device_data *local, app_device_data *remote, const bool changes_detected)
 {
     if (!handle->anything_was_rendered || changes_detected)
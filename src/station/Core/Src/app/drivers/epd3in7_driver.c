@@ -54,61 +54,244 @@ typedef enum
     EPD_CMD_SLEEP = 0x50 // Not sure about this one
 } epd3in7_driver_cmd;
 
-static const uint8_t epd3in7_driver_lut_4_gray_gc[] =
-    {
-        0x2A, 0x06, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 1
-        0x28, 0x06, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 2
-        0x20, 0x06, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 3
-        0x14, 0x06, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 4
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 5
-        0x00, 0x02, 0x02, 0x0A, 0x00, 0x00, 0x00, 0x08, 0x08, 0x02, // 6
-        0x00, 0x02, 0x02, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 7
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 8
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 9
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 10
-        0x22, 0x22, 0x22, 0x22, 0x22};
-
-static const uint8_t epd3in7_driver_lut_1_gray_gc[] =
-    {
-        0x2A, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 1
-        0x05, 0x2A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 2
-        0x2A, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 3
-        0x05, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 4
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 5
-        0x00, 0x02, 0x03, 0x0A, 0x00, 0x02, 0x06, 0x0A, 0x05, 0x00, // 6
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 7
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 8
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 9
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 10
-        0x22, 0x22, 0x22, 0x22, 0x22};
-
-static const uint8_t epd3in7_driver_lut_1_gray_du[] =
-    {
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 1
-        0x01, 0x2A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x0A, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 3
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 5
-        0x00, 0x00, 0x05, 0x05, 0x00, 0x05, 0x03, 0x05, 0x05, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 7
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 9
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x22, 0x22, 0x22, 0x22, 0x22};
-
-static const uint8_t epd3in7_driver_lut_1_gray_a2[] =
-    {
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 1
-        0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 2
-        0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 3
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 4
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 5
-        0x00, 0x00, 0x03, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 6
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 7
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 8
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 9
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 10
-        0x22, 0x22, 0x22, 0x22, 0x22};
+/* LUT layout: 5 x 10 voltage selects, 10 phase groups of TP[A..D] + RP (repeat), 5 frame rates.
+   EPD3IN7_DRIVER_TP() scales the phase lengths (TP) for a temperature band by s / 2: particles move
+   slower in the cold, so the same waveform is driven for longer. Repeats and frame rates stay. */
+#define EPD3IN7_DRIVER_TP(tp, s) (uint8_t)(((tp) * (s) + 1) / 2)
+
+#define EPD3IN7_DRIVER_LUT_4_GRAY_GC(s) \
+    0x2A, 0x06, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x28, 0x06, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x20, 0x06, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x14, 0x06, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, EPD3IN7_DRIVER_TP(0x02, s), EPD3IN7_DRIVER_TP(0x02, s), EPD3IN7_DRIVER_TP(0x0A, s), 0x00, 0x00, 0x00, EPD3IN7_DRIVER_TP(0x08, s), EPD3IN7_DRIVER_TP(0x08, s), 0x02, \
+    0x00, EPD3IN7_DRIVER_TP(0x02, s), EPD3IN7_DRIVER_TP(0x02, s), EPD3IN7_DRIVER_TP(0x0A, s), 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x22, 0x22, 0x22, 0x22, 0x22
+
+#define EPD3IN7_DRIVER_LUT_1_GRAY_GC(s) \
+    0x2A, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x05, 0x2A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x2A, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x05, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, EPD3IN7_DRIVER_TP(0x02, s), EPD3IN7_DRIVER_TP(0x03, s), EPD3IN7_DRIVER_TP(0x0A, s), 0x00, EPD3IN7_DRIVER_TP(0x02, s), EPD3IN7_DRIVER_TP(0x06, s), EPD3IN7_DRIVER_TP(0x0A, s), EPD3IN7_DRIVER_TP(0x05, s), 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x22, 0x22, 0x22, 0x22, 0x22
+
+#define EPD3IN7_DRIVER_LUT_1_GRAY_DU(s) \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x01, 0x2A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x0A, 0x55, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, EPD3IN7_DRIVER_TP(0x05, s), EPD3IN7_DRIVER_TP(0x05, s), 0x00, EPD3IN7_DRIVER_TP(0x05, s), EPD3IN7_DRIVER_TP(0x03, s), EPD3IN7_DRIVER_TP(0x05, s), EPD3IN7_DRIVER_TP(0x05, s), 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x22, 0x22, 0x22, 0x22, 0x22
+
+#define EPD3IN7_DRIVER_LUT_1_GRAY_A2(s) \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, EPD3IN7_DRIVER_TP(0x03, s), EPD3IN7_DRIVER_TP(0x05, s), 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x22, 0x22, 0x22, 0x22, 0x22
+
+static const uint8_t epd3in7_driver_lut_4_gray_gc[EPD3IN7_DRIVER_TEMP_BAND_COUNT][105] = {
+    {EPD3IN7_DRIVER_LUT_4_GRAY_GC(2)},
+    {EPD3IN7_DRIVER_LUT_4_GRAY_GC(3)},
+    {EPD3IN7_DRIVER_LUT_4_GRAY_GC(4)},
+};
+
+static const uint8_t epd3in7_driver_lut_1_gray_gc[EPD3IN7_DRIVER_TEMP_BAND_COUNT][105] = {
+    {EPD3IN7_DRIVER_LUT_1_GRAY_GC(2)},
+    {EPD3IN7_DRIVER_LUT_1_GRAY_GC(3)},
+    {EPD3IN7_DRIVER_LUT_1_GRAY_GC(4)},
+};
+
+static const uint8_t epd3in7_driver_lut_1_gray_du[EPD3IN7_DRIVER_TEMP_BAND_COUNT][105] = {
+    {EPD3IN7_DRIVER_LUT_1_GRAY_DU(2)},
+    {EPD3IN7_DRIVER_LUT_1_GRAY_DU(3)},
+    {EPD3IN7_DRIVER_LUT_1_GRAY_DU(4)},
+};
+
+static const uint8_t epd3in7_driver_lut_1_gray_a2[EPD3IN7_DRIVER_TEMP_BAND_COUNT][105] = {
+    {EPD3IN7_DRIVER_LUT_1_GRAY_A2(2)},
+    {EPD3IN7_DRIVER_LUT_1_GRAY_A2(3)},
+    {EPD3IN7_DRIVER_LUT_1_GRAY_A2(4)},
+};
+
+// === COMMAND PROGRAMS ===
+
+// Init, refresh and sleep sequences, defined once. The bus manager runs them without blocking
+// (spi_bus_manager program items); epd3in7_driver_run() runs the same tables with HAL calls.
+// GPIO ops drive RESET (active low), WAIT ops wait for BUSY to be released.
+
+/* Hardware reset pulse: RES# low 10 ms, then 10 ms before the first command (SSD1677 power-on
+   sequence); the controller's own reset time is covered by the BUSY wait after it */
+#define EPD3IN7_DRIVER_OPS_RESET                                                                     \
+    SPI_BUS_GPIO(true), SPI_BUS_DELAY(10), SPI_BUS_GPIO(false), SPI_BUS_DELAY(10)
+
+/* SW reset (BUSY high until done) and RAM pattern fill, identical for both init variants */
+#define EPD3IN7_DRIVER_OPS_SW_RESET                                                                  \
+    SPI_BUS_CMD(EPD_CMD_SW_RESET), SPI_BUS_WAIT_READY(),                                             \
+        SPI_BUS_CMD(EPD_CMD_AUTO_WRITE_RED_RAM_REG_PATTERN), SPI_BUS_DATA(0xF7),                     \
+        SPI_BUS_WAIT_READY(),                                                                        \
+        SPI_BUS_CMD(EPD_CMD_AUTO_WRITE_BW_RAM_REG_PATTERN), SPI_BUS_DATA(0xF7),                      \
+        SPI_BUS_WAIT_READY()
+
+/* Panel registers up to the display option (which differs between 4-gray and 1-gray) */
+#define EPD3IN7_DRIVER_OPS_PANEL_SETUP                                                               \
+    SPI_BUS_CMD(EPD_CMD_GATE_SETTING), SPI_BUS_DATA(0xDF, 0x01, 0x00),                               \
+        SPI_BUS_CMD(EPD_CMD_GATE_VOLTAGE), SPI_BUS_DATA(0x00),                                       \
+        SPI_BUS_CMD(EPD_CMD_GATE_VOLTAGE_SOURCE), SPI_BUS_DATA(0x41, 0xA8, 0x32),                    \
+        SPI_BUS_CMD(EPD_CMD_DATA_ENTRY_SEQUENCE), SPI_BUS_DATA(0x03),                                \
+        SPI_BUS_CMD(EPD_CMD_BORDER_WAVEFORM_CONTROL), SPI_BUS_DATA(0x03),                            \
+        SPI_BUS_CMD(EPD_CMD_BOOSTER_SOFT_START_CONTROL), SPI_BUS_DATA(0xAE, 0xC7, 0xC3, 0xC0, 0xC0), \
+        SPI_BUS_CMD(EPD_CMD_TEMPERATURE_SENSOR_SELECTION), SPI_BUS_DATA(0x80),                       \
+        SPI_BUS_CMD(EPD_CMD_WRITE_VCOM_REGISTER), SPI_BUS_DATA(0x44)
+
+/* Full-screen RAM window and update sequence, ends the init */
+#define EPD3IN7_DRIVER_OPS_WINDOW                                                                    \
+    SPI_BUS_CMD(EPD_CMD_SET_RAMX_START_END), SPI_BUS_DATA(0x00, 0x00, 0x17, 0x01),                   \
+        SPI_BUS_CMD(EPD_CMD_SET_RAMY_START_END), SPI_BUS_DATA(0x00, 0x00, 0xDF, 0x01),               \
+        SPI_BUS_CMD(EPD_CMD_DISPLAY_UPDATE_SEQUENCE_SETTING), SPI_BUS_DATA(0xCF)
+
+static const spi_bus_op epd3in7_driver_prog_reset[] = {
+    EPD3IN7_DRIVER_OPS_RESET,
+};
+
+static const spi_bus_op epd3in7_driver_prog_init_4_gray[] = {
+    SPI_BUS_WAIT_READY(),
+    EPD3IN7_DRIVER_OPS_RESET,
+    EPD3IN7_DRIVER_OPS_SW_RESET,
+    EPD3IN7_DRIVER_OPS_PANEL_SETUP,
+    SPI_BUS_CMD(EPD_CMD_DISPLAY_OPTION),
+    SPI_BUS_DATA(0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+    EPD3IN7_DRIVER_OPS_WINDOW,
+};
+
+static const spi_bus_op epd3in7_driver_prog_init_1_gray[] = {
+    EPD3IN7_DRIVER_OPS_RESET,
+    SPI_BUS_WAIT_READY(),
+    EPD3IN7_DRIVER_OPS_SW_RESET,
+    EPD3IN7_DRIVER_OPS_PANEL_SETUP,
+    SPI_BUS_CMD(EPD_CMD_DISPLAY_OPTION),
+    SPI_BUS_DATA(0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x4F, 0xFF, 0xFF, 0xFF, 0xFF),
+    EPD3IN7_DRIVER_OPS_WINDOW,
+};
+
+/* Full-frame RAM window + address counters, ends with WRITE_RAM so the frame data can follow. */
+static const spi_bus_op epd3in7_driver_prog_frame_setup[] = {
+    SPI_BUS_WAIT_READY(),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMX_START_END),
+    SPI_BUS_DATA(0x00, 0x00, 0x17, 0x01),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMY_START_END),
+    SPI_BUS_DATA(0x00, 0x00, 0xDF, 0x01),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMX_COUNTER),
+    SPI_BUS_DATA(0x00),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMY_COUNTER),
+    SPI_BUS_DATA(0x00, 0x00),
+    SPI_BUS_CMD(EPD_CMD_WRITE_RAM),
+};
+
+/* Commands of the area window program; its data ops point into the handle's area_window. */
+static const uint8_t epd3in7_driver_area_cmds[] = {
+    EPD_CMD_SET_RAMX_START_END,
+    EPD_CMD_SET_RAMY_START_END,
+    EPD_CMD_SET_RAMX_COUNTER,
+    EPD_CMD_SET_RAMY_COUNTER,
+    EPD_CMD_WRITE_RAM,
+};
+
+/* 4-gray frame: full RAM window and counters, then WRITE_RAM (low bit plane). */
+static const spi_bus_op epd3in7_driver_prog_frame_setup_4_gray[] = {
+    SPI_BUS_WAIT_READY(),
+    SPI_BUS_CMD(EPD_CMD_UNKNOWN_0x49),
+    SPI_BUS_DATA(0x00),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMX_START_END),
+    SPI_BUS_DATA(0x00, 0x00, 0x17, 0x01),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMY_START_END),
+    SPI_BUS_DATA(0x00, 0x00, 0xDF, 0x01),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMX_COUNTER),
+    SPI_BUS_DATA(0x00, 0x00),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMY_COUNTER),
+    SPI_BUS_DATA(0x00, 0x00),
+    SPI_BUS_CMD(EPD_CMD_WRITE_RAM),
+};
+
+/* Counters back to the origin, then WRITE_RAM2 (high bit plane). */
+static const spi_bus_op epd3in7_driver_prog_ram2_setup[] = {
+    SPI_BUS_CMD(EPD_CMD_SET_RAMX_COUNTER),
+    SPI_BUS_DATA(0x00, 0x00),
+    SPI_BUS_CMD(EPD_CMD_SET_RAMY_COUNTER),
+    SPI_BUS_DATA(0x00, 0x00),
+    SPI_BUS_CMD(EPD_CMD_WRITE_RAM2),
+};
+
+/* 4-gray update sequence (0xC7), then the refresh; the caller waits for BUSY afterwards. */
+static const spi_bus_op epd3in7_driver_prog_update_4_gray[] = {
+    SPI_BUS_CMD(EPD_CMD_DISPLAY_UPDATE_SEQUENCE_SETTING),
+    SPI_BUS_DATA(0xC7),
+    SPI_BUS_CMD(EPD_CMD_DISPLAY_UPDATE_SEQUENCE),
+};
+
+/* WRITE_LUT_REGISTER + 105-byte LUT, one program per LUT type and temperature band (all the same length). */
+#define EPD3IN7_DRIVER_LUT_PROGRAM(lut) \
+    {SPI_BUS_CMD(EPD_CMD_WRITE_LUT_REGISTER), SPI_BUS_DATA_BUF((lut), sizeof(lut))}
+
+static const spi_bus_op epd3in7_driver_prog_lut_4_gray_gc[EPD3IN7_DRIVER_TEMP_BAND_COUNT][2] = {
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_4_gray_gc[0]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_4_gray_gc[1]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_4_gray_gc[2]),
+};
+static const spi_bus_op epd3in7_driver_prog_lut_1_gray_gc[EPD3IN7_DRIVER_TEMP_BAND_COUNT][2] = {
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_gc[0]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_gc[1]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_gc[2]),
+};
+static const spi_bus_op epd3in7_driver_prog_lut_1_gray_du[EPD3IN7_DRIVER_TEMP_BAND_COUNT][2] = {
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_du[0]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_du[1]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_du[2]),
+};
+static const spi_bus_op epd3in7_driver_prog_lut_1_gray_a2[EPD3IN7_DRIVER_TEMP_BAND_COUNT][2] = {
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_a2[0]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_a2[1]),
+    EPD3IN7_DRIVER_LUT_PROGRAM(epd3in7_driver_lut_1_gray_a2[2]),
+};
+
+/* Starts the refresh; the caller decides whether to wait for BUSY afterwards. */
+static const spi_bus_op epd3in7_driver_prog_update[] = {
+    SPI_BUS_CMD(EPD_CMD_DISPLAY_UPDATE_SEQUENCE),
+};
+
+static const spi_bus_op epd3in7_driver_prog_sleep_deep[] = {
+    SPI_BUS_CMD(EPD_CMD_DEEP_SLEEP),
+    SPI_BUS_DATA(0x03),
+};
+
+static const spi_bus_op epd3in7_driver_prog_sleep[] = {
+    SPI_BUS_CMD(EPD_CMD_SLEEP),
+    SPI_BUS_DATA(0xF7),
+    SPI_BUS_CMD(EPD_CMD_POWEROFF),
+    SPI_BUS_CMD(EPD_CMD_SLEEP2),
+    SPI_BUS_DATA(0xA5),
+};
 
 static void epd3in7_driver_send_begin(epd3in7_driver_handle *handle)
 {
@@ -163,6 +346,24 @@ static epd3in7_driver_status epd3in7_driver_send_data_many(const epd3in7_driver_
     return EPD3IN7_DRIVER_OK;
 }
 
+/* 4 bytes of I2 (16 pixels, MSB first) as one big-endian word: pixel 0 in bits 31..30 */
+static inline uint32_t epd3in7_driver_i2_load(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* Gather the even bits of @p v (bit 2k -> bit k): the low bit of every pixel of an I2 word,
+   or the high bit when the word is shifted right by one first. Pixel 0 lands in bit 15. */
+static inline uint16_t epd3in7_driver_i2_plane_bits(uint32_t v)
+{
+    v &= 0x55555555u;
+    v = (v | (v >> 1)) & 0x33333333u;
+    v = (v | (v >> 2)) & 0x0F0F0F0Fu;
+    v = (v | (v >> 4)) & 0x00FF00FFu;
+    v = (v | (v >> 8)) & 0x0000FFFFu;
+    return (uint16_t)v;
+}
+
 static epd3in7_driver_lut_type epd3in7_driver_mode_to_lut(const epd3in7_driver_mode mode, const bool is_1_color)
 {
     if (is_1_color)
@@ -188,63 +389,143 @@ static epd3in7_driver_lut_type epd3in7_driver_mode_to_lut(const epd3in7_driver_m
     return EPD3IN7_DRIVER_LUT_1_GRAY_GC;
 }
 
+/* LUT program for a LUT type in a temperature band (NULL for an unknown type) */
+static const spi_bus_op *epd3in7_driver_lut_program(const epd3in7_driver_lut_type lut, const epd3in7_driver_temp_band band)
+{
+    if (band >= EPD3IN7_DRIVER_TEMP_BAND_COUNT)
+        return NULL;
+
+    if (lut == EPD3IN7_DRIVER_LUT_4_GRAY_GC)
+        return epd3in7_driver_prog_lut_4_gray_gc[band];
+    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_GC)
+        return epd3in7_driver_prog_lut_1_gray_gc[band];
+    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_DU)
+        return epd3in7_driver_prog_lut_1_gray_du[band];
+    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_A2)
+        return epd3in7_driver_prog_lut_1_gray_a2[band];
+
+    return NULL;
+}
+
+#define EPD3IN7_DRIVER_LUT_PROGRAM_LEN SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_lut_4_gray_gc[0])
+
 /**
- * REQUIRES: CS pin to be low
+ * Blocking interpreter for the command programs (same semantics as the bus manager:
+ * CS is held across consecutive CMD/DATA ops and released for DELAY, GPIO and WAIT).
+ * CS is left as it was found, so programs can be run in the middle of a CS-low sequence.
  */
-static epd3in7_driver_status epd3in7_driver_load_lut(epd3in7_driver_handle *handle, const epd3in7_driver_lut_type lut)
+static epd3in7_driver_status epd3in7_driver_run(epd3in7_driver_handle *handle, const spi_bus_op *prog, const uint16_t count)
 {
-    if (handle->last_lut_has_value && handle->last_lut == lut)
-    {
-        return EPD3IN7_DRIVER_OK;
-    }
+    epd3in7_driver_status err = EPD3IN7_DRIVER_OK;
+    const bool keep_cs = handle->is_cs_low_has_value && handle->is_cs_low;
 
-    if (handle->is_cs_low == false || handle->is_cs_low_has_value == false)
+    for (uint16_t i = 0; i < count; i++)
     {
-        return EPD3IN7_DRIVER_ERR_PARAM;
-    }
+        const spi_bus_op *op = &prog[i];
 
-    epd3in7_driver_status err = EPD3IN7_DRIVER_OK;
+        if (op->op == SPI_BUS_OP_CMD || op->op == SPI_BUS_OP_DATA)
+        {
+            if (!handle->is_cs_low)
+                epd3in7_driver_send_begin(handle);
 
-    epd3in7_driver_status res = epd3in7_driver_send_command(handle, EPD_CMD_WRITE_LUT_REGISTER);
+            if (op->op == SPI_BUS_OP_CMD)
+                HAL_GPIO_WritePin(handle->pins.dc_port, handle->pins.dc_pin, GPIO_PIN_RESET);
+            else
+                HAL_GPIO_WritePin(handle->pins.dc_port, handle->pins.dc_pin, GPIO_PIN_SET);
 
-    if (res != EPD3IN7_DRIVER_OK)
-    {
-        return res;
-    }
+            if (HAL_SPI_Transmit(handle->spi_handle, (uint8_t *)op->tx, op->arg, EPD3IN7_DRIVER_SPI_TIMEOUT) != HAL_OK)
+            {
+                err = EPD3IN7_DRIVER_ERR_HAL;
+                goto fail;
+            }
+            continue;
+        }
 
-    const uint8_t *lut_ptr = NULL;
+        if (handle->is_cs_low)
+            epd3in7_driver_send_end(handle);
 
-    if (lut == EPD3IN7_DRIVER_LUT_4_GRAY_GC)
-    {
-        lut_ptr = epd3in7_driver_lut_4_gray_gc;
-    }
-    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_GC)
-    {
-        lut_ptr = epd3in7_driver_lut_1_gray_gc;
+        if (op->op == SPI_BUS_OP_GPIO)
+        {
+            /* RESET is active low */
+            HAL_GPIO_WritePin(handle->pins.reset_port, handle->pins.reset_pin, op->arg ? GPIO_PIN_RESET : GPIO_PIN_SET);
+        }
+        else if (op->op == SPI_BUS_OP_DELAY)
+        {
+            HAL_Delay(op->arg);
+        }
+        else if (op->op == SPI_BUS_OP_WAIT)
+        {
+            EPD3IN7_DRIVER_TRY(epd3in7_driver_busy_wait_for_idle(handle));
+        }
     }
-    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_DU)
+
+    if (keep_cs && !handle->is_cs_low)
+        epd3in7_driver_send_begin(handle);
+    else if (!keep_cs && handle->is_cs_low)
+        epd3in7_driver_send_end(handle);
+
+    return EPD3IN7_DRIVER_OK;
+
+fail:
+    epd3in7_driver_send_end(handle);
+    return err;
+}
+
+static epd3in7_driver_status epd3in7_driver_load_lut(epd3in7_driver_handle *handle, const epd3in7_driver_lut_type lut)
+{
+    if (handle->last_lut_has_value && handle->last_lut == lut && handle->last_lut_band == handle->temp_band)
     {
-        lut_ptr = epd3in7_driver_lut_1_gray_du;
+        return EPD3IN7_DRIVER_OK;
     }
-    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_A2)
+
+    const spi_bus_op *prog = epd3in7_driver_lut_program(lut, handle->temp_band);
+
+    if (prog == NULL)
     {
-        lut_ptr = epd3in7_driver_lut_1_gray_a2;
+        return EPD3IN7_DRIVER_ERR_PARAM;
     }
 
-    if (lut_ptr)
-    {
-        res = epd3in7_driver_send_data_many(handle, lut_ptr, 105);
+    epd3in7_driver_status res = epd3in7_driver_run(handle, prog, EPD3IN7_DRIVER_LUT_PROGRAM_LEN);
 
-        if (res != EPD3IN7_DRIVER_OK)
-        {
-            return res;
-        }
+    if (res != EPD3IN7_DRIVER_OK)
+    {
+        return res;
     }
 
     handle->last_lut_has_value = true;
     handle->last_lut = lut;
+    handle->last_lut_band = handle->temp_band;
 
-    return err;
+    return EPD3IN7_DRIVER_OK;
+}
+
+void epd3in7_driver_set_temperature(epd3in7_driver_handle *handle, const float celsius)
+{
+    if (!handle)
+        return;
+
+#if !EPD3IN7_DRIVER_TEMP_BANDS
+    (void)celsius;
+    handle->temp_band = EPD3IN7_DRIVER_TEMP_BAND_NORMAL;
+#else
+    /* Thresholds from the warm side; leaving a colder band needs EPD3IN7_DRIVER_TEMP_HYSTERESIS more */
+    const float up = (float)EPD3IN7_DRIVER_TEMP_HYSTERESIS;
+    epd3in7_driver_temp_band band = handle->temp_band;
+
+    if (celsius < (float)EPD3IN7_DRIVER_TEMP_FREEZING_BELOW)
+        band = EPD3IN7_DRIVER_TEMP_BAND_FREEZING;
+    else if (celsius < (float)EPD3IN7_DRIVER_TEMP_COLD_BELOW)
+        band = (band == EPD3IN7_DRIVER_TEMP_BAND_FREEZING && celsius < EPD3IN7_DRIVER_TEMP_FREEZING_BELOW + up)
+                   ? EPD3IN7_DRIVER_TEMP_BAND_FREEZING
+                   : EPD3IN7_DRIVER_TEMP_BAND_COLD;
+    else
+        band = (band != EPD3IN7_DRIVER_TEMP_BAND_NORMAL && celsius < EPD3IN7_DRIVER_TEMP_COLD_BELOW + up)
+                   ? EPD3IN7_DRIVER_TEMP_BAND_COLD
+                   : EPD3IN7_DRIVER_TEMP_BAND_NORMAL;
+
+    /* The next LUT load (blocking or queued) picks the band up; the cached LUT stays valid until then */
+    handle->temp_band = band;
+#endif
 }
 
 epd3in7_driver_handle epd3in7_driver_create(const epd3in7_driver_pins pins, SPI_HandleTypeDef *spi_handle, const bool busy_active_high)
@@ -260,6 +541,22 @@ epd3in7_driver_handle epd3in7_driver_create(const epd3in7_driver_pins pins, SPI_
 
     handle.last_lut_has_value = false;
     handle.last_lut = EPD3IN7_DRIVER_LUT_4_GRAY_GC;
+    handle.last_lut_band = EPD3IN7_DRIVER_TEMP_BAND_NORMAL;
+    handle.temp_band = EPD3IN7_DRIVER_TEMP_BAND_NORMAL;
+    memset(&handle.bus_dev, 0, sizeof(handle.bus_dev));
+    handle.bus_dev_id = 0;
+    handle.bus_dev_has_value = false;
+    memset(&handle.stream_dev, 0, sizeof(handle.stream_dev));
+    handle.stream_dev_id = 0;
+    handle.stream_dev_has_value = false;
+    handle.stream_fill = NULL;
+    handle.stream_user = NULL;
+    handle.stream_bands = NULL;
+    handle.stream_band_size = 0;
+    handle.stream_band_rows = 0;
+    handle.stream_band_count = 0;
+    handle.stream_halves = 0;
+    handle.stream_area = (epd3in7_driver_area){0, 0, 0, 0};
 
     handle.is_cs_low = false;
     handle.is_cs_low_has_value = false;
@@ -302,222 +599,42 @@ epd3in7_driver_status epd3in7_driver_busy_wait_for_idle(const epd3in7_driver_han
         {
             return EPD3IN7_DRIVER_ERR_TIMEOUT;
         }
+        /* Sleep until the next interrupt (BUSY edge or SysTick) instead of spinning */
+        __WFI();
     } while (handle->busy_active_high ? busy == GPIO_PIN_SET : busy == GPIO_PIN_RESET);
 
-    HAL_Delay(200);
     return EPD3IN7_DRIVER_OK;
 }
 
 epd3in7_driver_status epd3in7_driver_sleep(epd3in7_driver_handle *handle, const epd3in7_driver_sleep_mode mode)
 {
-    epd3in7_driver_status err = EPD3IN7_DRIVER_OK;
-
     if (mode == EPD3IN7_DRIVER_SLEEP_DEEP)
     {
-        epd3in7_driver_send_begin(handle);
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD3IN7_DRIVER_SLEEP_DEEP));
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x03));
-        epd3in7_driver_send_end(handle);
-    }
-    else
-    {
-        epd3in7_driver_send_begin(handle);
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SLEEP));
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0xF7));
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_POWEROFF));
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SLEEP2));
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0xA5));
-        epd3in7_driver_send_end(handle);
+        return epd3in7_driver_run(handle, epd3in7_driver_prog_sleep_deep, SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_sleep_deep));
     }
 
-    return EPD3IN7_DRIVER_OK;
-
-fail:
-    epd3in7_driver_send_end(handle);
-    return err;
+    return epd3in7_driver_run(handle, epd3in7_driver_prog_sleep, SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_sleep));
 }
 
 void epd3in7_driver_reset(const epd3in7_driver_handle *handle)
 {
-    HAL_GPIO_WritePin(handle->pins.reset_port, handle->pins.reset_pin, GPIO_PIN_SET);
-    HAL_Delay(300);
-    HAL_GPIO_WritePin(handle->pins.reset_port, handle->pins.reset_pin, GPIO_PIN_RESET);
-    HAL_Delay(3);
-    HAL_GPIO_WritePin(handle->pins.reset_port, handle->pins.reset_pin, GPIO_PIN_SET);
-    HAL_Delay(300);
+    /* GPIO and DELAY ops only: no CS state is touched */
+    (void)epd3in7_driver_run((epd3in7_driver_handle *)handle, epd3in7_driver_prog_reset, SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_reset));
 }
 
 epd3in7_driver_status epd3in7_driver_init_4_gray(epd3in7_driver_handle *handle)
 {
-    epd3in7_driver_status err = EPD3IN7_DRIVER_OK;
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_busy_wait_for_idle(handle));
-
-    epd3in7_driver_reset(handle);
-
-    epd3in7_driver_send_begin(handle);
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SW_RESET));
-
-    HAL_Delay(300);
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_AUTO_WRITE_RED_RAM_REG_PATTERN) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0xF7) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_busy_wait_for_idle(handle) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_command(handle, EPD_CMD_AUTO_WRITE_BW_RAM_REG_PATTERN) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0xF7) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_busy_wait_for_idle(handle) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_GATE_SETTING) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    uint8_t gate_setting[] = {0xDF, 0x01, 0x00};
-    if (epd3in7_driver_send_data_many(handle, gate_setting, 3) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_GATE_VOLTAGE) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0x00) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_GATE_VOLTAGE_SOURCE) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    uint8_t gate_voltage_source[] = {0x41, 0xA8, 0x32};
-    if (epd3in7_driver_send_data_many(handle, gate_voltage_source, 3) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_DATA_ENTRY_SEQUENCE) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0x03) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_BORDER_WAVEFORM_CONTROL) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0x03) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_BOOSTER_SOFT_START_CONTROL) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    uint8_t booster[] = {0xAE, 0xC7, 0xC3, 0xC0, 0xC0};
-    if (epd3in7_driver_send_data_many(handle, booster, 5) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_TEMPERATURE_SENSOR_SELECTION) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0x80) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_WRITE_VCOM_REGISTER) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0x44) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_DISPLAY_OPTION) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    uint8_t display_option[10] = {0};
-    if (epd3in7_driver_send_data_many(handle, display_option, 10) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMX_START_END) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    uint8_t ramx[] = {0x00, 0x00, 0x17, 0x01};
-    if (epd3in7_driver_send_data_many(handle, ramx, 4) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMY_START_END) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    uint8_t ramy[] = {0x00, 0x00, 0xDF, 0x01};
-    if (epd3in7_driver_send_data_many(handle, ramy, 4) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    if (epd3in7_driver_send_command(handle, EPD_CMD_DISPLAY_UPDATE_SEQUENCE_SETTING) != EPD3IN7_DRIVER_OK)
-        goto fail;
-    if (epd3in7_driver_send_data(handle, 0xCF) != EPD3IN7_DRIVER_OK)
-        goto fail;
-
-    epd3in7_driver_send_end(handle);
+    epd3in7_driver_status err = epd3in7_driver_run(handle, epd3in7_driver_prog_init_4_gray, SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_init_4_gray));
 
     handle->last_lut_has_value = false;
-    return EPD3IN7_DRIVER_OK;
-fail:
-    epd3in7_driver_send_end(handle);
     return err;
 }
 
 epd3in7_driver_status epd3in7_driver_init_1_gray(epd3in7_driver_handle *handle)
 {
-    epd3in7_driver_status err = EPD3IN7_DRIVER_OK;
-
-    epd3in7_driver_reset(handle);
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_busy_wait_for_idle(handle));
-
-    epd3in7_driver_send_begin(handle);
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SW_RESET));
-    HAL_Delay(300);
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_AUTO_WRITE_RED_RAM_REG_PATTERN));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0xF7));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_busy_wait_for_idle(handle));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_AUTO_WRITE_BW_RAM_REG_PATTERN));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0xF7));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_busy_wait_for_idle(handle));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_GATE_SETTING));
-    uint8_t gate_setting[] = {0xDF, 0x01, 0x00};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, gate_setting, 3));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_GATE_VOLTAGE));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x00));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_GATE_VOLTAGE_SOURCE));
-    uint8_t gate_voltage_source[] = {0x41, 0xA8, 0x32};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, gate_voltage_source, 3));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_DATA_ENTRY_SEQUENCE));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x03));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_BORDER_WAVEFORM_CONTROL));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x03));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_BOOSTER_SOFT_START_CONTROL));
-    uint8_t booster[] = {0xAE, 0xC7, 0xC3, 0xC0, 0xC0};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, booster, 5));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_TEMPERATURE_SENSOR_SELECTION));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x80));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_WRITE_VCOM_REGISTER));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x44));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_DISPLAY_OPTION));
-    uint8_t display_option[] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x4F, 0xFF, 0xFF, 0xFF, 0xFF};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, display_option, 10));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMX_START_END));
-    uint8_t ramx[] = {0x00, 0x00, 0x17, 0x01};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, ramx, 4));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMY_START_END));
-    uint8_t ramy[] = {0x00, 0x00, 0xDF, 0x01};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, ramy, 4));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_DISPLAY_UPDATE_SEQUENCE_SETTING));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0xCF));
-
-    epd3in7_driver_send_end(handle);
+    epd3in7_driver_status err = epd3in7_driver_run(handle, epd3in7_driver_prog_init_1_gray, SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_init_1_gray));
 
     handle->last_lut_has_value = false;
-    return EPD3IN7_DRIVER_OK;
-fail:
-    epd3in7_driver_send_end(handle);
     return err;
 }
 
@@ -651,41 +768,12 @@ epd3in7_driver_status epd3in7_driver_display_4_gray(epd3in7_driver_handle *handl
 
     EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_WRITE_RAM));
 
-    // pętla z konwersją, nie można użyć send_data_many
-    for (uint32_t i = 0; i < image_counter; i++)
+    // pętla z konwersją, nie można użyć send_data_many: RAM dostaje młodsze bity pikseli
+    for (uint32_t i = 0; i < image_counter; i += 2)
     {
-        uint8_t temp3 = 0;
-        for (uint32_t j = 0; j < 2; j++)
-        {
-            uint8_t temp1 = image[i * 2 + j];
-            for (uint32_t k = 0; k < 2; k++)
-            {
-                uint8_t temp2 = temp1 & 0xC0;
-                if (temp2 == 0xC0)
-                    temp3 |= 0x01; // white
-                else if (temp2 == 0x00)
-                    temp3 |= 0x00; // black
-                else if (temp2 == 0x80)
-                    temp3 |= 0x00; // gray1
-                else               // 0x40
-                    temp3 |= 0x01; // gray2
-                temp3 <<= 1;
-                temp1 <<= 2;
-                temp2 = temp1 & 0xC0;
-                if (temp2 == 0xC0) // white
-                    temp3 |= 0x01;
-                else if (temp2 == 0x00) // black
-                    temp3 |= 0x00;
-                else if (temp2 == 0x80)
-                    temp3 |= 0x00; // gray1
-                else               // 0x40
-                    temp3 |= 0x01; // gray2
-                if (j != 1 || k != 1)
-                    temp3 <<= 1;
-                temp1 <<= 2;
-            }
-        }
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, temp3));
+        const uint16_t lo = epd3in7_driver_i2_plane_bits(epd3in7_driver_i2_load(image + i * 2));
+        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, (uint8_t)(lo >> 8)));
+        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, (uint8_t)lo));
     }
 
     // new  data
@@ -699,40 +787,12 @@ epd3in7_driver_status epd3in7_driver_display_4_gray(epd3in7_driver_handle *handl
 
     EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_WRITE_RAM2));
 
-    for (uint32_t i = 0; i < image_counter; i++)
+    // RAM2: starsze bity pikseli
+    for (uint32_t i = 0; i < image_counter; i += 2)
     {
-        uint8_t temp3 = 0;
-        for (uint32_t j = 0; j < 2; j++)
-        {
-            uint8_t temp1 = image[i * 2 + j];
-            for (uint32_t k = 0; k < 2; k++)
-            {
-                uint8_t temp2 = temp1 & 0xC0;
-                if (temp2 == 0xC0)
-                    temp3 |= 0x01; // white
-                else if (temp2 == 0x00)
-                    temp3 |= 0x00; // black
-                else if (temp2 == 0x80)
-                    temp3 |= 0x01; // gray1
-                else               // 0x40
-                    temp3 |= 0x00; // gray2
-                temp3 <<= 1;
-                temp1 <<= 2;
-                temp2 = temp1 & 0xC0;
-                if (temp2 == 0xC0) // white
-                    temp3 |= 0x01;
-                else if (temp2 == 0x00) // black
-                    temp3 |= 0x00;
-                else if (temp2 == 0x80)
-                    temp3 |= 0x01; // gray1
-                else               // 0x40
-                    temp3 |= 0x00; // gray2
-                if (j != 1 || k != 1)
-                    temp3 <<= 1;
-                temp1 <<= 2;
-            }
-        }
-        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, temp3));
+        const uint16_t hi = epd3in7_driver_i2_plane_bits(epd3in7_driver_i2_load(image + i * 2) >> 1);
+        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, (uint8_t)(hi >> 8)));
+        EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, (uint8_t)hi));
     }
 
     EPD3IN7_DRIVER_TRY(epd3in7_driver_load_lut(handle, EPD3IN7_DRIVER_LUT_4_GRAY_GC));
@@ -753,33 +813,18 @@ epd3in7_driver_status epd3in7_driver_display_1_gray(epd3in7_driver_handle *handl
 {
     epd3in7_driver_status err = EPD3IN7_DRIVER_OK;
 
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_busy_wait_for_idle(handle));
+    /* Same sequence as epd3in7_driver_display_1_gray_dma() */
+    EPD3IN7_DRIVER_TRY(epd3in7_driver_run(handle, epd3in7_driver_prog_frame_setup, SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_frame_setup)));
 
     epd3in7_driver_send_begin(handle);
 
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMX_START_END));
-    uint8_t ramx[] = {0x00, 0x00, 0x17, 0x01};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, ramx, 4));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMY_START_END));
-    uint8_t ramy[] = {0x00, 0x00, 0xDF, 0x01};
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, ramy, 4));
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMX_COUNTER));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x00));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_SET_RAMY_COUNTER));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x00));
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data(handle, 0x00));
-
     const uint16_t image_counter = EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8;
-
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_WRITE_RAM));
     EPD3IN7_DRIVER_TRY(epd3in7_driver_send_data_many(handle, image, image_counter));
 
     epd3in7_driver_lut_type lut_type = epd3in7_driver_mode_to_lut(mode, true);
     EPD3IN7_DRIVER_TRY(epd3in7_driver_load_lut(handle, lut_type));
 
-    EPD3IN7_DRIVER_TRY(epd3in7_driver_send_command(handle, EPD_CMD_DISPLAY_UPDATE_SEQUENCE));
+    EPD3IN7_DRIVER_TRY(epd3in7_driver_run(handle, epd3in7_driver_prog_update, SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_update)));
     epd3in7_driver_send_end(handle);
 
     return EPD3IN7_DRIVER_OK;
@@ -858,149 +903,188 @@ fail:
 
 // === DMA / SPI BUS MANAGER IMPLEMENTATION ===
 
-// Command and data bytes for DMA transactions.
-// These are used to build spi_bus_transaction objects.
-
-uint8_t epd3in7_driver_dma_ramx_start_end_payload[] = {0x00, 0x00, 0x17, 0x01};
-uint8_t epd3in7_driver_dma_ramy_start_end_payload[] = {0x00, 0x00, 0xDF, 0x01};
-uint8_t epd3in7_driver_dma_ramx_counter_payload = 0x00;
-uint8_t epd3in7_driver_dma_ramy_counter_payload[] = {0x00, 0x00};
-uint8_t epd3in7_driver_dma_ramx_start_end = EPD_CMD_SET_RAMX_START_END;
-uint8_t epd3in7_driver_dma_ramy_start_end = EPD_CMD_SET_RAMY_START_END;
-uint8_t epd3in7_driver_dma_ramx_counter = EPD_CMD_SET_RAMX_COUNTER;
-uint8_t epd3in7_driver_dma_ramy_counter = EPD_CMD_SET_RAMY_COUNTER;
-uint8_t epd3in7_driver_dma_write_ram = EPD_CMD_WRITE_RAM; // 0x24
-uint8_t epd3in7_driver_dma_display_update = EPD_CMD_DISPLAY_UPDATE_SEQUENCE;
-uint8_t epd3in7_driver_dma_cmd_lut = EPD_CMD_WRITE_LUT_REGISTER;
-uint8_t epd3in7_driver_dma_sleep_deep = EPD3IN7_DRIVER_SLEEP_DEEP;
-uint8_t epd3in7_driver_dma_sleep = EPD_CMD_SLEEP;
-uint8_t epd3in7_driver_dma_power_off = EPD_CMD_POWEROFF;
-uint8_t epd3in7_driver_dma_sleep2 = EPD_CMD_SLEEP2;
-
-/* Build a "single byte command" transaction. */
-static spi_bus_transaction epd_tx_cmd(epd3in7_driver_handle *h,
-                                      spi_bus_gpio cs, spi_bus_gpio dc,
-                                      uint8_t *cmd)
+// Sequences are the command programs above, queued as program items: the manager runs their
+// delays and BUSY waits from on_tick without blocking and keeps the bus free meanwhile.
+
+/* BUSY predicate for the bus manager waits (non-blocking, single GPIO read). */
+static bool epd_wait_ready(void *user)
+{
+    return !epd3in7_driver_is_busy((const epd3in7_driver_handle *)user);
+}
+
+/* Register the panel with the bus manager on first DMA use (handle is at its final address by then).
+   CR1/CR2 are snapshotted for mode and frame format; the manager replaces the prescaler to run at
+   EPD3IN7_DRIVER_SPI_MAX_HZ. */
+static epd3in7_driver_status epd_bus_device(epd3in7_driver_handle *h, spi_bus_manager *mgr)
+{
+    if (h->bus_dev_has_value)
+        return EPD3IN7_DRIVER_OK;
+
+    spi_bus_device d = {0};
+    d.cs = (spi_bus_gpio){h->pins.cs_port, h->pins.cs_pin, true};          /* active low */
+    d.dc = (spi_bus_gpio){h->pins.dc_port, h->pins.dc_pin, false};         /* data=HIGH */
+    d.reset = (spi_bus_gpio){h->pins.reset_port, h->pins.reset_pin, true}; /* active low */
+    d.cr1 = h->spi_handle->Instance->CR1;
+    d.cr2 = h->spi_handle->Instance->CR2;
+    d.max_sclk_hz = EPD3IN7_DRIVER_SPI_MAX_HZ;
+    d.spi_timeout = HAL_MAX_DELAY;
+    d.wait_ready = epd_wait_ready;
+    d.wait_timeout_ms = EPD3IN7_DRIVER_BUSY_TIMEOUT;
+    d.cb = NULL;
+    h->bus_dev = d;
+
+    if (spi_bus_manager_add_device(mgr, &h->bus_dev, &h->bus_dev_id) != SPI_BUS_MANAGER_OK)
+        return EPD3IN7_DRIVER_SPI_BUS_ERR;
+
+    h->bus_dev_has_value = true;
+    return EPD3IN7_DRIVER_OK;
+}
+
+/* Produce band @p band of the queued stream into its slot (bands alternate between the two slots) */
+static void epd_stream_fill(epd3in7_driver_handle *h, uint16_t band)
+{
+    const uint16_t first = (uint16_t)(band * h->stream_band_rows);
+    uint16_t rows = (uint16_t)(h->stream_area.h - first);
+    if (rows > h->stream_band_rows)
+        rows = h->stream_band_rows;
+    h->stream_fill(h->stream_user, (uint16_t)(h->stream_area.y + first), rows,
+                   h->stream_bands + (size_t)(band & 1u) * h->stream_band_size);
+}
+
+/* Half-transfer of band j (ISR): band j-1 has left its slot, which now takes band j+1.
+   Bands 0 and 1 are produced at submit, so band 0 has nothing to refill. */
+static void epd_stream_half(struct spi_bus_manager *mgr, void *user)
+{
+    (void)mgr;
+    epd3in7_driver_handle *h = (epd3in7_driver_handle *)user;
+    const uint16_t next = (uint16_t)(h->stream_halves + 1u);
+    h->stream_halves = next;
+    if (next >= 2u && next < h->stream_band_count)
+        epd_stream_fill(h, next);
+}
+
+static const spi_bus_callbacks epd3in7_driver_stream_cbs = {
+    .on_half = epd_stream_half,
+    .on_done = NULL,
+    .on_error = NULL,
+};
+
+/* Second profile for streamed bands: same lines and registers, with the half-transfer refill.
+   Its items are never chunked (on_half), so a band should stay near the manager's chunk size. */
+static epd3in7_driver_status epd_stream_device(epd3in7_driver_handle *h, spi_bus_manager *mgr)
+{
+    if (h->stream_dev_has_value)
+        return EPD3IN7_DRIVER_OK;
+
+    h->stream_dev = h->bus_dev;
+    h->stream_dev.cb = &epd3in7_driver_stream_cbs;
+
+    if (spi_bus_manager_add_device(mgr, &h->stream_dev, &h->stream_dev_id) != SPI_BUS_MANAGER_OK)
+        return EPD3IN7_DRIVER_SPI_BUS_ERR;
+
+    h->stream_dev_has_value = true;
+    return EPD3IN7_DRIVER_OK;
+}
+
+/* Queue a command program. The handle is the user pointer (BUSY predicate of WAIT ops).
+   @p wait additionally holds the bus queue until BUSY is released after the last op. */
+static epd3in7_driver_status epd_submit_program(epd3in7_driver_handle *h, spi_bus_manager *mgr,
+                                                const spi_bus_op *prog, uint16_t op_count, bool wait,
+                                                uint8_t tag)
 {
     spi_bus_transaction t = {0};
-    t.kind = SPI_BUS_ITEM_TX;
-    t.cs = cs;
-    t.dc = dc;
-    t.dc_mode = SPI_BUS_DC_COMMAND;
-    /* Keep current CR1/CR2 as-is (SPI already configured for this device) */
-    t.cr1 = h->spi_handle->Instance->CR1;
-    t.cr2 = h->spi_handle->Instance->CR2;
-    t.tx = cmd;
-    t.rx = NULL;
-    t.len = 1;
+    t.kind = SPI_BUS_ITEM_PROGRAM;
+    t.dev = h->bus_dev_id;
+    t.tag = tag;
+    t.prog = prog;
+    t.op_count = op_count;
     t.dir = SPI_BUS_DIR_TX;
-    t.spi_timeout = HAL_MAX_DELAY;
-    t.wait_ready = NULL;
-    t.wait_timeout_ms = 0;
-    t.on_done = NULL;
-    t.on_half = NULL;
-    t.on_error = NULL;
-    t.user = NULL;
-    return t;
+    t.wait = wait ? 1 : 0;
+    t.user = h;
+
+    if (spi_bus_manager_submit(mgr, &t) != SPI_BUS_MANAGER_OK)
+        return EPD3IN7_DRIVER_SPI_BUS_ERR;
+
+    return EPD3IN7_DRIVER_OK;
 }
 
-/* Build a "data block" transaction. Optionally attach a BUSY wait after it. */
-static spi_bus_transaction epd_tx_data(epd3in7_driver_handle *h,
-                                       spi_bus_gpio cs, spi_bus_gpio dc,
+/* Build a "data block" transaction. */
+static spi_bus_transaction epd_tx_data(const epd3in7_driver_handle *h,
                                        const uint8_t *buf, uint32_t len)
 {
     assert(len <= 65535);
 
     spi_bus_transaction t = {0};
     t.kind = SPI_BUS_ITEM_TX;
-    t.cs = cs;
-    t.dc = dc;
+    t.dev = h->bus_dev_id;
+    t.tag = EPD3IN7_DRIVER_TAG_UPLOAD;
     t.dc_mode = SPI_BUS_DC_DATA;
-    t.cr1 = h->spi_handle->Instance->CR1;
-    t.cr2 = h->spi_handle->Instance->CR2;
     t.tx = buf;
     t.rx = NULL;
     t.len = (uint16_t)len; /* If len > 65535, enqueue in chunks before calling this. */
     t.dir = SPI_BUS_DIR_TX;
-    t.spi_timeout = HAL_MAX_DELAY;
-    t.on_done = NULL;
-    t.on_half = NULL;
-    t.on_error = NULL;
-    t.wait_ready = NULL;
-    t.wait_timeout_ms = 0;
-    t.user = NULL;
-
-    return t;
-}
-
-static spi_bus_transaction epd_tx_cmd_wait(epd3in7_driver_handle *h,
-                                           spi_bus_gpio cs, spi_bus_gpio dc,
-                                           uint8_t *cmd)
-{
-    spi_bus_transaction t = {0};
-    t.kind = SPI_BUS_ITEM_TX;
-    t.cs = cs;
-    t.dc = dc;
-    t.dc_mode = SPI_BUS_DC_COMMAND; // DC=0
-    t.cr1 = h->spi_handle->Instance->CR1;
-    t.cr2 = h->spi_handle->Instance->CR2;
-    t.tx = cmd;
-    t.rx = NULL;
-    t.len = 1;
-    t.dir = SPI_BUS_DIR_TX;
-    t.spi_timeout = HAL_MAX_DELAY;
-    t.wait_ready = NULL;
-    t.wait_timeout_ms = 0;
     t.user = NULL;
 
     return t;
 }
 
-/* Enqueue small data buffer (command's payload). */
-static spi_bus_transaction epd_tx_payload(epd3in7_driver_handle *h,
-                                          spi_bus_gpio cs, spi_bus_gpio dc,
-                                          const uint8_t *buf, uint16_t len)
-{
-    return epd_tx_data(h, cs, dc, buf, len);
-}
-
 /* Enqueue a LUT write (mirrors epd3in7_driver_load_lut, but queue-based). */
 static epd3in7_driver_status epd3in7_enqueue_lut(epd3in7_driver_handle *h,
                                                  spi_bus_manager *mgr,
-                                                 spi_bus_gpio cs, spi_bus_gpio dc,
                                                  epd3in7_driver_lut_type lut)
 {
-    if (h->last_lut_has_value && h->last_lut == lut)
+    if (h->last_lut_has_value && h->last_lut == lut && h->last_lut_band == h->temp_band)
     {
         return EPD3IN7_DRIVER_OK;
     }
 
-    const uint8_t *lut_ptr = NULL;
-    if (lut == EPD3IN7_DRIVER_LUT_4_GRAY_GC)
-        lut_ptr = epd3in7_driver_lut_4_gray_gc;
-    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_GC)
-        lut_ptr = epd3in7_driver_lut_1_gray_gc;
-    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_DU)
-        lut_ptr = epd3in7_driver_lut_1_gray_du;
-    else if (lut == EPD3IN7_DRIVER_LUT_1_GRAY_A2)
-        lut_ptr = epd3in7_driver_lut_1_gray_a2;
-
-    if (!lut_ptr)
+    const spi_bus_op *prog = epd3in7_driver_lut_program(lut, h->temp_band);
+    if (!prog)
         return EPD3IN7_DRIVER_ERR_PARAM;
 
-    spi_bus_transaction t_cmd = epd_tx_cmd(h, cs, dc, &epd3in7_driver_dma_cmd_lut);
-    if (spi_bus_manager_submit(mgr, &t_cmd) != SPI_BUS_MANAGER_OK)
-        return EPD3IN7_DRIVER_SPI_BUS_ERR;
-
-    spi_bus_transaction t_data = epd_tx_payload(h, cs, dc, lut_ptr, 105);
-    if (spi_bus_manager_submit(mgr, &t_data) != SPI_BUS_MANAGER_OK)
-        return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    epd3in7_driver_status st = epd_submit_program(h, mgr, prog, EPD3IN7_DRIVER_LUT_PROGRAM_LEN, false,
+                                                   EPD3IN7_DRIVER_TAG_REFRESH);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
 
     h->last_lut_has_value = true;
     h->last_lut = lut;
+    h->last_lut_band = h->temp_band;
+    return EPD3IN7_DRIVER_OK;
+}
+
+/* Queue one of the init programs (RESET pulse, BUSY waits and delays included). */
+static epd3in7_driver_status epd_init_dma(epd3in7_driver_handle *handle, spi_bus_manager *mgr,
+                                          const spi_bus_op *prog, uint16_t op_count)
+{
+    if (!handle || !mgr)
+        return EPD3IN7_DRIVER_ERR_PARAM;
+
+    epd3in7_driver_status st = epd_bus_device(handle, mgr);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    st = epd_submit_program(handle, mgr, prog, op_count, false, 0);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    /* The controller forgets its LUT on reset */
+    handle->last_lut_has_value = false;
     return EPD3IN7_DRIVER_OK;
 }
 
+epd3in7_driver_status epd3in7_driver_init_4_gray_dma(epd3in7_driver_handle *handle, spi_bus_manager *mgr)
+{
+    return epd_init_dma(handle, mgr, epd3in7_driver_prog_init_4_gray,
+                        SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_init_4_gray));
+}
+
+epd3in7_driver_status epd3in7_driver_init_1_gray_dma(epd3in7_driver_handle *handle, spi_bus_manager *mgr)
+{
+    return epd_init_dma(handle, mgr, epd3in7_driver_prog_init_1_gray,
+                        SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_init_1_gray));
+}
+
 epd3in7_driver_status epd3in7_driver_display_1_gray_dma(epd3in7_driver_handle *handle,
                                                         spi_bus_manager *mgr,
                                                         const uint8_t *image,
@@ -1009,84 +1093,272 @@ epd3in7_driver_status epd3in7_driver_display_1_gray_dma(epd3in7_driver_handle *h
     if (!handle || !mgr || !image)
         return EPD3IN7_DRIVER_ERR_PARAM;
 
-    /* Prepare GPIO roles for the manager based on driver pins. */
-    spi_bus_gpio cs = {handle->pins.cs_port, handle->pins.cs_pin, true};  /* active low */
-    spi_bus_gpio dc = {handle->pins.dc_port, handle->pins.dc_pin, false}; /* data=HIGH */
+    /* Device profile (CS/DC/RESET lines, CR1/CR2, BUSY predicate) for the manager. */
+    epd3in7_driver_status st = epd_bus_device(handle, mgr);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
 
-    /* Sequence mirrors the blocking epd3in7_driver_display_1_gray() */
+    /* Sequence shared with the blocking epd3in7_driver_display_1_gray() */
 
-    /* SET_RAMX_START_END */
-    {
-        spi_bus_transaction tr = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_ramx_start_end);
-
-        if (spi_bus_manager_submit(mgr, &tr) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    /* BUSY wait, RAM window and counters, WRITE_RAM: polled, no interrupt unless BUSY parks it */
+    st = epd_submit_program(handle, mgr, epd3in7_driver_prog_frame_setup,
+                            SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_frame_setup), false,
+                            EPD3IN7_DRIVER_TAG_UPLOAD);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
 
-        spi_bus_transaction tr2 = epd_tx_payload(handle, cs, dc, epd3in7_driver_dma_ramx_start_end_payload, sizeof(epd3in7_driver_dma_ramx_start_end_payload));
-        if (spi_bus_manager_submit(mgr, &tr2) != SPI_BUS_MANAGER_OK)
+    /* Frame data (kept as a separate item so the manager can chunk it; the controller
+       keeps writing RAM across CS toggles) */
+    {
+        const uint16_t image_counter = (uint16_t)(EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8); // 16800
+        spi_bus_transaction tr_data = epd_tx_data(handle, image, image_counter);
+        if (spi_bus_manager_submit(mgr, &tr_data) != SPI_BUS_MANAGER_OK)
             return EPD3IN7_DRIVER_SPI_BUS_ERR;
     }
 
-    /* SET_RAMY_START_END */
+    /* Load LUT for the selected mode. */
     {
-        spi_bus_transaction tr = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_ramy_start_end);
+        epd3in7_driver_lut_type lut_type = epd3in7_driver_mode_to_lut(mode, true);
+        epd3in7_driver_status s = epd3in7_enqueue_lut(handle, mgr, lut_type);
+        if (s != EPD3IN7_DRIVER_OK)
+            return s;
+    }
 
-        if (spi_bus_manager_submit(mgr, &tr) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    /* Display update; the queue is held until BUSY is released (see spi_bus_manager_on_tick()) */
+    return epd_submit_program(handle, mgr, epd3in7_driver_prog_update,
+                              SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_update), true,
+                              EPD3IN7_DRIVER_TAG_REFRESH);
+}
+
+/* Fill the handle's area window and the program that sends it:
+   WAIT, RAMX start/end, RAMY start/end, X counter, Y counter (10-bit, little endian), WRITE_RAM. */
+static void epd_build_area_program(epd3in7_driver_handle *h, const epd3in7_driver_area *a)
+{
+    const uint16_t x_end = (uint16_t)(a->x + a->w - 1u);
+    const uint16_t y_end = (uint16_t)(a->y + a->h - 1u);
+    uint8_t *win = h->area_window;
+
+    win[0] = a->x & 0xFF;
+    win[1] = (a->x >> 8) & 0x03;
+    win[2] = x_end & 0xFF;
+    win[3] = (x_end >> 8) & 0x03;
+    win[4] = a->y & 0xFF;
+    win[5] = (a->y >> 8) & 0x03;
+    win[6] = y_end & 0xFF;
+    win[7] = (y_end >> 8) & 0x03;
+    win[8] = win[0];
+    win[9] = win[1];
+    win[10] = win[4];
+    win[11] = win[5];
+
+    const uint8_t *cmd = epd3in7_driver_area_cmds;
+    spi_bus_op *p = h->area_prog;
+    p[0] = (spi_bus_op)SPI_BUS_WAIT_READY();
+    p[1] = (spi_bus_op){&cmd[0], 1u, SPI_BUS_OP_CMD};
+    p[2] = (spi_bus_op)SPI_BUS_DATA_BUF(&win[0], 4u);
+    p[3] = (spi_bus_op){&cmd[1], 1u, SPI_BUS_OP_CMD};
+    p[4] = (spi_bus_op)SPI_BUS_DATA_BUF(&win[4], 4u);
+    p[5] = (spi_bus_op){&cmd[2], 1u, SPI_BUS_OP_CMD};
+    p[6] = (spi_bus_op)SPI_BUS_DATA_BUF(&win[8], 2u);
+    p[7] = (spi_bus_op){&cmd[3], 1u, SPI_BUS_OP_CMD};
+    p[8] = (spi_bus_op)SPI_BUS_DATA_BUF(&win[10], 2u);
+    p[9] = (spi_bus_op){&cmd[4], 1u, SPI_BUS_OP_CMD};
+}
+
+/* Non-empty, byte-aligned in X and inside the panel */
+static bool epd_area_valid(const epd3in7_driver_area *a)
+{
+    if (a->w == 0u || a->h == 0u || (a->x & 7u) != 0u || (a->w & 7u) != 0u)
+        return false;
+    return (uint32_t)a->x + a->w <= EPD3IN7_WIDTH && (uint32_t)a->y + a->h <= EPD3IN7_HEIGHT;
+}
+
+epd3in7_driver_status epd3in7_driver_display_1_gray_area_dma(epd3in7_driver_handle *handle,
+                                                             spi_bus_manager *mgr,
+                                                             const uint8_t *image,
+                                                             const epd3in7_driver_area *area,
+                                                             const epd3in7_driver_mode mode)
+{
+    if (!handle || !mgr || !image || !area || !epd_area_valid(area))
+        return EPD3IN7_DRIVER_ERR_PARAM;
+
+    epd3in7_driver_status st = epd_bus_device(handle, mgr);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    /* The manager reads area_window only when the program runs; one window per handle */
+    if (spi_bus_manager_pending(mgr, handle->bus_dev_id, EPD3IN7_DRIVER_TAG_WINDOW) != 0u)
+        return EPD3IN7_DRIVER_ERR_BUSY;
+
+    epd_build_area_program(handle, area);
+    st = epd_submit_program(handle, mgr, handle->area_prog, EPD3IN7_DRIVER_AREA_PROGRAM_LEN, false,
+                            EPD3IN7_DRIVER_TAG_WINDOW);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
 
-        spi_bus_transaction tr2 = epd_tx_payload(handle, cs, dc, epd3in7_driver_dma_ramy_start_end_payload, sizeof(epd3in7_driver_dma_ramy_start_end_payload));
-        if (spi_bus_manager_submit(mgr, &tr2) != SPI_BUS_MANAGER_OK)
+    /* Rectangle data; the controller wraps rows at the window's X end */
+    {
+        const uint32_t len = (uint32_t)(area->w / 8u) * area->h; // <= 16800
+        spi_bus_transaction tr_data = epd_tx_data(handle, image, len);
+        if (spi_bus_manager_submit(mgr, &tr_data) != SPI_BUS_MANAGER_OK)
             return EPD3IN7_DRIVER_SPI_BUS_ERR;
     }
 
-    /* SET_RAMX/Y_COUNTER */
     {
+        epd3in7_driver_lut_type lut_type = epd3in7_driver_mode_to_lut(mode, true);
+        epd3in7_driver_status s = epd3in7_enqueue_lut(handle, mgr, lut_type);
+        if (s != EPD3IN7_DRIVER_OK)
+            return s;
+    }
 
-        spi_bus_transaction tr = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_ramx_counter);
-        if (spi_bus_manager_submit(mgr, &tr) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    return epd_submit_program(handle, mgr, epd3in7_driver_prog_update,
+                              SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_update), true,
+                              EPD3IN7_DRIVER_TAG_REFRESH);
+}
 
-        spi_bus_transaction tr2 = epd_tx_payload(handle, cs, dc, &epd3in7_driver_dma_ramx_counter_payload, 1);
-        if (spi_bus_manager_submit(mgr, &tr2) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+epd3in7_driver_status epd3in7_driver_display_1_gray_stream_dma(epd3in7_driver_handle *handle,
+                                                               spi_bus_manager *mgr,
+                                                               const epd3in7_driver_area *area,
+                                                               uint8_t *bands,
+                                                               uint16_t band_size,
+                                                               uint16_t band_rows,
+                                                               epd3in7_driver_fill_fn fill,
+                                                               void *user,
+                                                               const epd3in7_driver_mode mode)
+{
+    if (!handle || !mgr || !area || !bands || !fill || band_rows == 0u || !epd_area_valid(area))
+        return EPD3IN7_DRIVER_ERR_PARAM;
 
-        spi_bus_transaction tr3 = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_ramy_counter);
-        if (spi_bus_manager_submit(mgr, &tr3) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    const uint32_t row_bytes = area->w / 8u;
+    if ((uint32_t)band_rows * row_bytes > band_size)
+        return EPD3IN7_DRIVER_ERR_PARAM;
 
-        spi_bus_transaction tr4 = epd_tx_payload(handle, cs, dc, epd3in7_driver_dma_ramy_counter_payload, 2);
-        if (spi_bus_manager_submit(mgr, &tr4) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    epd3in7_driver_status st = epd_bus_device(handle, mgr);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+    st = epd_stream_device(handle, mgr);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    const bool full = area->x == 0u && area->y == 0u && area->w == EPD3IN7_WIDTH && area->h == EPD3IN7_HEIGHT;
+
+    /* The handle holds one stream (slots and producer state) and one area window */
+    if (spi_bus_manager_pending(mgr, handle->stream_dev_id, EPD3IN7_DRIVER_TAG_UPLOAD) != 0u ||
+        (!full && spi_bus_manager_pending(mgr, handle->bus_dev_id, EPD3IN7_DRIVER_TAG_WINDOW) != 0u))
+        return EPD3IN7_DRIVER_ERR_BUSY;
+
+    /* Producer state is in place before the first band can raise a half-transfer */
+    handle->stream_fill = fill;
+    handle->stream_user = user;
+    handle->stream_bands = bands;
+    handle->stream_band_size = band_size;
+    handle->stream_band_rows = band_rows;
+    handle->stream_band_count = (uint16_t)((area->h + band_rows - 1u) / band_rows);
+    handle->stream_halves = 0;
+    handle->stream_area = *area;
+
+    epd_stream_fill(handle, 0);
+    if (handle->stream_band_count > 1u)
+        epd_stream_fill(handle, 1);
+
+    if (full)
+    {
+        st = epd_submit_program(handle, mgr, epd3in7_driver_prog_frame_setup,
+                                SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_frame_setup), false,
+                                EPD3IN7_DRIVER_TAG_UPLOAD);
     }
-
-    /* WRITE_RAM + frame data */
+    else
     {
-        spi_bus_transaction tr_cmd = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_write_ram);
-        if (spi_bus_manager_submit(mgr, &tr_cmd) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+        epd_build_area_program(handle, area);
+        st = epd_submit_program(handle, mgr, handle->area_prog, EPD3IN7_DRIVER_AREA_PROGRAM_LEN, false,
+                                EPD3IN7_DRIVER_TAG_WINDOW);
+    }
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
 
-        const uint16_t image_counter = (uint16_t)(EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8); // 16800
-        spi_bus_transaction tr_data = epd_tx_data(handle, cs, dc, image, image_counter);
+    /* One item per band on the stream profile; the controller keeps writing RAM across them */
+    for (uint16_t b = 0; b < handle->stream_band_count; ++b)
+    {
+        const uint16_t first = (uint16_t)(b * band_rows);
+        const uint16_t left = (uint16_t)(area->h - first);
+        const uint16_t rows = left < band_rows ? left : band_rows;
+        spi_bus_transaction tr_data = epd_tx_data(handle, bands + (size_t)(b & 1u) * band_size, rows * row_bytes);
+        tr_data.dev = handle->stream_dev_id;
+        tr_data.user = handle;
         if (spi_bus_manager_submit(mgr, &tr_data) != SPI_BUS_MANAGER_OK)
             return EPD3IN7_DRIVER_SPI_BUS_ERR;
     }
 
-    /* Load LUT for the selected mode. */
     {
         epd3in7_driver_lut_type lut_type = epd3in7_driver_mode_to_lut(mode, true);
-        epd3in7_driver_status s = epd3in7_enqueue_lut(handle, mgr, cs, dc, lut_type);
+        epd3in7_driver_status s = epd3in7_enqueue_lut(handle, mgr, lut_type);
         if (s != EPD3IN7_DRIVER_OK)
             return s;
     }
 
-    /* Display update sequence */
+    return epd_submit_program(handle, mgr, epd3in7_driver_prog_update,
+                              SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_update), true,
+                              EPD3IN7_DRIVER_TAG_REFRESH);
+}
+
+void epd3in7_driver_i2_to_planes(const uint8_t *image, uint8_t *plane_ram, uint8_t *plane_ram2, uint32_t image_bytes)
+{
+    for (uint32_t i = 0; i + 4u <= image_bytes; i += 4u)
     {
-        spi_bus_transaction tr = epd_tx_cmd_wait(handle, cs, dc, &epd3in7_driver_dma_display_update);
-        if (spi_bus_manager_submit(mgr, &tr) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+        const uint32_t w = epd3in7_driver_i2_load(image + i);
+        const uint16_t lo = epd3in7_driver_i2_plane_bits(w);
+        const uint16_t hi = epd3in7_driver_i2_plane_bits(w >> 1);
+        const uint32_t o = i / 2u;
+
+        plane_ram[o] = (uint8_t)(lo >> 8);
+        plane_ram[o + 1u] = (uint8_t)lo;
+        plane_ram2[o] = (uint8_t)(hi >> 8);
+        plane_ram2[o + 1u] = (uint8_t)hi;
     }
+}
 
-    return EPD3IN7_DRIVER_OK;
+epd3in7_driver_status epd3in7_driver_display_4_gray_dma(epd3in7_driver_handle *handle,
+                                                        spi_bus_manager *mgr,
+                                                        const uint8_t *plane_ram,
+                                                        const uint8_t *plane_ram2)
+{
+    if (!handle || !mgr || !plane_ram || !plane_ram2)
+        return EPD3IN7_DRIVER_ERR_PARAM;
+
+    epd3in7_driver_status st = epd_bus_device(handle, mgr);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    /* Sequence shared with the blocking epd3in7_driver_display_4_gray() */
+    const uint16_t plane_bytes = (uint16_t)(EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8); // 16800
+
+    st = epd_submit_program(handle, mgr, epd3in7_driver_prog_frame_setup_4_gray,
+                            SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_frame_setup_4_gray), false,
+                            EPD3IN7_DRIVER_TAG_UPLOAD);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    spi_bus_transaction tr_ram = epd_tx_data(handle, plane_ram, plane_bytes);
+    if (spi_bus_manager_submit(mgr, &tr_ram) != SPI_BUS_MANAGER_OK)
+        return EPD3IN7_DRIVER_SPI_BUS_ERR;
+
+    st = epd_submit_program(handle, mgr, epd3in7_driver_prog_ram2_setup,
+                            SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_ram2_setup), false,
+                            EPD3IN7_DRIVER_TAG_UPLOAD);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    spi_bus_transaction tr_ram2 = epd_tx_data(handle, plane_ram2, plane_bytes);
+    if (spi_bus_manager_submit(mgr, &tr_ram2) != SPI_BUS_MANAGER_OK)
+        return EPD3IN7_DRIVER_SPI_BUS_ERR;
+
+    st = epd3in7_enqueue_lut(handle, mgr, EPD3IN7_DRIVER_LUT_4_GRAY_GC);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
+
+    return epd_submit_program(handle, mgr, epd3in7_driver_prog_update_4_gray,
+                              SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_update_4_gray), true,
+                              EPD3IN7_DRIVER_TAG_REFRESH);
 }
 
 epd3in7_driver_status epd3in7_driver_sleep_dma(epd3in7_driver_handle *handle,
@@ -1096,46 +1368,49 @@ epd3in7_driver_status epd3in7_driver_sleep_dma(epd3in7_driver_handle *handle,
     if (!handle || !mgr)
         return EPD3IN7_DRIVER_ERR_PARAM;
 
-    spi_bus_gpio cs = {handle->pins.cs_port, handle->pins.cs_pin, true};
-    spi_bus_gpio dc = {handle->pins.dc_port, handle->pins.dc_pin, false};
+    epd3in7_driver_status st = epd_bus_device(handle, mgr);
+    if (st != EPD3IN7_DRIVER_OK)
+        return st;
 
     if (mode == EPD3IN7_DRIVER_SLEEP_DEEP)
     {
-        uint8_t val = 0x03;
-        spi_bus_transaction tr = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_sleep_deep);
-        if (spi_bus_manager_submit(mgr, &tr) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
-
-        spi_bus_transaction tr2 = epd_tx_payload(handle, cs, dc, &val, 1);
-        if (spi_bus_manager_submit(mgr, &tr2) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
-        return EPD3IN7_DRIVER_OK;
+        return epd_submit_program(handle, mgr, epd3in7_driver_prog_sleep_deep,
+                                  SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_sleep_deep), false,
+                                  EPD3IN7_DRIVER_TAG_SLEEP);
     }
-    else
-    {
-        /* Normal sleep sequence mirrors blocking version: SLEEP(0xF7) -> POWEROFF -> SLEEP2(0xA5) */
-        uint8_t v_f7 = 0xF7;
-        spi_bus_transaction tr = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_sleep);
-        if (spi_bus_manager_submit(mgr, &tr) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
 
-        spi_bus_transaction tr2 = epd_tx_payload(handle, cs, dc, &v_f7, 1);
-        if (spi_bus_manager_submit(mgr, &tr2) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    /* Normal sleep: SLEEP(0xF7) -> POWEROFF -> SLEEP2(0xA5) */
+    return epd_submit_program(handle, mgr, epd3in7_driver_prog_sleep,
+                              SPI_BUS_PROGRAM_LEN(epd3in7_driver_prog_sleep), false,
+                              EPD3IN7_DRIVER_TAG_SLEEP);
+}
 
-        spi_bus_transaction tr3 = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_power_off);
-        if (spi_bus_manager_submit(mgr, &tr3) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+epd3in7_driver_status epd3in7_driver_cancel_frame_dma(epd3in7_driver_handle *handle,
+                                                      spi_bus_manager *mgr,
+                                                      bool *dropped)
+{
+    if (!handle || !mgr)
+        return EPD3IN7_DRIVER_ERR_PARAM;
 
-        uint8_t v_a5 = 0xA5;
-        spi_bus_transaction tr4 = epd_tx_cmd(handle, cs, dc, &epd3in7_driver_dma_sleep2);
-        if (spi_bus_manager_submit(mgr, &tr4) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    if (dropped)
+        *dropped = false;
+    if (!handle->bus_dev_has_value)
+        return EPD3IN7_DRIVER_OK;
 
-        spi_bus_transaction tr5 = epd_tx_payload(handle, cs, dc, &v_a5, 1);
-        if (spi_bus_manager_submit(mgr, &tr5) != SPI_BUS_MANAGER_OK)
-            return EPD3IN7_DRIVER_SPI_BUS_ERR;
+    /* Refresh first: once it is gone, an upload finishing meanwhile has nothing left to trigger */
+    uint16_t refresh = spi_bus_manager_cancel(mgr, handle->bus_dev_id, EPD3IN7_DRIVER_TAG_REFRESH, false);
+    (void)spi_bus_manager_cancel(mgr, handle->bus_dev_id, EPD3IN7_DRIVER_TAG_SLEEP, false);
+    (void)spi_bus_manager_cancel(mgr, handle->bus_dev_id, EPD3IN7_DRIVER_TAG_WINDOW, true);
+    (void)spi_bus_manager_cancel(mgr, handle->bus_dev_id, EPD3IN7_DRIVER_TAG_UPLOAD, true);
+    if (handle->stream_dev_has_value)
+        (void)spi_bus_manager_cancel(mgr, handle->stream_dev_id, EPD3IN7_DRIVER_TAG_UPLOAD, true);
 
-        return EPD3IN7_DRIVER_OK;
+    if (refresh != 0u)
+    {
+        /* A dropped LUT write leaves the controller with the previous one */
+        handle->last_lut_has_value = false;
+        if (dropped)
+            *dropped = true;
     }
+    return EPD3IN7_DRIVER_OK;
 }
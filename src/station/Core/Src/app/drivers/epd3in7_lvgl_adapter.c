@@ -17,67 +17,473 @@ static inline void epd3in7_lvgl_adapter_i1_set_bit_msb_first(uint8_t *row, int x
         row[x >> 3] &= (uint8_t)~mask;
 }
 
+/* ---- 8x8 bit-block rotation ---- */
+
+/**
+ * @brief Transpose an 8x8 bit block held as two 32-bit words (rows 0-3 and 4-7, row 0 in the top
+ *        byte, MSB = column 0): out row i = in column i, MSB = row 0 (Hacker's Delight transpose8).
+ */
+static inline void epd3in7_lvgl_adapter_transpose8(uint32_t *hi, uint32_t *lo)
+{
+    uint32_t x = *hi, y = *lo, t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AAu;
+    x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AAu;
+    y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCCu;
+    x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCCu;
+    y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0u) | ((y >> 4) & 0x0F0F0F0Fu);
+    y = ((x << 4) & 0xF0F0F0F0u) | (y & 0x0F0F0F0Fu);
+
+    *hi = t;
+    *lo = y;
+}
+
+/* Mirror the bits of a byte (MSB <-> LSB) */
+static inline uint8_t epd3in7_lvgl_adapter_reverse8(uint8_t b)
+{
+    b = (uint8_t)((b & 0xF0u) >> 4 | (b & 0x0Fu) << 4);
+    b = (uint8_t)((b & 0xCCu) >> 2 | (b & 0x33u) << 2);
+    b = (uint8_t)((b & 0xAAu) >> 1 | (b & 0x55u) << 1);
+    return b;
+}
+
+/**
+ * @brief Rotate an I1 bitmap whose sides are multiples of 8, one 8x8 tile at a time: 8 source bytes
+ *        in, 8 destination bytes out, every destination byte written once (no clear, no per-pixel
+ *        branches). Writes destination rows [row0, row0 + rows) to @p dst (row0 and rows multiples
+ *        of 8). Same mapping as epd3in7_lvgl_adapter_rotate_i1_bitwise().
+ */
+static void epd3in7_lvgl_adapter_rotate_i1_blocks(const uint8_t *src, uint8_t *dst,
+                                                  int32_t src_w, int32_t src_h,
+                                                  int32_t src_stride, int32_t dst_stride,
+                                                  lv_display_rotation_t rotation,
+                                                  int32_t row0, int32_t rows)
+{
+    const int32_t bw = src_w / 8;
+    const int32_t bh = src_h / 8;
+
+    if (rotation == LV_DISPLAY_ROTATION_180)
+    {
+        /* Row h-1-y, byte order and bit order mirrored */
+        for (int32_t r = 0; r < rows; ++r)
+        {
+            const uint8_t *s = src + (size_t)(src_h - 1 - row0 - r) * src_stride;
+            uint8_t *d = dst + (size_t)r * dst_stride + (bw - 1);
+            for (int32_t bx = 0; bx < bw; ++bx)
+                *d-- = epd3in7_lvgl_adapter_reverse8(s[bx]);
+        }
+        return;
+    }
+
+    /* Source tile columns feeding the requested destination rows (yd = x for 90, w-1-x for 270) */
+    const int32_t bx0 = (rotation == LV_DISPLAY_ROTATION_90) ? row0 / 8 : (src_w - row0 - rows) / 8;
+    const int32_t bx1 = bx0 + rows / 8;
+
+    for (int32_t by = 0; by < bh; ++by)
+    {
+        const uint8_t *s = src + (size_t)by * 8u * src_stride + bx0;
+        for (int32_t bx = bx0; bx < bx1; ++bx, ++s)
+        {
+            uint32_t hi, lo;
+            if (rotation == LV_DISPLAY_ROTATION_90)
+            {
+                /* xd = h-1-y: rows enter bottom-up so the lowest source row becomes the MSB */
+                hi = (uint32_t)s[7 * src_stride] << 24 | (uint32_t)s[6 * src_stride] << 16 |
+                     (uint32_t)s[5 * src_stride] << 8 | s[4 * src_stride];
+                lo = (uint32_t)s[3 * src_stride] << 24 | (uint32_t)s[2 * src_stride] << 16 |
+                     (uint32_t)s[1 * src_stride] << 8 | s[0];
+            }
+            else
+            {
+                hi = (uint32_t)s[0] << 24 | (uint32_t)s[1 * src_stride] << 16 |
+                     (uint32_t)s[2 * src_stride] << 8 | s[3 * src_stride];
+                lo = (uint32_t)s[4 * src_stride] << 24 | (uint32_t)s[5 * src_stride] << 16 |
+                     (uint32_t)s[6 * src_stride] << 8 | s[7 * src_stride];
+            }
+            epd3in7_lvgl_adapter_transpose8(&hi, &lo);
+
+            /* Output row i is source column 8*bx+i */
+            uint8_t *d;
+            int32_t step;
+            if (rotation == LV_DISPLAY_ROTATION_90)
+            {
+                /* yd = x, xd byte = (h-8-8*by)/8 */
+                d = dst + (size_t)(bx * 8 - row0) * dst_stride + (bh - 1 - by);
+                step = dst_stride;
+            }
+            else
+            {
+                /* 270: yd = w-1-x, xd byte = by */
+                d = dst + (size_t)(src_w - 1 - bx * 8 - row0) * dst_stride + by;
+                step = -dst_stride;
+            }
+            d[0] = (uint8_t)(hi >> 24);
+            d[step] = (uint8_t)(hi >> 16);
+            d[2 * step] = (uint8_t)(hi >> 8);
+            d[3 * step] = (uint8_t)hi;
+            d[4 * step] = (uint8_t)(lo >> 24);
+            d[5 * step] = (uint8_t)(lo >> 16);
+            d[6 * step] = (uint8_t)(lo >> 8);
+            d[7 * step] = (uint8_t)lo;
+        }
+    }
+}
+
+/**
+ * @brief Rotate a 1bpp (I1) bitmap pixel by pixel (fallback for sides that are not multiples of 8).
+ *        Walks destination rows [row0, row0 + rows) and fetches each pixel from the source.
+ */
+static void epd3in7_lvgl_adapter_rotate_i1_bitwise(const uint8_t *src, uint8_t *dst,
+                                                   int32_t src_w, int32_t src_h,
+                                                   int32_t src_stride, int32_t dst_stride,
+                                                   lv_display_rotation_t rotation,
+                                                   int32_t row0, int32_t rows)
+{
+    if (rotation == LV_DISPLAY_ROTATION_0)
+    {
+        /* Fast path: copy rows as-is. */
+        for (int r = 0; r < rows; ++r)
+        {
+            memcpy(dst + (size_t)r * dst_stride, src + (size_t)(row0 + r) * src_stride, (size_t)src_stride);
+        }
+        return;
+    }
+
+    /* Clear destination — we only set bits. */
+    memset(dst, 0x00, (size_t)dst_stride * (size_t)rows);
+
+    const int dst_w = (rotation == LV_DISPLAY_ROTATION_180) ? src_w : src_h;
+    for (int r = 0; r < rows; ++r)
+    {
+        const int yd = row0 + r;
+        uint8_t *dst_row = dst + (size_t)r * dst_stride;
+        for (int xd = 0; xd < dst_w; ++xd)
+        {
+            int x, y;
+            switch (rotation)
+            {
+            case LV_DISPLAY_ROTATION_90:
+                x = yd;
+                y = src_h - 1 - xd;
+                break;
+            case LV_DISPLAY_ROTATION_180:
+                x = src_w - 1 - xd;
+                y = src_h - 1 - yd;
+                break;
+            default: /* LV_DISPLAY_ROTATION_270 */
+                x = src_w - 1 - yd;
+                y = xd;
+                break;
+            }
+            const uint8_t bit = epd3in7_lvgl_adapter_i1_get_bit_msb_first(src + (size_t)y * src_stride, x);
+            epd3in7_lvgl_adapter_i1_set_bit_msb_first(dst_row, xd, bit);
+        }
+    }
+}
+
 /**
  * @brief Rotate a 1bpp (I1) bitmap. Operates only on pixels.
  * src_w/src_h – source size in pixels.
  * src_stride  – bytes per source row ((src_w+7)/8).
  * dst_stride  – bytes per destination row.
  * rotation    – LV_DISPLAY_ROTATION_0/90/180/270.
+ * row0/rows   – destination rows to produce; @p dst receives row row0 first (a band of the output).
  * Bit order   – MSB-first.
  */
 static void epd3in7_lvgl_adapter_rotate_i1(const uint8_t *src, uint8_t *dst,
                                            int32_t src_w, int32_t src_h,
                                            int32_t src_stride, int32_t dst_stride,
-                                           lv_display_rotation_t rotation)
+                                           lv_display_rotation_t rotation,
+                                           int32_t row0, int32_t rows)
 {
-    /* Clear destination — we only set bits. */
-    const int dst_h = (rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270) ? src_w : src_h;
-    memset(dst, 0x00, (size_t)dst_stride * (size_t)dst_h);
-
-    if (rotation == LV_DISPLAY_ROTATION_0)
-    {
-        /* Fast path: copy rows as-is. */
-        for (int y = 0; y < src_h; ++y)
-        {
-            memcpy(dst + (size_t)y * dst_stride, src + (size_t)y * src_stride, (size_t)src_stride);
-        }
-        return;
-    }
+    if (rotation != LV_DISPLAY_ROTATION_0 && ((src_w | src_h | row0 | rows) & 7) == 0)
+        epd3in7_lvgl_adapter_rotate_i1_blocks(src, dst, src_w, src_h, src_stride, dst_stride, rotation, row0, rows);
+    else
+        epd3in7_lvgl_adapter_rotate_i1_bitwise(src, dst, src_w, src_h, src_stride, dst_stride, rotation, row0, rows);
+}
 
-    for (int y = 0; y < src_h; ++y)
+/**
+ * @brief Quantize an L8 band to 2 bits per pixel (L >> 6: 3 = white ... 0 = black) and write it
+ *        rotated into an I2 frame in panel orientation. Same mapping as rotate_i1; area is in
+ *        logical coordinates of a log_w x log_h screen.
+ */
+static void epd3in7_lvgl_adapter_l8_to_i2(const uint8_t *src, uint32_t src_stride, const lv_area_t *area,
+                                          int32_t log_w, int32_t log_h,
+                                          uint8_t *i2, uint32_t i2_stride,
+                                          lv_display_rotation_t rotation)
+{
+    for (int32_t y = area->y1; y <= area->y2; ++y)
     {
-        const uint8_t *src_row = src + (size_t)y * src_stride;
-        for (int x = 0; x < src_w; ++x)
+        const uint8_t *src_row = src + (size_t)(y - area->y1) * src_stride;
+        for (int32_t x = area->x1; x <= area->x2; ++x)
         {
-            const uint8_t bit = epd3in7_lvgl_adapter_i1_get_bit_msb_first(src_row, x);
-            int xd, yd;
+            const uint8_t v = src_row[x - area->x1] >> 6;
+            int32_t xd, yd;
             switch (rotation)
             {
             case LV_DISPLAY_ROTATION_90:
-                xd = src_h - 1 - y;
+                xd = log_h - 1 - y;
                 yd = x;
                 break;
             case LV_DISPLAY_ROTATION_180:
-                xd = src_w - 1 - x;
-                yd = src_h - 1 - y;
+                xd = log_w - 1 - x;
+                yd = log_h - 1 - y;
                 break;
             case LV_DISPLAY_ROTATION_270:
                 xd = y;
-                yd = src_w - 1 - x;
+                yd = log_w - 1 - x;
                 break;
             default:
                 xd = x;
                 yd = y;
                 break;
             }
-            uint8_t *dst_row = dst + (size_t)yd * dst_stride;
-            epd3in7_lvgl_adapter_i1_set_bit_msb_first(dst_row, xd, bit);
+            uint8_t *b = i2 + (size_t)yd * i2_stride + (xd >> 2);
+            const uint8_t shift = (uint8_t)(6 - 2 * (xd & 3));
+            *b = (uint8_t)((*b & ~(0x03u << shift)) | (v << shift));
+        }
+    }
+}
+
+/* ---- Dirty rectangle helpers ---- */
+
+/**
+ * @brief Map a logical area of a src_w x src_h frame to panel RAM coordinates (same mapping
+ *        as rotate_i1) and widen it to whole bytes, rows to groups of 8 (bands rotate 8x8 tiles).
+ */
+static epd3in7_driver_area epd3in7_lvgl_adapter_panel_area(const lv_area_t *a,
+                                                           int32_t src_w, int32_t src_h,
+                                                           lv_display_rotation_t rotation)
+{
+    int32_t x1, y1, x2, y2;
+    switch (rotation)
+    {
+    case LV_DISPLAY_ROTATION_90:
+        x1 = src_h - 1 - a->y2;
+        x2 = src_h - 1 - a->y1;
+        y1 = a->x1;
+        y2 = a->x2;
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        x1 = src_w - 1 - a->x2;
+        x2 = src_w - 1 - a->x1;
+        y1 = src_h - 1 - a->y2;
+        y2 = src_h - 1 - a->y1;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        x1 = a->y1;
+        x2 = a->y2;
+        y1 = src_w - 1 - a->x2;
+        y2 = src_w - 1 - a->x1;
+        break;
+    default:
+        x1 = a->x1;
+        x2 = a->x2;
+        y1 = a->y1;
+        y2 = a->y2;
+        break;
+    }
+
+    x1 &= ~7;
+    x2 |= 7;
+    y1 &= ~7;
+    y2 = LV_MIN(y2 | 7, ((rotation == LV_DISPLAY_ROTATION_90 || rotation == LV_DISPLAY_ROTATION_270) ? src_w : src_h) - 1);
+    return (epd3in7_driver_area){(uint16_t)x1, (uint16_t)y1, (uint16_t)(x2 - x1 + 1), (uint16_t)(y2 - y1 + 1)};
+}
+
+static void epd3in7_lvgl_adapter_area_join(epd3in7_driver_area *acc, const epd3in7_driver_area *b)
+{
+    const uint16_t x2 = LV_MAX(acc->x + acc->w, b->x + b->w);
+    const uint16_t y2 = LV_MAX(acc->y + acc->h, b->y + b->h);
+    acc->x = LV_MIN(acc->x, b->x);
+    acc->y = LV_MIN(acc->y, b->y);
+    acc->w = (uint16_t)(x2 - acc->x);
+    acc->h = (uint16_t)(y2 - acc->y);
+}
+
+/**
+ * @brief Move the rows of rectangle @p a to the start of @p buf, packed (w/8 bytes per row).
+ *        In place: a packed row never lands past the start of a source row still to be read.
+ */
+static void epd3in7_lvgl_adapter_pack_area(uint8_t *buf, uint32_t stride, const epd3in7_driver_area *a)
+{
+    const size_t row_bytes = a->w / 8u;
+    const uint8_t *src = buf + (size_t)a->y * stride + a->x / 8u;
+    for (uint16_t r = 0; r < a->h; ++r, src += stride)
+    {
+        memmove(buf + (size_t)r * row_bytes, src, row_bytes);
+    }
+}
+
+/* XOR of word @p i of two I1 rows. The last word is read byte-wise (@p last_bytes, rows need not
+   be a multiple of 4 bytes) and masked (@p last_mask, in memory order: the leftmost pixel is the
+   MSB of byte 0). */
+static inline uint32_t epd3in7_lvgl_adapter_xor_word(const uint8_t *c, const uint8_t *p, int32_t i, int32_t last,
+                                                     uint32_t last_bytes, uint32_t last_mask)
+{
+    uint32_t a = 0, b = 0;
+    if (i != last)
+    {
+        memcpy(&a, c + 4 * i, 4);
+        memcpy(&b, p + 4 * i, 4);
+        return a ^ b;
+    }
+    memcpy(&a, c + 4 * i, last_bytes);
+    memcpy(&b, p + 4 * i, last_bytes);
+    return (a ^ b) & last_mask;
+}
+
+/* Memory-order mask of the first @p bits pixels of a word */
+static inline uint32_t epd3in7_lvgl_adapter_word_mask(int32_t bits)
+{
+    return __builtin_bswap32((bits >= 32) ? 0xFFFFFFFFu : ~(0xFFFFFFFFu >> bits));
+}
+
+/**
+ * @brief Compare two I1 frames 32 bits at a time and return the bounding box of differing pixels.
+ *        Rows are scanned from both ends, so an unchanged row costs one pass and a changed one
+ *        stops at its first and last differing word. Pixel-exact (MSB-first: byte-swapped, the
+ *        leftmost pixel of a word is bit 31); any stride, the last word of a row is read byte-wise.
+ *
+ * @return false if the frames are identical; true with @p box set otherwise.
+ */
+static bool epd3in7_lvgl_adapter_diff_i1(const uint8_t *cur, const uint8_t *prev,
+                                         int32_t w, int32_t h, uint32_t stride, lv_area_t *box)
+{
+    /* Padding bits past the frame width are not pixels: bytes past it are not read and the last
+       word is masked */
+    const int32_t words = (w + 31) / 32;
+    const int32_t last = words - 1;
+    const int32_t tail_bits = w - last * 32;
+    const uint32_t tail_bytes = (uint32_t)(tail_bits + 7) / 8u;
+    const uint32_t tail_mask = epd3in7_lvgl_adapter_word_mask(tail_bits);
+    int32_t x1 = w, x2 = -1, y1 = -1, y2 = -1;
+
+    for (int32_t y = 0; y < h; ++y)
+    {
+        const uint8_t *c = cur + (size_t)y * stride;
+        const uint8_t *p = prev + (size_t)y * stride;
+        uint32_t d = 0;
+        int32_t i = 0;
+
+        for (; i < words; ++i)
+        {
+            d = epd3in7_lvgl_adapter_xor_word(c, p, i, last, tail_bytes, tail_mask);
+            if (d)
+                break;
+        }
+        if (i == words)
+            continue;
+
+        d = __builtin_bswap32(d);
+        x1 = LV_MIN(x1, i * 32 + (int32_t)__builtin_clz(d));
+
+        int32_t j = last;
+        for (; j > i; --j)
+        {
+            const uint32_t dj = epd3in7_lvgl_adapter_xor_word(c, p, j, last, tail_bytes, tail_mask);
+            if (dj)
+            {
+                d = __builtin_bswap32(dj);
+                break;
+            }
+        }
+        x2 = LV_MAX(x2, j * 32 + 31 - (int32_t)__builtin_ctz(d));
+
+        if (y1 < 0)
+            y1 = y;
+        y2 = y;
+    }
+
+    if (y1 < 0)
+        return false;
+
+    lv_area_set(box, x1, y1, x2, y2);
+    return true;
+}
+
+/**
+ * @brief Count the pixels that differ inside @p box and add them to the region they fall in
+ *        (regions split the frame into REGION_COLS word columns x REGION_ROWS rows). Any stride:
+ *        the last word of the box is read up to its last byte only.
+ * @return Total number of flipped pixels.
+ */
+static uint32_t epd3in7_lvgl_adapter_count_flips(const uint8_t *cur, const uint8_t *prev,
+                                                 int32_t h, uint32_t stride, const lv_area_t *box,
+                                                 uint32_t *region_flips)
+{
+    const int32_t words = (int32_t)((stride + 3u) / 4u);
+    const int32_t last = box->x2 / 32;
+    const int32_t last_bits = (box->x2 & 31) + 1;
+    const uint32_t last_bytes = (uint32_t)(last_bits + 7) / 8u;
+    /* Bits right of the box in its last word can only be row padding */
+    const uint32_t last_mask = epd3in7_lvgl_adapter_word_mask(last_bits);
+    uint32_t total = 0;
+
+    for (int32_t y = box->y1; y <= box->y2; ++y)
+    {
+        const uint8_t *c = cur + (size_t)y * stride;
+        const uint8_t *p = prev + (size_t)y * stride;
+        uint32_t *row_regions = region_flips + (y * EPD3IN7_LVGL_ADAPTER_REGION_ROWS / h) * EPD3IN7_LVGL_ADAPTER_REGION_COLS;
+
+        for (int32_t i = box->x1 / 32; i <= last; ++i)
+        {
+            const uint32_t n = (uint32_t)__builtin_popcount(epd3in7_lvgl_adapter_xor_word(c, p, i, last, last_bytes, last_mask));
+            row_regions[i * EPD3IN7_LVGL_ADAPTER_REGION_COLS / words] += n;
+            total += n;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Adaptive mode choice from the flips of this frame (see EPD3IN7_LVGL_ADAPTER_GC_PERCENT).
+ *        Updates the region wear and the refresh counter.
+ */
+static epd3in7_driver_mode epd3in7_lvgl_adapter_pick_mode(epd3in7_lvgl_adapter_handle *h,
+                                                          const uint32_t *region_flips,
+                                                          uint32_t total, uint32_t frame_px)
+{
+    const uint32_t region_px = frame_px / EPD3IN7_LVGL_ADAPTER_REGIONS;
+    epd3in7_driver_mode mode = h->default_mode;
+    bool gc = h->refresh_counter >= (uint8_t)(h->refresh_cycles_before_gc - 1) ||
+              total * 100u >= frame_px * EPD3IN7_LVGL_ADAPTER_GC_PERCENT;
+
+    if (!gc)
+    {
+        if (total * 100u >= frame_px * EPD3IN7_LVGL_ADAPTER_DU_PERCENT)
+            mode = EPD3IN7_DRIVER_MODE_DU;
+
+        /* A2 drives pixels harder and leaves more ghosting than DU */
+        const uint32_t weight = (mode == EPD3IN7_DRIVER_MODE_A2) ? 2u : 1u;
+        for (uint32_t r = 0; r < EPD3IN7_LVGL_ADAPTER_REGIONS && !gc; ++r)
+            gc = h->region_wear[r] + weight * region_flips[r] >= region_px;
+
+        if (!gc)
+        {
+            for (uint32_t r = 0; r < EPD3IN7_LVGL_ADAPTER_REGIONS; ++r)
+                h->region_wear[r] += weight * region_flips[r];
+            h->refresh_counter++;
+            return mode;
         }
     }
+
+    memset(h->region_wear, 0, sizeof(h->region_wear));
+    h->refresh_counter = 0;
+    return EPD3IN7_DRIVER_MODE_GC;
 }
 
 /* ---- Public API ---- */
 
+/* Band slots of adapters created without a band buffer (one panel per build) */
+static uint8_t epd3in7_lvgl_adapter_default_bands[EPD3IN7_LVGL_ADAPTER_BAND_BUFFER_SIZE];
+
 epd3in7_lvgl_adapter_handle epd3in7_lvgl_adapter_create(epd3in7_driver_handle *driver,
                                                         uint8_t *work_buffer,
                                                         int8_t refresh_cycles_before_gc,
@@ -100,12 +506,12 @@ epd3in7_lvgl_adapter_handle epd3in7_lvgl_adapter_create(epd3in7_driver_handle *d
 }
 
 epd3in7_lvgl_adapter_handle epd3in7_lvgl_adapter_create_with_bus_manager(epd3in7_driver_handle *driver,
-                                                                         uint8_t *work_buffer,
+                                                                         uint8_t *band_buffer,
                                                                          int8_t refresh_cycles_before_gc,
                                                                          epd3in7_driver_mode default_mode,
                                                                          spi_bus_manager *spi_mgr)
 {
-    epd3in7_lvgl_adapter_handle h = epd3in7_lvgl_adapter_create(driver, work_buffer,
+    epd3in7_lvgl_adapter_handle h = epd3in7_lvgl_adapter_create(driver, NULL,
                                                                 refresh_cycles_before_gc, default_mode);
     h.spi_mgr = spi_mgr;
 
@@ -118,12 +524,53 @@ epd3in7_lvgl_adapter_handle epd3in7_lvgl_adapter_create_with_bus_manager(epd3in7
     h.dc_gpio.pin = driver->pins.dc_pin;
     h.dc_gpio.active_low = false; /* DC=0 -> command, DC=1 -> data */
 
-    h.dma_in_progress = false;
-    h.pending_disp = NULL;
+    h.frames_queued = 0;
+    h.frames_done = 0;
+    h.queued_mode = default_mode;
+    h.queued_area = (epd3in7_driver_area){0, 0, EPD3IN7_WIDTH, EPD3IN7_HEIGHT};
+    h.panel_synced = false;
+    h.dirty_has_value = false;
+    h.shadow_buffer = NULL;
+    h.shadow_valid = false;
+    h.frames_skipped = 0;
+    memset(h.region_wear, 0, sizeof(h.region_wear));
+    h.i2_frame = NULL;
+    h.planes = NULL;
+    h.band_buffer = band_buffer ? band_buffer : epd3in7_lvgl_adapter_default_bands;
+    h.stream_src = NULL;
+    h.stream_src_w = 0;
+    h.stream_src_h = 0;
+    h.stream_src_stride = 0;
+    h.stream_dst_stride = 0;
+    h.stream_rotation = LV_DISPLAY_ROTATION_0;
+    h.stream_area = h.queued_area;
+    h.stream_disp = NULL;
 
     return h;
 }
 
+epd3in7_lvgl_adapter_handle epd3in7_lvgl_adapter_create_4_gray_with_bus_manager(epd3in7_driver_handle *driver,
+                                                                                uint8_t *i2_frame,
+                                                                                uint8_t *planes,
+                                                                                spi_bus_manager *spi_mgr)
+{
+    /* 4-gray refreshes are always GC */
+    epd3in7_lvgl_adapter_handle h = epd3in7_lvgl_adapter_create_with_bus_manager(driver, NULL, 1,
+                                                                                 EPD3IN7_DRIVER_MODE_GC, spi_mgr);
+    h.i2_frame = i2_frame;
+    h.planes = planes;
+    return h;
+}
+
+void epd3in7_lvgl_adapter_set_shadow_buffer(epd3in7_lvgl_adapter_handle *handle, uint8_t *shadow_buffer)
+{
+    if (!handle)
+        return;
+
+    handle->shadow_buffer = shadow_buffer;
+    handle->shadow_valid = false;
+}
+
 void epd3in7_lvgl_adapter_free(epd3in7_lvgl_adapter_handle *handle)
 {
     if (!handle)
@@ -236,7 +683,8 @@ void epd3in7_lvgl_adapter_flush(lv_display_t *disp, const lv_area_t *area, uint8
             return;
         }
 
-        epd3in7_lvgl_adapter_rotate_i1(src, h->work_buffer, src_w, src_h, (int32_t)src_stride, (int32_t)dst_stride, rotation);
+        epd3in7_lvgl_adapter_rotate_i1(src, h->work_buffer, src_w, src_h, (int32_t)src_stride, (int32_t)dst_stride, rotation,
+                                       0, lv_area_get_height(&rotated_area));
         src = h->work_buffer;
     }
 
@@ -257,24 +705,46 @@ void epd3in7_lvgl_adapter_flush(lv_display_t *disp, const lv_area_t *area, uint8
     lv_display_flush_ready(disp);
 }
 
-/* ---- Safe handoff to LVGL context ---- */
-static void epd3in7_lvgl_adapter_lvgl_flush_ready_async(void *p)
+/* Hand the LVGL buffer back if the stream still holds it (ISR-safe) */
+static void epd3in7_lvgl_adapter_release_buffer(epd3in7_lvgl_adapter_handle *h)
 {
-    lv_display_t *disp = (lv_display_t *)p;
+    lv_display_t *disp = h->stream_disp;
     if (disp)
+    {
+        h->stream_disp = NULL;
         lv_display_flush_ready(disp);
+    }
+}
+
+/* Stream band producer (driver half-transfer ISR): rotate panel rows [row, row + rows) and keep the
+   streamed columns. The last band releases the LVGL buffer. */
+static void epd3in7_lvgl_adapter_fill_band(void *user, uint16_t row, uint16_t rows, uint8_t *dst)
+{
+    epd3in7_lvgl_adapter_handle *h = (epd3in7_lvgl_adapter_handle *)user;
+
+    epd3in7_lvgl_adapter_rotate_i1(h->stream_src, dst, h->stream_src_w, h->stream_src_h,
+                                   (int32_t)h->stream_src_stride, (int32_t)h->stream_dst_stride,
+                                   h->stream_rotation, row, rows);
+    if (h->stream_area.w / 8u != h->stream_dst_stride)
+    {
+        const epd3in7_driver_area cols = {h->stream_area.x, 0, h->stream_area.w, rows};
+        epd3in7_lvgl_adapter_pack_area(dst, h->stream_dst_stride, &cols);
+    }
+
+    if ((uint32_t)row + rows == (uint32_t)h->stream_area.y + h->stream_area.h)
+        epd3in7_lvgl_adapter_release_buffer(h);
 }
 
-/* Adapter's internal completion (user-level) */
+/* Adapter's internal completion (user-level): one fence per enqueued frame, superseded ones included */
 static void epd3in7_lvgl_adapter_dma_done_cb(void *user)
 {
     epd3in7_lvgl_adapter_handle *h = (epd3in7_lvgl_adapter_handle *)user;
     if (!h)
         return;
-    h->dma_in_progress = false;
-
-    /* Hand-off to LVGL context (never call LVGL directly from ISR) */
-    lv_async_call(epd3in7_lvgl_adapter_lvgl_flush_ready_async, h->pending_disp);
+    /* Fence of the newest frame: a band lost to a bus error never produced the last one */
+    if ((uint8_t)(h->frames_done + 1u) == h->frames_queued)
+        epd3in7_lvgl_adapter_release_buffer(h);
+    h->frames_done++;
 }
 
 /* Wrapper to match spi_bus_done_cb signature (mgr, user) */
@@ -301,14 +771,11 @@ void epd3in7_lvgl_adapter_flush_dma(lv_display_t *disp, const lv_area_t *area, u
         return;
     }
 
-    /* Ensure panel is initialized once (blocking init on first use). */
+    /* Ensure panel is initialized once: the init program is queued ahead of the first frame
+       (reset pulse, delays and BUSY waits run from the manager, nothing blocks here). */
     if (!h->is_initialized)
     {
-        /* Wait for the SPI bus to become idle before a blocking init. */
-        while (!spi_bus_manager_is_idle(h->spi_mgr))
-        { /* busy wait */
-        }
-        if (epd3in7_driver_init_1_gray(h->driver) != EPD3IN7_DRIVER_OK)
+        if (epd3in7_driver_init_1_gray_dma(h->driver, h->spi_mgr) != EPD3IN7_DRIVER_OK)
         {
             lv_display_flush_ready(disp);
             return;
@@ -316,19 +783,8 @@ void epd3in7_lvgl_adapter_flush_dma(lv_display_t *disp, const lv_area_t *area, u
         h->refresh_counter = 99; /* Force GC on first transfer */
         h->is_initialized = true;
         h->is_sleeping = false;
-    }
-
-    /* Decide refresh mode (GC vs A2/DU) */
-    epd3in7_driver_mode mode;
-    if (h->refresh_counter >= (uint8_t)(h->refresh_cycles_before_gc - 1))
-    {
-        mode = EPD3IN7_DRIVER_MODE_GC;
-        h->refresh_counter = 0;
-    }
-    else
-    {
-        mode = h->default_mode;
-        h->refresh_counter++;
+        h->panel_synced = false;
+        h->shadow_valid = false;
     }
 
     lv_display_rotation_t rotation = lv_display_get_rotation(disp);
@@ -347,39 +803,243 @@ void epd3in7_lvgl_adapter_flush_dma(lv_display_t *disp, const lv_area_t *area, u
     // We need to skip it, because EPD3IN7 driver expects pure 1bpp data
     uint8_t *src = px_map + palette_bytes;
 
-    if (!h->work_buffer)
+    /* Frame diff against the last enqueued frame. Identical: nothing is sent and a frame still in
+       flight is left alone (it already carries this picture). Otherwise the box of changed pixels
+       replaces the invalidated areas. */
+    uint32_t region_flips[EPD3IN7_LVGL_ADAPTER_REGIONS] = {0};
+    uint32_t flips = 0;
+    bool have_flips = false;
+    if (h->shadow_buffer)
     {
-        /* No work buffer -> we cannot DMA safely (source may vanish). Fallback to blocking path. */
-        epd3in7_lvgl_adapter_flush(disp, area, px_map);
-        return;
+        if (h->shadow_valid)
+        {
+            lv_area_t changed;
+            if (!epd3in7_lvgl_adapter_diff_i1(src, h->shadow_buffer, src_w, src_h, src_stride, &changed))
+            {
+                h->frames_skipped++;
+                h->dirty_has_value = false;
+                lv_display_flush_ready(disp);
+                return;
+            }
+            flips = epd3in7_lvgl_adapter_count_flips(src, h->shadow_buffer, src_h, src_stride,
+                                                     &changed, region_flips);
+            have_flips = true;
+            lv_area_move(&changed, src_area->x1, src_area->y1);
+            h->dirty = changed;
+            h->dirty_has_value = true;
+        }
     }
 
-    if (rotation != LV_DISPLAY_ROTATION_0)
+    /* Decide refresh mode (GC vs A2/DU); skipped frames do not count */
+    epd3in7_driver_mode mode;
+    if (have_flips)
     {
-        rotated_area = *src_area;
-        lv_display_rotate_area(disp, &rotated_area);
-        const int32_t dst_w = lv_area_get_width(&rotated_area);
-        const uint32_t dst_stride = lv_draw_buf_width_to_stride(dst_w, cf);
+        mode = epd3in7_lvgl_adapter_pick_mode(h, region_flips, flips, (uint32_t)src_w * (uint32_t)src_h);
+    }
+    else if (h->refresh_counter >= (uint8_t)(h->refresh_cycles_before_gc - 1))
+    {
+        mode = EPD3IN7_DRIVER_MODE_GC;
+        h->refresh_counter = 0;
+        memset(h->region_wear, 0, sizeof(h->region_wear));
+    }
+    else
+    {
+        mode = h->default_mode;
+        h->refresh_counter++;
+    }
+
+    /* The previous frame still queued or uploading is superseded: drop what has not reached the
+       panel (its upload is stopped mid-DMA) before its source and band slots are overwritten.
+       A dropped GC is carried over to this frame, a dropped area is re-sent with this one. */
+    bool carry_area = false;
+    if (h->frames_queued != h->frames_done)
+    {
+        bool dropped = false;
+        (void)epd3in7_driver_cancel_frame_dma(h->driver, h->spi_mgr, &dropped);
+        if (dropped && h->queued_mode == EPD3IN7_DRIVER_MODE_GC)
+        {
+            mode = EPD3IN7_DRIVER_MODE_GC;
+            h->refresh_counter = 0;
+            memset(h->region_wear, 0, sizeof(h->region_wear));
+        }
+        carry_area = dropped;
+    }
+    h->queued_mode = mode;
 
-        epd3in7_lvgl_adapter_rotate_i1(src, h->work_buffer, src_w, src_h,
-                                       (int32_t)src_stride, (int32_t)dst_stride, rotation);
+    /* With a shadow the stream reads the copy and LVGL may render the next frame at once */
+    if (h->shadow_buffer)
+    {
+        memcpy(h->shadow_buffer, src, (size_t)src_stride * (size_t)src_h);
+        h->shadow_valid = true;
+        src = h->shadow_buffer;
+    }
+
+    rotated_area = *src_area;
+    lv_display_rotate_area(disp, &rotated_area);
+    const int32_t dst_w = lv_area_get_width(&rotated_area);
+    const uint32_t dst_stride = lv_draw_buf_width_to_stride(dst_w, cf);
+
+    /* Upload only the invalidated box while the panel RAM holds the rest of the picture
+       (SLEEP keeps RAM). GC frames resend the whole RAM as a periodic resync. */
+    epd3in7_driver_area panel_area = {0, 0, EPD3IN7_WIDTH, EPD3IN7_HEIGHT};
+    if (h->panel_synced && mode != EPD3IN7_DRIVER_MODE_GC && h->dirty_has_value)
+    {
+        /* Dirty box relative to the flushed frame, clipped to it */
+        lv_area_t d;
+        d.x1 = LV_MAX(h->dirty.x1, src_area->x1) - src_area->x1;
+        d.y1 = LV_MAX(h->dirty.y1, src_area->y1) - src_area->y1;
+        d.x2 = LV_MIN(h->dirty.x2, src_area->x2) - src_area->x1;
+        d.y2 = LV_MIN(h->dirty.y2, src_area->y2) - src_area->y1;
+        if (d.x1 <= d.x2 && d.y1 <= d.y2)
+        {
+            panel_area = epd3in7_lvgl_adapter_panel_area(&d, src_w, src_h, rotation);
+            if (carry_area)
+                epd3in7_lvgl_adapter_area_join(&panel_area, &h->queued_area);
+        }
+    }
+    h->dirty_has_value = false;
+
+    /* Counted before anything is queued, so an older fence running meanwhile leaves this buffer alone */
+    h->frames_queued++;
+
+    /* Enqueue frame (non-blocking) + sleep afterwards */
+    epd3in7_driver_status st;
+    if (rotation == LV_DISPLAY_ROTATION_0 && h->shadow_buffer && panel_area.w == EPD3IN7_WIDTH &&
+        dst_stride == EPD3IN7_WIDTH / 8u)
+    {
+        /* Frame already in panel orientation and held by the shadow: full-width rows are contiguous,
+           DMA reads them in place (no band pass) */
+        h->stream_disp = NULL;
+        if (panel_area.h == EPD3IN7_HEIGHT)
+            st = epd3in7_driver_display_1_gray_dma(h->driver, h->spi_mgr, src, mode);
+        else
+            st = epd3in7_driver_display_1_gray_area_dma(h->driver, h->spi_mgr, src + (size_t)panel_area.y * dst_stride,
+                                                        &panel_area, mode);
     }
     else
     {
-        /* Fast path: full-frame memcpy into work_buffer */
-        const uint32_t frame_bytes = (uint32_t)src_stride * (uint32_t)src_h;
-        memcpy(h->work_buffer, src, frame_bytes);
+        /* Bands are rotated from src as they go out; without a shadow LVGL's buffer is held until
+           the last one is produced */
+        h->stream_src = src;
+        h->stream_src_w = src_w;
+        h->stream_src_h = src_h;
+        h->stream_src_stride = src_stride;
+        h->stream_dst_stride = dst_stride;
+        h->stream_rotation = rotation;
+        h->stream_area = panel_area;
+        h->stream_disp = h->shadow_buffer ? NULL : disp;
+        st = epd3in7_driver_display_1_gray_stream_dma(h->driver, h->spi_mgr, &panel_area,
+                                                      h->band_buffer,
+                                                      EPD3IN7_LVGL_ADAPTER_BAND_BYTES,
+                                                      EPD3IN7_LVGL_ADAPTER_BAND_ROWS,
+                                                      epd3in7_lvgl_adapter_fill_band, h, mode);
+    }
+    /* A failed enqueue leaves the panel RAM unknown: the next frame goes out whole. Bands queued
+       before the failure are dropped, they would read a buffer LVGL is about to get back. */
+    h->panel_synced = (st == EPD3IN7_DRIVER_OK);
+    if (st != EPD3IN7_DRIVER_OK)
+    {
+        h->shadow_valid = false;
+        (void)epd3in7_driver_cancel_frame_dma(h->driver, h->spi_mgr, NULL);
+    }
+    h->queued_area = panel_area;
+    (void)epd3in7_driver_sleep_dma(h->driver, h->spi_mgr, EPD3IN7_DRIVER_SLEEP_NORMAL);
+    h->is_sleeping = true;
+
+    /* ---- Register completion fence AFTER enqueuing last txn ---- */
+    if (spi_bus_manager_enqueue_callback(h->spi_mgr,
+                                         epd3in7_lvgl_adapter_dma_done_cb_mgr,
+                                         (void *)h) != SPI_BUS_MANAGER_OK)
+        h->frames_queued--;
+
+    /* Buffer already released by a shadow copy; a failed enqueue releases it here */
+    if (h->shadow_buffer || st != EPD3IN7_DRIVER_OK)
+    {
+        h->stream_disp = NULL;
+        lv_display_flush_ready(disp);
+    }
+}
+void epd3in7_lvgl_adapter_flush_4_gray_dma(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    epd3in7_lvgl_adapter_handle *h = lv_display_get_driver_data(disp);
+    if (!h || !px_map || !h->spi_mgr || !h->i2_frame || !h->planes)
+    {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    if (!h->is_initialized)
+    {
+        if (epd3in7_driver_init_4_gray_dma(h->driver, h->spi_mgr) != EPD3IN7_DRIVER_OK)
+        {
+            lv_display_flush_ready(disp);
+            return;
+        }
+        h->is_initialized = true;
+        h->is_sleeping = false;
+    }
+
+    /* Band -> I2 frame; i2_frame is not read by DMA, so this never races the previous frame */
+    const int32_t w = lv_area_get_width(area);
+    const uint32_t src_stride = lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_L8);
+    epd3in7_lvgl_adapter_l8_to_i2(px_map, src_stride, area,
+                                  lv_display_get_horizontal_resolution(disp),
+                                  lv_display_get_vertical_resolution(disp),
+                                  h->i2_frame, EPD3IN7_WIDTH / 4, lv_display_get_rotation(disp));
+
+    if (!lv_display_flush_is_last(disp))
+    {
+        lv_display_flush_ready(disp);
+        return;
     }
 
-    /* Enqueue frame (non-blocking) + sleep afterwards. */
-    (void)epd3in7_driver_display_1_gray_dma(h->driver, h->spi_mgr, (const uint8_t *)h->work_buffer, mode);
+    /* The planes are the DMA source: drop a frame still queued or uploading before rewriting them */
+    if (h->frames_queued != h->frames_done)
+        (void)epd3in7_driver_cancel_frame_dma(h->driver, h->spi_mgr, NULL);
+
+    const uint32_t plane_bytes = (uint32_t)EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8u;
+    uint8_t *plane_ram = h->planes;
+    uint8_t *plane_ram2 = h->planes + plane_bytes;
+    epd3in7_driver_i2_to_planes(h->i2_frame, plane_ram, plane_ram2, plane_bytes * 2u);
+
+    /* Counted before anything is queued, so an older fence running meanwhile sees this frame */
+    h->frames_queued++;
+
+    /* A failed enqueue drops what was queued of this frame (it would upload half a picture) and
+       re-runs the init with the next frame, the panel state being unknown */
+    const epd3in7_driver_status st = epd3in7_driver_display_4_gray_dma(h->driver, h->spi_mgr, plane_ram, plane_ram2);
+    if (st != EPD3IN7_DRIVER_OK)
+    {
+        (void)epd3in7_driver_cancel_frame_dma(h->driver, h->spi_mgr, NULL);
+        h->is_initialized = false;
+    }
     (void)epd3in7_driver_sleep_dma(h->driver, h->spi_mgr, EPD3IN7_DRIVER_SLEEP_NORMAL);
     h->is_sleeping = true;
 
-    /* ---- Register completion callback AFTER enqueuing last txn ---- */
-    h->dma_in_progress = true;
-    h->pending_disp = disp;
-    spi_bus_manager_enqueue_callback(h->spi_mgr,
-                                     epd3in7_lvgl_adapter_dma_done_cb_mgr,
-                                     (void *)h);
-}
\ No newline at end of file
+    if (spi_bus_manager_enqueue_callback(h->spi_mgr,
+                                         epd3in7_lvgl_adapter_dma_done_cb_mgr,
+                                         (void *)h) != SPI_BUS_MANAGER_OK)
+        h->frames_queued--;
+
+    lv_display_flush_ready(disp);
+}
+
+void epd3in7_lvgl_adapter_invalidate_cb(lv_event_t *e)
+{
+    lv_display_t *disp = (lv_display_t *)lv_event_get_current_target(e);
+    epd3in7_lvgl_adapter_handle *h = disp ? lv_display_get_driver_data(disp) : NULL;
+    const lv_area_t *a = (const lv_area_t *)lv_event_get_param(e);
+    if (!h || !a)
+        return;
+
+    if (!h->dirty_has_value)
+    {
+        h->dirty = *a;
+        h->dirty_has_value = true;
+        return;
+    }
+    h->dirty.x1 = LV_MIN(h->dirty.x1, a->x1);
+    h->dirty.y1 = LV_MIN(h->dirty.y1, a->y1);
+    h->dirty.x2 = LV_MAX(h->dirty.x2, a->x2);
+    h->dirty.y2 = LV_MAX(h->dirty.y2, a->y2);
+}
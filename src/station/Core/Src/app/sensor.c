@@ -2,6 +2,9 @@
 #include "gpio.h"
 #include "tim.h"
 
+// Najdłuższe oczekiwanie na wolną magistralę: jeden chunk / ramka EPD + watchdog DMA
+#define SENSOR_BUS_LEASE_TIMEOUT_MS 300
+
 sensor_handle sensor_create(spi_bus_manager *spi_mgr, TIM_HandleTypeDef *sensor_tim, SPI_HandleTypeDef *sensor_spi, GPIO_TypeDef *cs_port, uint16_t cs_pin)
 {
     sensor_handle handle;
@@ -10,11 +13,13 @@ sensor_handle sensor_create(spi_bus_manager *spi_mgr, TIM_HandleTypeDef *sensor_
     handle.sensor_spi = sensor_spi;
     handle.cs_port = cs_port;
     handle.cs_pin = cs_pin;
+    handle.ready = false;
     return handle;
 }
 
 static void sensor_init_normal(sensor_handle *handle)
 {
+    // Tryb (CPOL/CPHA/DS) z konfiguracji CubeMX; prescaler manager wylicza z BME280_ASYNC_SPI_MAX_HZ
     uint32_t cr1 = handle->sensor_spi->Instance->CR1;
     uint32_t cr2 = handle->sensor_spi->Instance->CR2;
 
@@ -24,21 +29,29 @@ static void sensor_init_normal(sensor_handle *handle)
                       cr1, cr2);
 }
 
-void sensor_init(sensor_handle *handle)
+bool sensor_init(sensor_handle *handle)
 {
     // Timer do delay_us w legacy kodzie
     HAL_TIM_Base_Start(handle->sensor_tim);
 
     // Legacy init — ustawia kalibrację i NORMALMODE (ciągła konwersja)
+    // Blokujący kod na współdzielonym SPI2: najpierw dzierżawa magistrali od kolejki DMA
+    handle->ready = false;
+    if (spi_bus_manager_acquire(handle->spi_mgr, SENSOR_BUS_LEASE_TIMEOUT_MS) != SPI_BUS_MANAGER_OK)
+        return false;
     BMPxx_Spi_CS_Init(handle->cs_port, handle->cs_pin);
-    BME280_Init(handle->sensor_spi,
-                BME280_TEMPERATURE_16BIT,
-                BME280_PRESSURE_ULTRALOWPOWER,
-                BME280_HUMIDITY_STANDARD,
-                BME280_FORCEDMODE);
-    BME280_SetConfig(BME280_STANDBY_MS_1000, BME280_FILTER_OFF);
+    bool ok = BME280_Init(handle->sensor_spi,
+                          BME280_TEMPERATURE_16BIT,
+                          BME280_PRESSURE_ULTRALOWPOWER,
+                          BME280_HUMIDITY_STANDARD,
+                          BME280_FORCEDMODE);
+    if (ok)
+        BME280_SetConfig(BME280_STANDBY_MS_1000, BME280_FILTER_OFF);
+    spi_bus_manager_release(handle->spi_mgr);
 
     // sensor_init_normal(handle);
+    handle->ready = ok;
+    return ok;
 }
 
 bool sensor_normal_kick(sensor_handle *handle)
@@ -66,5 +79,25 @@ bool sensor_normal_try_get(sensor_handle *handle, app_device_data *out)
 
 bool sensor_forced_get(sensor_handle *handle, app_device_data *out)
 {
-    BME280_ReadTemperatureAndPressureAndHumidity(&out->temperature, &out->pressure, &out->humidity);
+    // Init nieudany (np. magistrala zajęta przy starcie) - ponawiamy przy każdym odczycie
+    if (!handle->ready && !sensor_init(handle))
+        return false;
+
+    // Pomiar wymuszony blokuje SPI2 na czas konwersji - EPD poczeka na granicy chunka
+    if (spi_bus_manager_acquire(handle->spi_mgr, SENSOR_BUS_LEASE_TIMEOUT_MS) != SPI_BUS_MANAGER_OK)
+        return false;
+
+    float temperature, humidity;
+    int32_t pressure;
+    uint8_t res = BME280_ReadTemperatureAndPressureAndHumidity(&temperature, &pressure, &humidity);
+
+    spi_bus_manager_release(handle->spi_mgr);
+    if (res != 0)
+        return false;
+
+    // Tylko poprawny odczyt nadpisuje poprzednie wartości
+    out->temperature = temperature;
+    out->pressure = pressure;
+    out->humidity = humidity;
+    return true;
 }
\ No newline at end of file
@@ -66,7 +66,7 @@ void MX_GPIO_Init(void)
 
   /*Configure GPIO pin : DISP_BUSY_Pin */
   GPIO_InitStruct.Pin = DISP_BUSY_Pin;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   HAL_GPIO_Init(DISP_BUSY_GPIO_Port, &GPIO_InitStruct);
 
@@ -84,6 +84,9 @@ void MX_GPIO_Init(void)
   HAL_GPIO_Init(RAD_CS_GPIO_Port, &GPIO_InitStruct);
 
   /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI2_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI2_IRQn);
+
   HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
   HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
 
@@ -104,6 +104,7 @@ int main(void)
   MX_ADC1_Init();
   MX_RTC_Init();
   MX_SPI3_Init();
+  MX_TIM6_Init();
   /* USER CODE BEGIN 2 */
 
   /* USER CODE END 2 */
@@ -231,6 +232,11 @@ void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
   app_spi_error_callback(&app, hspi);
 }
 
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  app_tim_period_elapsed_callback(&app, htim);
+}
+
 /* USER CODE END 4 */
 
 /**
@@ -5,6 +5,11 @@
 #include "shared/drivers/spi_bus_manager.h"
 #include "shared/drivers/bmpxx80.h"
 
+// maksymalny zegar SPI BME280 (nota katalogowa: 10 MHz); prescaler dobiera spi-bus-manager
+#ifndef BME280_ASYNC_SPI_MAX_HZ
+#define BME280_ASYNC_SPI_MAX_HZ 10000000
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -23,12 +28,13 @@ extern "C"
     {
         // spi-bus-manager
         spi_bus_manager *mgr;
-        // linie urządzenia
-        spi_bus_gpio cs;
-        // (opcjonalnie) DC nieużywane — zostawiamy puste
-        // snapshot CR1/CR2 dla BME280 (prescaler/CPOL/CPHA/DS=8)
-        uint32_t cr1;
-        uint32_t cr2;
+        // profil urządzenia w managerze: CS, snapshot CR1/CR2 (CPOL/CPHA/DS=8), limit zegara, callbacki
+        spi_bus_device bus_dev;
+        uint8_t bus_dev_id;
+        // profil zarejestrowany (bus_dev_id ważne); bez tego odczyty nie są zlecane
+        bool registered;
+        // stały deskryptor odczytu burst (submit przez wskaźnik)
+        spi_bus_transaction read_tx;
 
         // bufory jednorazowego „burst read”
         // SPI: najpierw 1 bajt adresu z bit7=1 (read), potem 8 bajtów danych
@@ -51,6 +57,9 @@ extern "C"
      * @brief Inicjalizacja warstwy async. Zakładamy, że BME280 został już
      *        poprawnie zainicjalizowany przez istniejące BME280_Init() i SetConfig()
      *        w trybie NORMALMODE (ciągłe próbkowanie).
+     *        Profil rejestrowany jest w managerze raz: ponowne init z tym samym managerem
+     *        zachowuje go (i jego CS/CR1/CR2). Gdy rejestracja się nie uda, error = true,
+     *        a bme280_async_trigger_read() zwraca false.
      */
     void bme280_async_init(bme280_async *dev,
                            spi_bus_manager *mgr,
@@ -64,7 +73,7 @@ extern "C"
 
     /**
      * @brief Zleć pojedynczy, nieblokujący odczyt burst (P/T/H).
-     *        Jeśli kolejka pełna -> zwraca false, nic nie zlecono.
+     *        Jeśli kolejka pełna lub profil niezarejestrowany -> zwraca false, nic nie zlecono.
      */
     bool bme280_async_trigger_read(bme280_async *dev);
 
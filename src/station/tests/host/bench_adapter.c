@@ -0,0 +1,117 @@
+/* Adapter-side cost of the 1-gray DMA flush (epd3in7_lvgl_adapter_flush_dma) in both display orientations:
+   - rotation 90: landscape frame, rotated into panel rows band by band during the upload (what the station runs)
+   - rotation 0: frame in panel orientation, read by DMA straight from the shadow buffer (needs a portrait UI)
+   Per frame after the first: host time of the flush call (diff, flip count, shadow copy, enqueue), host time of the
+   band pass the upload runs in its half-transfer interrupts, and virtual upload time on the sim.
+   Not an end-to-end frame time: LVGL rendering and the panel refresh (BUSY) are not included. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+#include "app/drivers/epd3in7_lvgl_adapter.c"
+#include <stdlib.h>
+#include <time.h>
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+
+static host_station st;
+static epd3in7_lvgl_adapter_handle adapter;
+static lv_display_t disp;
+static uint8_t frame[8 + FRAME_BYTES]; /* LVGL I1 buffer: palette, then pixels */
+static uint8_t shadow[FRAME_BYTES];
+static uint8_t band[EPD3IN7_LVGL_ADAPTER_BAND_BYTES];
+
+static double host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static bool upload_done(void *user)
+{
+    (void)user;
+    /* Frame data and LUT sent, refresh running */
+    return host_sim_panel_busy();
+}
+
+static void flip_box(int32_t x1, int32_t y1, int32_t w, int32_t h)
+{
+    const int32_t stride = lv_display_get_horizontal_resolution(&disp) / 8;
+    for (int32_t y = y1; y < y1 + h; ++y)
+        for (int32_t x = x1; x < x1 + w; ++x)
+            frame[8 + (size_t)y * stride + (x >> 3)] ^= (uint8_t)(0x80u >> (x & 7));
+}
+
+/* Band pass of the frame just queued, as the upload interrupts run it */
+static double time_band_pass(void)
+{
+    if (adapter.stream_src == NULL || adapter.frames_queued == adapter.frames_done)
+        return 0.0;
+    epd3in7_lvgl_adapter_handle copy = adapter;
+    copy.stream_disp = NULL;
+    const epd3in7_driver_area a = copy.stream_area;
+    const int reps = 20;
+    const double t0 = host_now_ns();
+    for (int i = 0; i < reps; ++i)
+        for (uint16_t row = a.y; row < a.y + a.h; row += EPD3IN7_LVGL_ADAPTER_BAND_ROWS)
+            epd3in7_lvgl_adapter_fill_band(&copy, row, (uint16_t)LV_MIN(EPD3IN7_LVGL_ADAPTER_BAND_ROWS, a.y + a.h - row), band);
+    return (host_now_ns() - t0) / reps;
+}
+
+static void bench_one_frame(const char *label)
+{
+    const lv_area_t full = {0, 0, lv_display_get_horizontal_resolution(&disp) - 1,
+                            lv_display_get_vertical_resolution(&disp) - 1};
+    adapter.stream_src = NULL;
+    const double t0 = host_now_ns();
+    epd3in7_lvgl_adapter_flush_dma(&disp, &full, frame);
+    const double flush = host_now_ns() - t0;
+    const double bands = time_band_pass();
+    const uint64_t v0 = host_sim_now_ns();
+    CHECK(host_sim_run_until(upload_done, NULL, 1000u));
+    const uint64_t upload = host_sim_now_ns() - v0;
+    printf("    %-14s %s %3ux%3u: flush %7.0f ns, band pass %7.0f ns (host), upload %6.2f ms\n", label,
+           adapter.queued_mode == EPD3IN7_DRIVER_MODE_GC ? "GC" : "A2", adapter.queued_area.w,
+           adapter.queued_area.h, flush, bands, upload / 1e6);
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+    CHECK_EQ(adapter.frames_queued, adapter.frames_done);
+}
+
+static void bench_orientation(lv_display_rotation_t rotation)
+{
+    host_station_setup(&st, 512, true);
+    adapter = epd3in7_lvgl_adapter_create_with_bus_manager(&st.epd, NULL, 30, EPD3IN7_DRIVER_MODE_A2, &st.mgr);
+    epd3in7_lvgl_adapter_set_shadow_buffer(&adapter, shadow);
+    disp = (lv_display_t){.driver_data = &adapter, .rotation = rotation, .color_format = LV_COLOR_FORMAT_I1,
+                          .hor_res = EPD3IN7_WIDTH, .ver_res = EPD3IN7_HEIGHT, .flush_is_last = true};
+    for (uint32_t i = 0; i < sizeof(frame); ++i)
+        frame[i] = (uint8_t)rand();
+
+    /* First frame: init and a whole GC upload, not timed (BUSY of the init comes first) */
+    const lv_area_t full = {0, 0, lv_display_get_horizontal_resolution(&disp) - 1,
+                            lv_display_get_vertical_resolution(&disp) - 1};
+    epd3in7_lvgl_adapter_flush_dma(&disp, &full, frame);
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+
+    printf("  rotation %d (%s)\n", (int)rotation * 90, rotation == LV_DISPLAY_ROTATION_0 ? "in place" : "streamed");
+    /* Every pixel changed: whole frame, GC */
+    for (uint32_t i = 8; i < sizeof(frame); ++i)
+        frame[i] = (uint8_t)~frame[i];
+    bench_one_frame("all changed");
+    /* A temperature digit: 40 x 60 px box, logical coordinates */
+    flip_box(200, 100, 40, 60);
+    bench_one_frame("digit changed");
+    const uint32_t skipped = adapter.frames_skipped;
+    const double t0 = host_now_ns();
+    epd3in7_lvgl_adapter_flush_dma(&disp, &full, frame);
+    printf("    %-14s skipped: flush %7.0f ns (host)\n", "no change", host_now_ns() - t0);
+    CHECK_EQ(adapter.frames_skipped, skipped + 1u);
+}
+
+int main(void)
+{
+    srand(25);
+    bench_orientation(LV_DISPLAY_ROTATION_90);
+    bench_orientation(LV_DISPLAY_ROTATION_0);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "stm32g4xx_hal.h"
+#include "stm32g4xx_hal_gpio.h"
+
+// Host build: spi_bus_manager platform hooks (SPI_BUS_PORT_* in spi_bus_manager.c) bound to the
+// simulated SPI/DMA peripheral, virtual clock and interrupt model of tests/host/sim.
+#define SPI_BUS_PORT_TX_DMA(hspi, tx, len) host_sim_spi_tx_dma((hspi), (tx), (len))
+#define SPI_BUS_PORT_TXRX_DMA(hspi, tx, rx, len) host_sim_spi_txrx_dma((hspi), (tx), (rx), (len))
+#define SPI_BUS_PORT_TX_POLL(hspi, tx, len, spins) host_sim_spi_tx_poll((hspi), (tx), (len), (spins))
+#define SPI_BUS_PORT_APPLY_REGS(hspi, cr1, cr2) host_sim_spi_apply_regs((hspi), (cr1), (cr2))
+#define SPI_BUS_PORT_KERNEL_HZ(hspi) ((void)(hspi), HOST_SIM_SPI_KERNEL_HZ)
+#define SPI_BUS_PORT_RECOVER(hspi) host_sim_spi_recover(hspi)
+#define SPI_BUS_PORT_ABORT(hspi) host_sim_spi_abort(hspi)
+#define SPI_BUS_PORT_QUIESCE(hspi) host_sim_spi_quiesce(hspi)
+#define SPI_BUS_PORT_TICK_MS() host_sim_tick_ms()
+#define SPI_BUS_PORT_CYCLES() host_sim_cycles()
+#define SPI_BUS_PORT_IRQ_SAVE() host_sim_irq_save()
+#define SPI_BUS_PORT_IRQ_RESTORE(state) host_sim_irq_restore(state)
+#define SPI_BUS_PORT_HAS_EXCLUSIVES 1
@@ -0,0 +1,95 @@
+#pragma once
+
+/* Host stand-in for the part of LVGL 9 the EPD adapter uses: area helpers as in lv_area.c, a display
+   object the tests fill in directly (sim/host_lvgl.c) and an event carrying a target and a parameter. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define LV_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define LV_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define LV_ATTRIBUTE_MEM_ALIGN
+
+    typedef struct
+    {
+        int32_t x1;
+        int32_t y1;
+        int32_t x2;
+        int32_t y2;
+    } lv_area_t;
+
+    typedef enum
+    {
+        LV_DISPLAY_ROTATION_0 = 0,
+        LV_DISPLAY_ROTATION_90,
+        LV_DISPLAY_ROTATION_180,
+        LV_DISPLAY_ROTATION_270
+    } lv_display_rotation_t;
+
+    typedef enum
+    {
+        LV_COLOR_FORMAT_I1 = 0x0C,
+        LV_COLOR_FORMAT_L8 = 0x06
+    } lv_color_format_t;
+
+    /** @brief Display object; hor_res / ver_res are the unrotated (panel-side) resolution, as in LVGL. */
+    typedef struct _lv_display_t
+    {
+        void *driver_data;
+        lv_display_rotation_t rotation;
+        lv_color_format_t color_format;
+        int32_t hor_res;
+        int32_t ver_res;
+        bool flush_is_last;
+        uint32_t flush_ready_calls; /**< lv_display_flush_ready() count (test probe). */
+    } lv_display_t;
+
+    typedef struct _lv_event_t
+    {
+        void *current_target;
+        void *param;
+    } lv_event_t;
+
+    static inline int32_t lv_area_get_width(const lv_area_t *a) { return a->x2 - a->x1 + 1; }
+    static inline int32_t lv_area_get_height(const lv_area_t *a) { return a->y2 - a->y1 + 1; }
+
+    static inline void lv_area_set(lv_area_t *a, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+    {
+        a->x1 = x1;
+        a->y1 = y1;
+        a->x2 = x2;
+        a->y2 = y2;
+    }
+
+    static inline void lv_area_move(lv_area_t *a, int32_t dx, int32_t dy)
+    {
+        a->x1 += dx;
+        a->y1 += dy;
+        a->x2 += dx;
+        a->y2 += dy;
+    }
+
+    uint32_t lv_draw_buf_width_to_stride(uint32_t w, lv_color_format_t cf);
+
+    void *lv_display_get_driver_data(lv_display_t *disp);
+    void lv_display_flush_ready(lv_display_t *disp);
+    bool lv_display_flush_is_last(lv_display_t *disp);
+    lv_display_rotation_t lv_display_get_rotation(lv_display_t *disp);
+    lv_color_format_t lv_display_get_color_format(lv_display_t *disp);
+    /** @brief Resolution after rotation (swapped at 90 / 270). */
+    int32_t lv_display_get_horizontal_resolution(const lv_display_t *disp);
+    int32_t lv_display_get_vertical_resolution(const lv_display_t *disp);
+    void lv_display_rotate_area(lv_display_t *disp, lv_area_t *area);
+
+    void *lv_event_get_current_target(lv_event_t *e);
+    void *lv_event_get_param(lv_event_t *e);
+
+#ifdef __cplusplus
+}
+#endif
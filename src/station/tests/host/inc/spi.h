@@ -0,0 +1,3 @@
+#pragma once
+
+#include "stm32g4xx_hal.h"
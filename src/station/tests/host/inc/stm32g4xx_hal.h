@@ -0,0 +1,118 @@
+#pragma once
+
+/* Host stand-in for the STM32G4 HAL/CMSIS: only the types, registers and calls the station
+   drivers use. The peripherals behind them are simulated in sim/host_sim.c. */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+typedef enum
+{
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct
+{
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t SR;
+} SPI_TypeDef;
+
+typedef struct
+{
+    uint32_t BaudRatePrescaler;
+} SPI_InitTypeDef;
+
+typedef struct
+{
+    SPI_TypeDef *Instance;
+    SPI_InitTypeDef Init;
+} SPI_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+} TIM_HandleTypeDef;
+
+typedef struct
+{
+    void *Instance;
+} ADC_HandleTypeDef;
+
+extern GPIO_TypeDef host_sim_gpio[4];
+extern SPI_TypeDef host_sim_spi[4];
+
+#define GPIOA (&host_sim_gpio[0])
+#define GPIOB (&host_sim_gpio[1])
+#define GPIOC (&host_sim_gpio[2])
+#define GPIOD (&host_sim_gpio[3])
+
+#define SPI1 (&host_sim_spi[0])
+#define SPI2 (&host_sim_spi[1])
+#define SPI3 (&host_sim_spi[2])
+#define SPI4 (&host_sim_spi[3])
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_1 ((uint16_t)0x0002)
+#define GPIO_PIN_2 ((uint16_t)0x0004)
+#define GPIO_PIN_3 ((uint16_t)0x0008)
+#define GPIO_PIN_4 ((uint16_t)0x0010)
+#define GPIO_PIN_5 ((uint16_t)0x0020)
+#define GPIO_PIN_6 ((uint16_t)0x0040)
+#define GPIO_PIN_7 ((uint16_t)0x0080)
+
+#define SPI_CR1_CPHA (1UL << 0)
+#define SPI_CR1_CPOL (1UL << 1)
+#define SPI_CR1_MSTR (1UL << 2)
+#define SPI_CR1_BR_Pos (3U)
+#define SPI_CR1_BR_Msk (0x7UL << SPI_CR1_BR_Pos)
+#define SPI_CR1_SPE (1UL << 6)
+#define SPI_CR1_SSI (1UL << 8)
+#define SPI_CR1_SSM (1UL << 9)
+#define SPI_CR2_DS_Pos (8U)
+#define SPI_CR2_DS_Msk (0xFUL << SPI_CR2_DS_Pos)
+#define SPI_CR2_FRXTH (1UL << 12)
+
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim);
+
+/* CMSIS intrinsics (the exclusive monitor and WFI are modelled by the sim) */
+#define __DMB() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __LDREXH(p) host_sim_ldrexh(p)
+#define __STREXH(v, p) host_sim_strexh((v), (p))
+#define __LDREXB(p) host_sim_ldrexb(p)
+#define __STREXB(v, p) host_sim_strexb((v), (p))
+#define __CLREX() host_sim_clrex()
+#define __WFI() host_sim_wfi()
+
+static inline uint32_t __CLZ(uint32_t v)
+{
+    return v ? (uint32_t)__builtin_clz(v) : 32U;
+}
+
+#include "host_sim.h"
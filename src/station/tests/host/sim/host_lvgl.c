@@ -0,0 +1,90 @@
+/* Display and buffer functions of the LVGL stand-in (inc/lvgl/lvgl.h), same results as LVGL 9 for
+   the formats the adapter uses, with LV_DRAW_BUF_STRIDE_ALIGN 1 as in lv_conf.h. */
+
+#include "lvgl/lvgl.h"
+
+uint32_t lv_draw_buf_width_to_stride(uint32_t w, lv_color_format_t cf)
+{
+    return (cf == LV_COLOR_FORMAT_I1) ? (w + 7u) / 8u : w;
+}
+
+void *lv_display_get_driver_data(lv_display_t *disp)
+{
+    return disp ? disp->driver_data : NULL;
+}
+
+void lv_display_flush_ready(lv_display_t *disp)
+{
+    disp->flush_ready_calls++;
+}
+
+bool lv_display_flush_is_last(lv_display_t *disp)
+{
+    return disp->flush_is_last;
+}
+
+lv_display_rotation_t lv_display_get_rotation(lv_display_t *disp)
+{
+    return disp->rotation;
+}
+
+lv_color_format_t lv_display_get_color_format(lv_display_t *disp)
+{
+    return disp->color_format;
+}
+
+static bool lv_display_swapped(const lv_display_t *disp)
+{
+    return disp->rotation == LV_DISPLAY_ROTATION_90 || disp->rotation == LV_DISPLAY_ROTATION_270;
+}
+
+int32_t lv_display_get_horizontal_resolution(const lv_display_t *disp)
+{
+    return lv_display_swapped(disp) ? disp->ver_res : disp->hor_res;
+}
+
+int32_t lv_display_get_vertical_resolution(const lv_display_t *disp)
+{
+    return lv_display_swapped(disp) ? disp->hor_res : disp->ver_res;
+}
+
+/* As lv_display_rotate_area() in lv_display.c */
+void lv_display_rotate_area(lv_display_t *disp, lv_area_t *area)
+{
+    const int32_t w = lv_area_get_width(area);
+    const int32_t h = lv_area_get_height(area);
+
+    switch (disp->rotation)
+    {
+    case LV_DISPLAY_ROTATION_90:
+        area->y2 = disp->ver_res - area->x1 - 1;
+        area->x1 = area->y1;
+        area->x2 = area->x1 + h - 1;
+        area->y1 = area->y2 - w + 1;
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        area->y2 = disp->ver_res - area->y1 - 1;
+        area->y1 = area->y2 - h + 1;
+        area->x2 = disp->hor_res - area->x1 - 1;
+        area->x1 = area->x2 - w + 1;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        area->x1 = disp->hor_res - area->y2 - 1;
+        area->y2 = area->x2;
+        area->x2 = area->x1 + h - 1;
+        area->y1 = area->y2 - w + 1;
+        break;
+    default:
+        break;
+    }
+}
+
+void *lv_event_get_current_target(lv_event_t *e)
+{
+    return e->current_target;
+}
+
+void *lv_event_get_param(lv_event_t *e)
+{
+    return e->param;
+}
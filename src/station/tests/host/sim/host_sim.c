@@ -0,0 +1,767 @@
+#include "host_sim.h"
+#include "shared/drivers/spi_bus_manager.h"
+#include <stdlib.h>
+#include <string.h>
+
+GPIO_TypeDef host_sim_gpio[4];
+SPI_TypeDef host_sim_spi[4];
+
+/* Exception entry + exit (stacking, tail of the HAL IRQ handler), charged to every interrupt */
+#define HOST_SIM_COST_ISR_NS 375u
+#define HOST_SIM_MAX_EVENTS 64
+#define HOST_SIM_NS_PER_MS 1000000ull
+
+typedef enum
+{
+    SIM_EV_SPI_HALF = 0,
+    SIM_EV_SPI_CPLT,
+    SIM_EV_SPI_ERROR,
+    SIM_EV_TIMER,
+    SIM_EV_BUSY_FALL,
+    SIM_EV_CALL
+} sim_event_kind;
+
+typedef struct
+{
+    bool used;
+    uint64_t t_ns;
+    uint64_t seq;
+    sim_event_kind kind;
+    int spi;
+    void (*fn)(void *user);
+    void *user;
+} sim_event;
+
+/* DMA transfer of one SPI instance */
+typedef struct
+{
+    bool active;
+    bool txrx;
+    bool lost;
+    SPI_HandleTypeDef *hspi;
+    const uint8_t *tx;
+    uint8_t *rx;
+    uint32_t bytes;
+    uint32_t logged; /* bytes already in the wire log */
+    uint64_t start_ns;
+    uint64_t byte_ns;
+    uint8_t dev;
+    uint8_t dc;
+} sim_xfer;
+
+typedef struct
+{
+    bool used;
+    GPIO_TypeDef *cs_port;
+    uint16_t cs_pin;
+    host_sim_responder_fn respond;
+    void *user;
+    uint32_t rx_index;
+} sim_device;
+
+static struct
+{
+    uint64_t now_ns;
+    uint64_t seq;
+    uint32_t irq_masked;
+    uint32_t in_isr;
+    uint32_t monitor_epoch;
+    sim_event events[HOST_SIM_MAX_EVENTS];
+    sim_xfer xfer[4];
+    sim_device devices[HOST_SIM_MAX_DEVICES];
+    GPIO_TypeDef *dc_port;
+    uint16_t dc_pin;
+    /* panel */
+    bool panel_attached;
+    uint8_t panel_dev;
+    GPIO_TypeDef *busy_port;
+    uint16_t busy_pin;
+    bool panel_busy;
+    bool panel_busy_cmd_open; /* data of the command that raised BUSY may still follow */
+    uint32_t panel_busy_ms[256];
+    uint32_t panel_violations;
+    void (*exti)(uint16_t pin);
+    /* faults */
+    uint32_t fault_lose;
+    uint32_t fault_refuse;
+    uint32_t fault_error;
+    uint32_t fault_stall;
+    /* legacy CS release spin */
+    bool legacy_spin;
+    uint32_t legacy_tail_ns;
+    bool legacy_armed;
+    uint64_t legacy_bsy_until;
+    /* wire log */
+    host_sim_wire_byte *wire;
+    uint32_t wire_count;
+    uint32_t wire_cap;
+    host_sim_stats stats;
+} sim;
+
+/* Exclusive monitor: address and epoch of the last LDREX */
+static const volatile void *sim_res_addr;
+static uint32_t sim_res_epoch;
+static bool sim_res_valid;
+
+/* ------------------------------- Event queue ------------------------------- */
+
+static void sim_schedule(uint64_t t_ns, sim_event_kind kind, int spi, void (*fn)(void *), void *user)
+{
+    for (int i = 0; i < HOST_SIM_MAX_EVENTS; ++i)
+    {
+        if (sim.events[i].used)
+            continue;
+        sim.events[i] = (sim_event){true, t_ns, sim.seq++, kind, spi, fn, user};
+        return;
+    }
+    abort(); /* event table too small for the scenario */
+}
+
+static void sim_cancel(sim_event_kind kind, int spi)
+{
+    for (int i = 0; i < HOST_SIM_MAX_EVENTS; ++i)
+    {
+        if (sim.events[i].used && sim.events[i].kind == kind && sim.events[i].spi == spi)
+            sim.events[i].used = false;
+    }
+}
+
+static sim_event *sim_next_event(void)
+{
+    sim_event *best = NULL;
+    for (int i = 0; i < HOST_SIM_MAX_EVENTS; ++i)
+    {
+        sim_event *e = &sim.events[i];
+        if (!e->used)
+            continue;
+        if (!best || e->t_ns < best->t_ns || (e->t_ns == best->t_ns && e->seq < best->seq))
+            best = e;
+    }
+    return best;
+}
+
+/* ------------------------------ Bus and wire ------------------------------ */
+
+static int sim_spi_index(const SPI_HandleTypeDef *hspi)
+{
+    return (int)(hspi->Instance - host_sim_spi);
+}
+
+static bool sim_pin_low(const GPIO_TypeDef *port, uint16_t pin)
+{
+    return (port->ODR & pin) == 0u;
+}
+
+/* Device whose CS is asserted (counts a conflict if several are) */
+static uint8_t sim_selected_device(void)
+{
+    uint8_t found = HOST_SIM_NO_DEVICE;
+    for (uint8_t i = 0; i < HOST_SIM_MAX_DEVICES; ++i)
+    {
+        const sim_device *d = &sim.devices[i];
+        if (!d->used || !sim_pin_low(d->cs_port, d->cs_pin))
+            continue;
+        if (found != HOST_SIM_NO_DEVICE)
+            sim.stats.cs_conflicts++;
+        found = i;
+    }
+    return found;
+}
+
+static uint8_t sim_dc_level(void)
+{
+    if (!sim.dc_port)
+        return 1u;
+    return (sim.dc_port->ODR & sim.dc_pin) ? 1u : 0u;
+}
+
+/* Time per byte at the SCLK programmed in CR1 (8-bit frames) */
+static uint64_t sim_byte_ns(const SPI_HandleTypeDef *hspi)
+{
+    uint32_t br = (hspi->Instance->CR1 & SPI_CR1_BR_Msk) >> SPI_CR1_BR_Pos;
+    uint64_t sclk = HOST_SIM_SPI_KERNEL_HZ >> (br + 1u);
+    return (8ull * 1000000000ull + sclk - 1u) / sclk;
+}
+
+static void sim_panel_byte(uint64_t t_ns, uint8_t byte, uint8_t dc)
+{
+    if (dc == 0u)
+        sim.panel_busy_cmd_open = false;
+    if (sim.panel_busy)
+    {
+        if (!sim.panel_busy_cmd_open)
+            sim.panel_violations++;
+        return;
+    }
+    if (dc != 0u || sim.panel_busy_ms[byte] == 0u)
+        return;
+
+    sim.panel_busy = true;
+    sim.panel_busy_cmd_open = true;
+    sim.busy_port->IDR |= sim.busy_pin;
+    sim_schedule(t_ns + (uint64_t)sim.panel_busy_ms[byte] * HOST_SIM_NS_PER_MS, SIM_EV_BUSY_FALL, -1, NULL, NULL);
+}
+
+static void sim_wire_put(uint64_t t_ns, uint8_t byte, uint8_t dc, uint8_t dev, bool dma)
+{
+    if (sim.wire_count == sim.wire_cap)
+    {
+        sim.wire_cap = sim.wire_cap ? sim.wire_cap * 2u : 65536u;
+        sim.wire = realloc(sim.wire, sim.wire_cap * sizeof(*sim.wire));
+        if (!sim.wire)
+            abort();
+    }
+    sim.wire[sim.wire_count++] = (host_sim_wire_byte){t_ns, byte, dc, dev, dma ? 1u : 0u};
+
+    if (dev == HOST_SIM_NO_DEVICE)
+        sim.stats.bytes_without_cs++;
+    else if (sim.panel_attached && dev == sim.panel_dev)
+        sim_panel_byte(t_ns, byte, dc);
+}
+
+/* Shift one byte: log MOSI, answer MISO from the selected device */
+static uint8_t sim_shift(uint64_t t_ns, uint8_t tx, uint8_t dc, uint8_t dev, bool dma)
+{
+    sim_wire_put(t_ns, tx, dc, dev, dma);
+    if (dev == HOST_SIM_NO_DEVICE || !sim.devices[dev].respond)
+        return 0xFFu;
+    sim_device *d = &sim.devices[dev];
+    return d->respond(d->user, d->rx_index++, tx);
+}
+
+/* Bytes [x->logged, upto) of a DMA transfer have left the shifter */
+static void sim_xfer_log(sim_xfer *x, uint32_t upto, uint64_t t_ns)
+{
+    for (uint32_t i = x->logged; i < upto; ++i)
+    {
+        uint8_t rx = sim_shift(t_ns, x->tx[i], x->dc, x->dev, true);
+        if (x->txrx)
+            x->rx[i] = rx;
+    }
+    x->logged = upto;
+}
+
+/* ------------------------------ Interrupts ------------------------------ */
+
+static void sim_run_event(const sim_event *e)
+{
+    switch (e->kind)
+    {
+    case SIM_EV_SPI_HALF:
+    {
+        sim_xfer *x = &sim.xfer[e->spi];
+        sim_xfer_log(x, x->bytes / 2u, e->t_ns);
+        sim.stats.halves++;
+        if (x->txrx)
+            spi_bus_manager_dispatch_txrx_half(x->hspi);
+        else
+            spi_bus_manager_dispatch_tx_half(x->hspi);
+        break;
+    }
+    case SIM_EV_SPI_CPLT:
+    {
+        sim_xfer *x = &sim.xfer[e->spi];
+        sim_xfer_log(x, x->bytes, e->t_ns);
+        x->active = false;
+        sim.stats.completions++;
+        sim.legacy_armed = sim.legacy_spin;
+        sim.legacy_bsy_until = e->t_ns + sim.legacy_tail_ns;
+        if (x->txrx)
+            spi_bus_manager_dispatch_txrx_cplt(x->hspi);
+        else
+            spi_bus_manager_dispatch_tx_cplt(x->hspi);
+        break;
+    }
+    case SIM_EV_SPI_ERROR:
+    {
+        sim_xfer *x = &sim.xfer[e->spi];
+        x->active = false;
+        sim.stats.errors++;
+        spi_bus_manager_dispatch_error(x->hspi);
+        break;
+    }
+    case SIM_EV_TIMER:
+        spi_bus_manager_on_timer((spi_bus_manager *)e->user);
+        break;
+    case SIM_EV_BUSY_FALL:
+        sim.panel_busy = false;
+        sim.busy_port->IDR &= ~(uint32_t)sim.busy_pin;
+        if (sim.exti)
+            sim.exti(sim.busy_pin);
+        break;
+    case SIM_EV_CALL:
+        e->fn(e->user);
+        break;
+    }
+}
+
+static void sim_take(sim_event *e)
+{
+    sim_event ev = *e;
+    e->used = false;
+
+    sim.in_isr++;
+    sim.monitor_epoch++;
+    const uint64_t t0 = sim.now_ns;
+    sim.now_ns += HOST_SIM_COST_ISR_NS;
+    sim_run_event(&ev);
+    sim.legacy_armed = false;
+    const uint64_t dt = sim.now_ns - t0;
+    sim.stats.isr_count++;
+    sim.stats.isr_ns_total += dt;
+    if (dt > sim.stats.isr_ns_max)
+        sim.stats.isr_ns_max = dt;
+    sim.monitor_epoch++;
+    sim.in_isr--;
+}
+
+void host_sim_poll_irqs(void)
+{
+    while (!sim.in_isr && !sim.irq_masked)
+    {
+        sim_event *e = sim_next_event();
+        if (!e || e->t_ns > sim.now_ns)
+            return;
+        sim_take(e);
+    }
+}
+
+void host_sim_spend_ns(uint64_t ns)
+{
+    sim.now_ns += ns;
+    host_sim_poll_irqs();
+}
+
+void host_sim_schedule_irq(uint64_t t_ns, void (*fn)(void *user), void *user)
+{
+    sim_schedule(t_ns, SIM_EV_CALL, -1, fn, user);
+}
+
+/* ------------------------------- Control ------------------------------- */
+
+void host_sim_reset(void)
+{
+    free(sim.wire);
+    memset(&sim, 0, sizeof(sim));
+    memset(host_sim_spi, 0, sizeof(host_sim_spi));
+    for (int i = 0; i < 4; ++i)
+    {
+        host_sim_gpio[i].ODR = 0xFFFFu; /* CS lines idle high */
+        host_sim_gpio[i].IDR = 0u;
+    }
+    sim_res_valid = false;
+}
+
+uint64_t host_sim_now_ns(void) { return sim.now_ns; }
+bool host_sim_in_isr(void) { return sim.in_isr != 0u; }
+const host_sim_stats *host_sim_get_stats(void) { return &sim.stats; }
+
+void host_sim_wfi(void)
+{
+    if (sim.in_isr)
+        return;
+    sim.stats.wfi_count++;
+    /* Sleep until the next event or SysTick, whichever comes first */
+    uint64_t wake = (sim.now_ns / HOST_SIM_NS_PER_MS + 1u) * HOST_SIM_NS_PER_MS;
+    const sim_event *e = sim_next_event();
+    if (e && e->t_ns < wake)
+        wake = e->t_ns;
+    if (wake > sim.now_ns)
+        sim.now_ns = wake;
+    host_sim_poll_irqs();
+}
+
+bool host_sim_run_until(bool (*done)(void *user), void *user, uint32_t timeout_ms)
+{
+    const uint32_t start = HAL_GetTick();
+    for (;;)
+    {
+        spi_bus_manager_tick_all();
+        if (done && done(user))
+            return true;
+        if (HAL_GetTick() - start >= timeout_ms)
+            return false;
+        host_sim_wfi();
+    }
+}
+
+void host_sim_run_ms(uint32_t ms)
+{
+    (void)host_sim_run_until(NULL, NULL, ms);
+}
+
+/* ------------------------------- Devices ------------------------------- */
+
+void host_sim_attach_device(uint8_t dev, GPIO_TypeDef *cs_port, uint16_t cs_pin,
+                            host_sim_responder_fn respond, void *user)
+{
+    sim.devices[dev] = (sim_device){true, cs_port, cs_pin, respond, user, 0u};
+}
+
+void host_sim_attach_dc(GPIO_TypeDef *port, uint16_t pin)
+{
+    sim.dc_port = port;
+    sim.dc_pin = pin;
+}
+
+void host_sim_attach_panel(uint8_t dev, GPIO_TypeDef *busy_port, uint16_t busy_pin)
+{
+    sim.panel_attached = true;
+    sim.panel_dev = dev;
+    sim.busy_port = busy_port;
+    sim.busy_pin = busy_pin;
+    sim.busy_port->IDR &= ~(uint32_t)busy_pin;
+}
+
+void host_sim_panel_busy_ms(uint8_t cmd, uint32_t ms) { sim.panel_busy_ms[cmd] = ms; }
+bool host_sim_panel_busy(void) { return sim.panel_busy; }
+uint32_t host_sim_panel_busy_violations(void) { return sim.panel_violations; }
+void host_sim_set_exti(void (*fn)(uint16_t pin)) { sim.exti = fn; }
+
+/* ------------------------------- Wire log ------------------------------- */
+
+const host_sim_wire_byte *host_sim_wire(uint32_t *count)
+{
+    *count = sim.wire_count;
+    return sim.wire;
+}
+
+void host_sim_wire_clear(void)
+{
+    sim.wire_count = 0u;
+}
+
+uint32_t host_sim_decode(uint8_t dev, uint32_t from, host_sim_command *out, uint32_t max,
+                         uint8_t *data, uint32_t data_cap)
+{
+    uint32_t n = 0u;
+    uint32_t used = 0u;
+    for (uint32_t i = from; i < sim.wire_count; ++i)
+    {
+        const host_sim_wire_byte *w = &sim.wire[i];
+        if (w->dev != dev)
+            continue;
+        if (w->dc == 0u)
+        {
+            if (n == max)
+                break;
+            out[n++] = (host_sim_command){w->t_ns, w->byte, used, 0u};
+            continue;
+        }
+        if (n == 0u || used == data_cap)
+            continue; /* data before the first command, or no room */
+        data[used++] = w->byte;
+        out[n - 1u].len++;
+    }
+    return n;
+}
+
+/* ---------------------------- Fault injection ---------------------------- */
+
+void host_sim_fault_lose_completion(uint32_t n) { sim.fault_lose = n; }
+void host_sim_fault_refuse_dma(uint32_t n) { sim.fault_refuse = n; }
+void host_sim_fault_error_irq(uint32_t n) { sim.fault_error = n; }
+void host_sim_fault_stall_poll(uint32_t n) { sim.fault_stall = n; }
+
+/* ----------------------------- Baseline model ----------------------------- */
+
+void host_sim_set_legacy_bsy_spin(bool enable, uint32_t tail_ns)
+{
+    sim.legacy_spin = enable;
+    sim.legacy_tail_ns = tail_ns;
+}
+
+static bool sim_is_cs(const GPIO_TypeDef *port, uint16_t pin)
+{
+    for (uint8_t i = 0; i < HOST_SIM_MAX_DEVICES; ++i)
+    {
+        if (sim.devices[i].used && sim.devices[i].cs_port == port && (sim.devices[i].cs_pin & pin))
+            return true;
+    }
+    return false;
+}
+
+/* t0 = HAL_GetTick(); while (__HAL_SPI_GET_FLAG(spi, SPI_FLAG_BSY)) { if (HAL_GetTick() - t0 > 2) break; } */
+static void sim_legacy_spin(void)
+{
+    sim.legacy_armed = false;
+    const uint32_t t0 = host_sim_tick_ms();
+    for (;;)
+    {
+        sim.now_ns += HOST_SIM_COST_FLAG_NS;
+        if (sim.now_ns >= sim.legacy_bsy_until)
+            break;
+        if (host_sim_tick_ms() - t0 > 2u)
+            break;
+    }
+}
+
+/* ------------------------------ Port hooks ------------------------------ */
+
+static HAL_StatusTypeDef sim_start_dma(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint8_t *rx, uint16_t len, bool txrx)
+{
+    host_sim_spend_ns(HOST_SIM_COST_DMA_START_NS);
+
+    if (sim.fault_refuse)
+    {
+        sim.fault_refuse--;
+        return HAL_ERROR;
+    }
+
+    const int idx = sim_spi_index(hspi);
+    sim_xfer *x = &sim.xfer[idx];
+    if (x->active)
+    {
+        sim.stats.dma_overlaps++;
+        return HAL_BUSY;
+    }
+
+    sim.stats.dma_starts++;
+    const uint8_t dev = sim_selected_device();
+    *x = (sim_xfer){true, txrx, false, hspi, tx, rx, len, 0u, sim.now_ns, sim_byte_ns(hspi), dev, sim_dc_level()};
+    if (dev != HOST_SIM_NO_DEVICE)
+        sim.devices[dev].rx_index = 0u;
+
+    if (sim.fault_lose)
+    {
+        sim.fault_lose--;
+        x->lost = true;
+        sim.stats.lost++;
+        return HAL_OK;
+    }
+
+    const uint64_t end = sim.now_ns + x->byte_ns * len;
+    if (sim.fault_error)
+    {
+        sim.fault_error--;
+        sim_schedule(end, SIM_EV_SPI_ERROR, idx, NULL, NULL);
+        return HAL_OK;
+    }
+    sim_schedule(sim.now_ns + x->byte_ns * (len / 2u), SIM_EV_SPI_HALF, idx, NULL, NULL);
+    sim_schedule(end, SIM_EV_SPI_CPLT, idx, NULL, NULL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef host_sim_spi_tx_dma(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint16_t len)
+{
+    return sim_start_dma(hspi, tx, NULL, len, false);
+}
+
+HAL_StatusTypeDef host_sim_spi_txrx_dma(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint8_t *rx, uint16_t len)
+{
+    return sim_start_dma(hspi, tx, rx, len, true);
+}
+
+HAL_StatusTypeDef host_sim_spi_tx_poll(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint16_t len, uint32_t spins)
+{
+    sim.stats.poll_calls++;
+    if (sim.xfer[sim_spi_index(hspi)].active)
+    {
+        sim.stats.dma_overlaps++;
+        return HAL_BUSY;
+    }
+
+    /* Stalled peripheral: the wait gives up after its bound, or never does (HAL_MAX_DELAY) */
+    if (sim.fault_stall)
+    {
+        sim.fault_stall--;
+        if (spins == HAL_MAX_DELAY)
+            sim.stats.hung_polls++;
+        else
+            sim.now_ns += (uint64_t)spins * HOST_SIM_COST_SPIN_NS;
+        host_sim_poll_irqs();
+        return HAL_TIMEOUT;
+    }
+
+    const uint8_t dev = sim_selected_device();
+    const uint8_t dc = sim_dc_level();
+    const uint64_t byte_ns = sim_byte_ns(hspi);
+    if (dev != HOST_SIM_NO_DEVICE)
+        sim.devices[dev].rx_index = 0u;
+
+    /* The CPU feeds the FIFO the whole time: no interrupt can move the bytes in between */
+    sim.now_ns += HOST_SIM_COST_POLL_NS;
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        sim.now_ns += byte_ns;
+        (void)sim_shift(sim.now_ns, tx[i], dc, dev, false);
+    }
+    host_sim_poll_irqs();
+    return HAL_OK;
+}
+
+void host_sim_spi_apply_regs(SPI_HandleTypeDef *hspi, uint32_t cr1, uint32_t cr2)
+{
+    hspi->Instance->CR1 = cr1 | SPI_CR1_SPE;
+    hspi->Instance->CR2 = cr2;
+    host_sim_spend_ns(HOST_SIM_COST_REGS_NS);
+}
+
+/* Stop the DMA of @p hspi where it is: bytes already clocked out stay in the log */
+static void sim_stop_dma(SPI_HandleTypeDef *hspi)
+{
+    const int idx = sim_spi_index(hspi);
+    sim_xfer *x = &sim.xfer[idx];
+    if (!x->active)
+        return;
+    if (!x->lost)
+    {
+        uint64_t sent = (sim.now_ns - x->start_ns) / x->byte_ns;
+        sim_xfer_log(x, sent < x->bytes ? (uint32_t)sent : x->bytes, sim.now_ns);
+    }
+    sim_cancel(SIM_EV_SPI_HALF, idx);
+    sim_cancel(SIM_EV_SPI_CPLT, idx);
+    sim_cancel(SIM_EV_SPI_ERROR, idx);
+    x->active = false;
+}
+
+void host_sim_spi_recover(SPI_HandleTypeDef *hspi)
+{
+    sim.stats.recoveries++;
+    sim.stats.masked_resets += sim.irq_masked;
+    sim_stop_dma(hspi);
+    /* Abort + DeInit + Init */
+    sim.now_ns += 20u * HOST_SIM_COST_REGS_NS;
+}
+
+void host_sim_spi_abort(SPI_HandleTypeDef *hspi)
+{
+    sim.stats.aborts++;
+    sim.stats.masked_resets += sim.irq_masked;
+    sim_stop_dma(hspi);
+    sim.now_ns += 5u * HOST_SIM_COST_REGS_NS;
+}
+
+void host_sim_spi_quiesce(SPI_HandleTypeDef *hspi)
+{
+    /* DMA request and interrupt enables cleared: the bytes keep going out until the abort,
+       but no half / complete / error interrupt is raised for them */
+    const int idx = sim_spi_index(hspi);
+    sim_cancel(SIM_EV_SPI_HALF, idx);
+    sim_cancel(SIM_EV_SPI_CPLT, idx);
+    sim_cancel(SIM_EV_SPI_ERROR, idx);
+    host_sim_spend_ns(HOST_SIM_COST_REGS_NS);
+}
+
+uint32_t host_sim_tick_ms(void)
+{
+    host_sim_spend_ns(HOST_SIM_COST_TICK_NS);
+    return (uint32_t)(sim.now_ns / HOST_SIM_NS_PER_MS);
+}
+
+uint32_t host_sim_cycles(void)
+{
+    return (uint32_t)(sim.now_ns * (HOST_SIM_CPU_HZ / 1000000u) / 1000u);
+}
+
+uint32_t host_sim_irq_save(void)
+{
+    uint32_t prev = sim.irq_masked;
+    sim.irq_masked = 1u;
+    return prev;
+}
+
+void host_sim_irq_restore(uint32_t state)
+{
+    sim.irq_masked = state;
+    /* Interrupts that became pending while masked are taken right here */
+    host_sim_poll_irqs();
+}
+
+void host_sim_timer_start(void *ctx, uint32_t ms)
+{
+    sim_cancel(SIM_EV_TIMER, -1);
+    sim_schedule(sim.now_ns + (uint64_t)ms * HOST_SIM_NS_PER_MS, SIM_EV_TIMER, -1, NULL, ctx);
+}
+
+uint16_t host_sim_ldrexh(volatile uint16_t *p)
+{
+    sim_res_addr = p;
+    sim_res_epoch = sim.monitor_epoch;
+    sim_res_valid = true;
+    uint16_t v = *p;
+    /* An interrupt may land between LDREX and STREX */
+    host_sim_poll_irqs();
+    return v;
+}
+
+uint32_t host_sim_strexh(uint16_t v, volatile uint16_t *p)
+{
+    bool ok = sim_res_valid && sim_res_addr == p && sim_res_epoch == sim.monitor_epoch;
+    sim_res_valid = false;
+    if (!ok)
+        return 1u;
+    *p = v;
+    return 0u;
+}
+
+uint8_t host_sim_ldrexb(volatile uint8_t *p)
+{
+    sim_res_addr = p;
+    sim_res_epoch = sim.monitor_epoch;
+    sim_res_valid = true;
+    uint8_t v = *p;
+    host_sim_poll_irqs();
+    return v;
+}
+
+uint32_t host_sim_strexb(uint8_t v, volatile uint8_t *p)
+{
+    bool ok = sim_res_valid && sim_res_addr == p && sim_res_epoch == sim.monitor_epoch;
+    sim_res_valid = false;
+    if (!ok)
+        return 1u;
+    *p = v;
+    return 0u;
+}
+
+void host_sim_clrex(void)
+{
+    sim_res_valid = false;
+}
+
+/* --------------------------------- HAL --------------------------------- */
+
+uint32_t HAL_GetTick(void)
+{
+    return host_sim_tick_ms();
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    const uint32_t start = HAL_GetTick();
+    uint32_t wait = Delay;
+    if (wait < HAL_MAX_DELAY)
+        wait += 1u; /* as HAL: at least the requested time */
+    while ((HAL_GetTick() - start) < wait)
+        host_sim_wfi();
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (sim.legacy_armed && PinState == GPIO_PIN_SET && sim_is_cs(GPIOx, GPIO_Pin))
+        sim_legacy_spin();
+    if (PinState == GPIO_PIN_SET)
+        GPIOx->ODR |= GPIO_Pin;
+    else
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    (void)sim_selected_device(); /* conflict check */
+    host_sim_spend_ns(HOST_SIM_COST_GPIO_NS);
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    host_sim_spend_ns(HOST_SIM_COST_GPIO_NS);
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    return host_sim_spi_tx_poll(hspi, pData, Size, Timeout);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+    return HAL_OK;
+}
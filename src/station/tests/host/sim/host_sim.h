@@ -0,0 +1,195 @@
+#pragma once
+
+/**
+ * @file host_sim.h
+ * @brief Host simulation of the STM32 side the station drivers talk to: a virtual clock, GPIO
+ *        ports, an SPI peripheral whose DMA transfers complete through scheduled interrupts,
+ *        a one-shot timer, an EPD panel model (BUSY line) and a wire log of every byte sent.
+ *
+ * Time only advances at the points real code would spend it: port hooks and HAL calls charge a
+ * modelled cost, DMA transfers take len * byte time at the SCLK derived from CR1, __WFI() and
+ * HAL_Delay() sleep until the next event. Interrupts are delivered at those points (never while
+ * masked, never nested), so the manager sees the same preemption pattern as on the target.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32g4xx_hal.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Simulated CPU clock (CYCLES hook, trace stamps, statistics). */
+#define HOST_SIM_CPU_HZ 64000000u
+/** @brief SPI kernel clock (APB1 at 64 MHz, as in app.c). */
+#define HOST_SIM_SPI_KERNEL_HZ 64000000u
+
+/** @brief Modelled CPU cost of the HAL / port calls, ns. */
+#define HOST_SIM_COST_GPIO_NS 30u
+#define HOST_SIM_COST_TICK_NS 100u
+#define HOST_SIM_COST_REGS_NS 100u
+#define HOST_SIM_COST_DMA_START_NS 2000u
+#define HOST_SIM_COST_POLL_NS 500u
+#define HOST_SIM_COST_FLAG_NS 30u
+/** @brief One iteration of a bounded flag wait in a polled segment. */
+#define HOST_SIM_COST_SPIN_NS 60u
+
+/** @brief Devices the sim can tell apart on the wire (by their CS line). */
+#define HOST_SIM_MAX_DEVICES 4
+#define HOST_SIM_NO_DEVICE 0xFFu
+
+    /** @brief One byte seen on MOSI. */
+    typedef struct
+    {
+        uint64_t t_ns; /**< When the byte left the shifter (DMA: at half / complete). */
+        uint8_t byte;
+        uint8_t dc;    /**< DC line level (1 = data). */
+        uint8_t dev;   /**< Device whose CS was asserted, HOST_SIM_NO_DEVICE if none. */
+        uint8_t dma;   /**< 1 = sent by DMA, 0 = polled. */
+    } host_sim_wire_byte;
+
+    /** @brief One decoded command: first byte with DC = 0, then its data bytes (DC = 1). */
+    typedef struct
+    {
+        uint64_t t_ns;  /**< When the command byte was sent. */
+        uint8_t cmd;
+        uint32_t first; /**< Offset of the first data byte in the data buffer given to host_sim_decode(). */
+        uint32_t len;   /**< Number of data bytes. */
+    } host_sim_command;
+
+    /** @brief Answers a TXRX byte: @p index within the transfer, @p tx the byte sent. */
+    typedef uint8_t (*host_sim_responder_fn)(void *user, uint32_t index, uint8_t tx);
+
+    /** @brief Counters of the simulated peripherals. */
+    typedef struct
+    {
+        uint32_t dma_starts;
+        uint32_t dma_overlaps;    /**< DMA started while one was in flight (manager bug). */
+        uint32_t poll_calls;
+        uint32_t hung_polls;      /**< Stalled polled segments with no loop bound (hang on the target). */
+        uint32_t completions;     /**< Completion interrupts raised (TX and TXRX). */
+        uint32_t halves;          /**< Half-transfer interrupts raised. */
+        uint32_t errors;          /**< Error interrupts raised. */
+        uint32_t lost;            /**< Transfers whose interrupts were swallowed (fault). */
+        uint32_t recoveries;      /**< RECOVER hook calls. */
+        uint32_t aborts;          /**< ABORT hook calls. */
+        uint32_t masked_resets;   /**< RECOVER / ABORT called with interrupts masked (HAL waits in there). */
+        uint32_t cs_conflicts;    /**< Two chip selects asserted at once. */
+        uint32_t bytes_without_cs;
+        uint32_t isr_count;       /**< Interrupts taken (all sources). */
+        uint64_t isr_ns_total;    /**< Virtual time spent in interrupts. */
+        uint64_t isr_ns_max;      /**< Longest single interrupt. */
+        uint32_t wfi_count;
+    } host_sim_stats;
+
+    /* ------------------------------ Clock / control ------------------------------ */
+
+    /** @brief Reset the whole simulation (clock, pins, events, wire log, faults, stats). */
+    void host_sim_reset(void);
+    uint64_t host_sim_now_ns(void);
+    /** @brief Advance the virtual clock by @p ns (CPU work) and take due interrupts. */
+    void host_sim_spend_ns(uint64_t ns);
+    /** @brief Take every interrupt due by now (no-op while masked or inside an interrupt). */
+    void host_sim_poll_irqs(void);
+    bool host_sim_in_isr(void);
+    const host_sim_stats *host_sim_get_stats(void);
+
+    /**
+     * @brief Main loop stand-in: call spi_bus_manager_tick_all() every ms and sleep in between,
+     *        until @p done returns true or @p timeout_ms passes.
+     * @return true if @p done became true.
+     */
+    bool host_sim_run_until(bool (*done)(void *user), void *user, uint32_t timeout_ms);
+    /** @brief Same loop for a fixed time. */
+    void host_sim_run_ms(uint32_t ms);
+
+    /** @brief Run @p fn(user) as an interrupt at absolute time @p t_ns. */
+    void host_sim_schedule_irq(uint64_t t_ns, void (*fn)(void *user), void *user);
+
+    /* --------------------------------- Devices --------------------------------- */
+
+    /** @brief Tell the sim which CS line (active low) selects device @p dev on the bus. */
+    void host_sim_attach_device(uint8_t dev, GPIO_TypeDef *cs_port, uint16_t cs_pin,
+                                host_sim_responder_fn respond, void *user);
+    /** @brief DC line used to tag wire bytes (high = data). */
+    void host_sim_attach_dc(GPIO_TypeDef *port, uint16_t pin);
+
+    /**
+     * @brief EPD panel model on device @p dev: BUSY (active high) rises when a command listed with
+     *        host_sim_panel_busy_ms() is received and falls that many ms later; the falling edge
+     *        raises the EXTI callback.
+     */
+    void host_sim_attach_panel(uint8_t dev, GPIO_TypeDef *busy_port, uint16_t busy_pin);
+    void host_sim_panel_busy_ms(uint8_t cmd, uint32_t ms);
+    bool host_sim_panel_busy(void);
+    /** @brief Bytes the panel received while BUSY was high, other than the data of the command
+     *         that raised it (must stay 0). */
+    uint32_t host_sim_panel_busy_violations(void);
+    /** @brief EXTI handler for the BUSY falling edge (the app calls spi_bus_manager_tick_all()). */
+    void host_sim_set_exti(void (*fn)(uint16_t pin));
+
+    /* -------------------------------- Wire log -------------------------------- */
+
+    const host_sim_wire_byte *host_sim_wire(uint32_t *count);
+    void host_sim_wire_clear(void);
+    /**
+     * @brief Split the bytes of @p dev from wire index @p from on into commands; their data bytes
+     *        are copied back to back into @p data (bytes of other devices in between are skipped).
+     * @return Number of commands (at most @p max).
+     */
+    uint32_t host_sim_decode(uint8_t dev, uint32_t from, host_sim_command *out, uint32_t max,
+                             uint8_t *data, uint32_t data_cap);
+
+    /* ----------------------------- Fault injection ----------------------------- */
+
+    /** @brief The next @p n DMA transfers never raise their interrupts (lost completion). */
+    void host_sim_fault_lose_completion(uint32_t n);
+    /** @brief The next @p n DMA starts are refused by HAL (HAL_ERROR). */
+    void host_sim_fault_refuse_dma(uint32_t n);
+    /** @brief The next @p n DMA transfers end with the SPI error interrupt. */
+    void host_sim_fault_error_irq(uint32_t n);
+    /** @brief The next @p n polled segments stall (TXE never sets): they fail after their spin bound. */
+    void host_sim_fault_stall_poll(uint32_t n);
+
+    /* ------------------------------ Baseline model ------------------------------ */
+
+    /**
+     * @brief Re-create the CS release of the old completion path for before/after figures: when a
+     *        completion interrupt deasserts a chip select, first spin on SPI_FLAG_BSY against
+     *        HAL_GetTick() with the 2 ms guard, as the code did before it relied on HAL's own BSY wait.
+     * @param enable  Model the spin.
+     * @param tail_ns How long BSY stays set after the completion interrupt (0 = HAL already waited
+     *                for it in normal DMA mode; a few byte times = FIFO still draining).
+     */
+    void host_sim_set_legacy_bsy_spin(bool enable, uint32_t tail_ns);
+
+    /* ------------------------- Port hooks (glue header) ------------------------- */
+
+    HAL_StatusTypeDef host_sim_spi_tx_dma(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint16_t len);
+    HAL_StatusTypeDef host_sim_spi_txrx_dma(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint8_t *rx, uint16_t len);
+    HAL_StatusTypeDef host_sim_spi_tx_poll(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint16_t len, uint32_t spins);
+    void host_sim_spi_apply_regs(SPI_HandleTypeDef *hspi, uint32_t cr1, uint32_t cr2);
+    void host_sim_spi_recover(SPI_HandleTypeDef *hspi);
+    void host_sim_spi_abort(SPI_HandleTypeDef *hspi);
+    void host_sim_spi_quiesce(SPI_HandleTypeDef *hspi);
+    uint32_t host_sim_tick_ms(void);
+    uint32_t host_sim_cycles(void);
+    uint32_t host_sim_irq_save(void);
+    void host_sim_irq_restore(uint32_t state);
+    /** @brief One-shot for spi_bus_manager_set_timer(); @p ctx is the manager. */
+    void host_sim_timer_start(void *ctx, uint32_t ms);
+
+    /* Exclusive monitor: any interrupt entry or exit between LDREX and STREX fails the STREX */
+    uint16_t host_sim_ldrexh(volatile uint16_t *p);
+    uint32_t host_sim_strexh(uint16_t v, volatile uint16_t *p);
+    uint8_t host_sim_ldrexb(volatile uint8_t *p);
+    uint32_t host_sim_strexb(uint8_t v, volatile uint8_t *p);
+    void host_sim_clrex(void);
+    void host_sim_wfi(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,455 @@
+/* Multi-context backend of the host sim: the same port hooks as host_sim.c, for stress tests that
+   run several thread contexts against the completion interrupt.
+
+   The target is a single core, so the model is too: threads take turns on one CPU baton and only
+   the holder runs. At every preemption point (port hooks, exclusives, interrupt unmask) the holder
+   may be switched out for another thread, at random; a completion interrupt that is due runs right
+   there on the holder's stack, to completion, as it would on the core. Nothing switches or
+   interrupts while PRIMASK is set or inside the interrupt. Every switch and every interrupt entry
+   and exit clears the exclusive monitor, so a STREX fails exactly when it would on the target. */
+
+#include "host_sim.h"
+#include "host_sim_mt.h"
+#include "shared/drivers/spi_bus_manager.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+GPIO_TypeDef host_sim_gpio[4];
+SPI_TypeDef host_sim_spi[4];
+
+#define MT_MAX_CONTEXTS 8
+/* A switch at one preemption point in MT_SWITCH_ONE_IN */
+#define MT_SWITCH_ONE_IN 3u
+
+static pthread_mutex_t mt_cpu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mt_turn_cv = PTHREAD_COND_INITIALIZER;
+
+static struct
+{
+    int turn;
+    bool alive[MT_MAX_CONTEXTS];
+    uint32_t primask;
+    uint32_t in_isr;
+    uint32_t epoch;
+    uint64_t rng;
+    uint64_t steps;
+    /* DMA in flight */
+    bool dma_active;
+    bool dma_txrx;
+    bool dma_half_done;
+    uint64_t dma_half_at;
+    uint64_t dma_done_at;
+    SPI_HandleTypeDef *dma_hspi;
+    host_sim_mt_stats stats;
+} mt;
+
+static __thread int mt_self = -1;
+
+static const volatile void *mt_res_addr;
+static uint32_t mt_res_epoch;
+static bool mt_res_valid;
+
+static uint32_t mt_rand(void)
+{
+    /* xorshift64* */
+    mt.rng ^= mt.rng >> 12;
+    mt.rng ^= mt.rng << 25;
+    mt.rng ^= mt.rng >> 27;
+    return (uint32_t)((mt.rng * 2685821657736338717ull) >> 32);
+}
+
+/* --------------------------------- Baton --------------------------------- */
+
+static void mt_wait_turn(void)
+{
+    while (mt.turn != mt_self)
+        pthread_cond_wait(&mt_turn_cv, &mt_cpu);
+}
+
+/* Hand the CPU to another live context (a context switch) */
+static void mt_switch(void)
+{
+    int candidates[MT_MAX_CONTEXTS];
+    int n = 0;
+    for (int i = 0; i < MT_MAX_CONTEXTS; ++i)
+    {
+        if (mt.alive[i] && i != mt_self)
+            candidates[n++] = i;
+    }
+    if (n == 0)
+        return;
+
+    mt.stats.switches++;
+    mt.epoch++;
+    mt.turn = candidates[mt_rand() % (uint32_t)n];
+    pthread_cond_broadcast(&mt_turn_cv);
+    mt_wait_turn();
+    mt.epoch++;
+}
+
+/* ------------------------------- Interrupts ------------------------------- */
+
+static void mt_take_irqs(void)
+{
+    if (!mt.dma_active)
+        return;
+
+    if (!mt.dma_half_done && mt.steps >= mt.dma_half_at)
+    {
+        mt.dma_half_done = true;
+        mt.in_isr++;
+        mt.epoch++;
+        if (mt.dma_txrx)
+            spi_bus_manager_dispatch_txrx_half(mt.dma_hspi);
+        else
+            spi_bus_manager_dispatch_tx_half(mt.dma_hspi);
+        mt.epoch++;
+        mt.in_isr--;
+    }
+
+    if (mt.dma_active && mt.steps >= mt.dma_done_at)
+    {
+        mt.dma_active = false;
+        mt.stats.interrupts++;
+        mt.in_isr++;
+        mt.epoch++;
+        if (mt.dma_txrx)
+            spi_bus_manager_dispatch_txrx_cplt(mt.dma_hspi);
+        else
+            spi_bus_manager_dispatch_tx_cplt(mt.dma_hspi);
+        mt.epoch++;
+        mt.in_isr--;
+    }
+}
+
+/* Preemption point: interrupts first, then maybe a context switch */
+static void mt_point(void)
+{
+    mt.steps++;
+    if (mt.in_isr || mt.primask)
+        return;
+    mt_take_irqs();
+    if (mt_rand() % MT_SWITCH_ONE_IN == 0u)
+        mt_switch();
+}
+
+/* -------------------------------- Contexts -------------------------------- */
+
+void host_sim_mt_reset(uint64_t seed)
+{
+    GPIO_TypeDef zero_gpio = {0};
+    for (int i = 0; i < 4; ++i)
+    {
+        host_sim_gpio[i] = zero_gpio;
+        host_sim_gpio[i].ODR = 0xFFFFu;
+    }
+    memset(host_sim_spi, 0, sizeof(host_sim_spi));
+    memset(&mt, 0, sizeof(mt));
+    mt.rng = seed ? seed : 1u;
+    mt_res_valid = false;
+
+    /* The caller is context 0 and holds the CPU */
+    mt_self = 0;
+    mt.alive[0] = true;
+    mt.turn = 0;
+    pthread_mutex_lock(&mt_cpu);
+}
+
+void host_sim_mt_finish(void)
+{
+    mt.alive[mt_self] = false;
+    pthread_mutex_unlock(&mt_cpu);
+}
+
+static bool host_sim_mt_others_alive(void);
+
+typedef struct
+{
+    int id;
+    void (*fn)(void *user);
+    void *user;
+} mt_start;
+
+static void *mt_thread_main(void *arg)
+{
+    mt_start *s = (mt_start *)arg;
+    mt_self = s->id;
+    pthread_mutex_lock(&mt_cpu);
+    mt_wait_turn();
+    mt.epoch++;
+
+    s->fn(s->user);
+
+    /* Leave: hand the CPU to someone still running */
+    mt.alive[mt_self] = false;
+    for (int i = 0; i < MT_MAX_CONTEXTS; ++i)
+    {
+        if (mt.alive[i])
+        {
+            mt.turn = i;
+            break;
+        }
+    }
+    pthread_cond_broadcast(&mt_turn_cv);
+    pthread_mutex_unlock(&mt_cpu);
+    free(s);
+    return NULL;
+}
+
+int host_sim_mt_spawn(void (*fn)(void *user), void *user, pthread_t *thread)
+{
+    for (int i = 1; i < MT_MAX_CONTEXTS; ++i)
+    {
+        if (mt.alive[i])
+            continue;
+        mt_start *s = malloc(sizeof(*s));
+        if (!s)
+            return -1;
+        *s = (mt_start){i, fn, user};
+        mt.alive[i] = true;
+        if (pthread_create(thread, NULL, mt_thread_main, s) != 0)
+        {
+            mt.alive[i] = false;
+            free(s);
+            return -1;
+        }
+        return i;
+    }
+    return -1;
+}
+
+void host_sim_mt_wait(const pthread_t *threads, int count)
+{
+    /* Keep yielding until every other context has returned, then collect the threads */
+    while (host_sim_mt_others_alive())
+        mt_switch();
+    pthread_mutex_unlock(&mt_cpu);
+    for (int i = 0; i < count; ++i)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_lock(&mt_cpu);
+}
+
+static bool host_sim_mt_others_alive(void)
+{
+    for (int i = 0; i < MT_MAX_CONTEXTS; ++i)
+    {
+        if (mt.alive[i] && i != mt_self)
+            return true;
+    }
+    return false;
+}
+
+void host_sim_mt_point(void)
+{
+    mt_point();
+}
+
+bool host_sim_in_isr(void)
+{
+    return mt.in_isr != 0u;
+}
+
+const host_sim_mt_stats *host_sim_mt_get_stats(void)
+{
+    return &mt.stats;
+}
+
+/* ------------------------------- Port hooks ------------------------------- */
+
+static HAL_StatusTypeDef mt_start_dma(SPI_HandleTypeDef *hspi, uint16_t len, bool txrx)
+{
+    if (mt.dma_active)
+    {
+        mt.stats.dma_overlaps++;
+        return HAL_BUSY;
+    }
+    mt.stats.dma_starts++;
+    mt.dma_active = true;
+    mt.dma_txrx = txrx;
+    mt.dma_hspi = hspi;
+    mt.dma_half_done = false;
+    /* Completion after a random number of preemption points: lands anywhere in the producers */
+    const uint64_t dur = 1u + (mt_rand() % 24u) + len / 8u;
+    mt.dma_half_at = mt.steps + dur / 2u;
+    mt.dma_done_at = mt.steps + dur;
+    mt_point();
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef host_sim_spi_tx_dma(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint16_t len)
+{
+    (void)tx;
+    return mt_start_dma(hspi, len, false);
+}
+
+HAL_StatusTypeDef host_sim_spi_txrx_dma(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint8_t *rx, uint16_t len)
+{
+    (void)tx;
+    memset(rx, 0, len);
+    return mt_start_dma(hspi, len, true);
+}
+
+HAL_StatusTypeDef host_sim_spi_tx_poll(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint16_t len, uint32_t spins)
+{
+    (void)hspi;
+    (void)tx;
+    (void)len;
+    (void)spins;
+    mt_point();
+    return HAL_OK;
+}
+
+void host_sim_spi_apply_regs(SPI_HandleTypeDef *hspi, uint32_t cr1, uint32_t cr2)
+{
+    hspi->Instance->CR1 = cr1 | SPI_CR1_SPE;
+    hspi->Instance->CR2 = cr2;
+    mt_point();
+}
+
+void host_sim_spi_recover(SPI_HandleTypeDef *hspi)
+{
+    (void)hspi;
+    mt.dma_active = false;
+}
+
+void host_sim_spi_abort(SPI_HandleTypeDef *hspi)
+{
+    (void)hspi;
+    mt.dma_active = false;
+}
+
+void host_sim_spi_quiesce(SPI_HandleTypeDef *hspi)
+{
+    (void)hspi;
+    mt.dma_active = false;
+}
+
+uint32_t host_sim_tick_ms(void)
+{
+    mt_point();
+    return (uint32_t)(mt.steps / 1000u);
+}
+
+uint32_t host_sim_cycles(void)
+{
+    return (uint32_t)mt.steps;
+}
+
+uint32_t host_sim_irq_save(void)
+{
+    uint32_t prev = mt.primask;
+    mt.primask = 1u;
+    return prev;
+}
+
+void host_sim_irq_restore(uint32_t state)
+{
+    mt.primask = state;
+    mt_point();
+}
+
+void host_sim_timer_start(void *ctx, uint32_t ms)
+{
+    (void)ctx;
+    (void)ms;
+}
+
+uint16_t host_sim_ldrexh(volatile uint16_t *p)
+{
+    mt_res_addr = p;
+    mt_res_epoch = mt.epoch;
+    mt_res_valid = true;
+    uint16_t v = *p;
+    mt_point();
+    return v;
+}
+
+uint32_t host_sim_strexh(uint16_t v, volatile uint16_t *p)
+{
+    bool ok = mt_res_valid && mt_res_addr == p && mt_res_epoch == mt.epoch;
+    mt_res_valid = false;
+    if (!ok)
+    {
+        mt.stats.strex_failures++;
+        return 1u;
+    }
+    *p = v;
+    return 0u;
+}
+
+uint8_t host_sim_ldrexb(volatile uint8_t *p)
+{
+    mt_res_addr = p;
+    mt_res_epoch = mt.epoch;
+    mt_res_valid = true;
+    uint8_t v = *p;
+    mt_point();
+    return v;
+}
+
+uint32_t host_sim_strexb(uint8_t v, volatile uint8_t *p)
+{
+    bool ok = mt_res_valid && mt_res_addr == p && mt_res_epoch == mt.epoch;
+    mt_res_valid = false;
+    if (!ok)
+    {
+        mt.stats.strex_failures++;
+        return 1u;
+    }
+    *p = v;
+    return 0u;
+}
+
+void host_sim_clrex(void)
+{
+    mt_res_valid = false;
+}
+
+void host_sim_wfi(void)
+{
+    /* Nothing else to do: let time pass until the completion lands */
+    if (mt.dma_active && mt.steps < mt.dma_done_at)
+        mt.steps = mt.dma_done_at - 1u;
+    mt_point();
+}
+
+/* --------------------------------- HAL --------------------------------- */
+
+uint32_t HAL_GetTick(void)
+{
+    return host_sim_tick_ms();
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    const uint32_t start = HAL_GetTick();
+    while ((HAL_GetTick() - start) < Delay)
+        host_sim_wfi();
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET)
+        GPIOx->ODR |= GPIO_Pin;
+    else
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    mt_point();
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    mt_point();
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    return host_sim_spi_tx_poll(hspi, pData, Size, Timeout);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+    return HAL_OK;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file host_sim_mt.h
+ * @brief Several thread contexts on one simulated core (sim/host_sim_mt.c): contexts are switched at
+ *        random at the port-hook preemption points, DMA completions interrupt whichever context runs.
+ *        Link instead of host_sim.c.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct
+    {
+        uint64_t switches;       /**< Context switches. */
+        uint64_t interrupts;     /**< Completion interrupts taken. */
+        uint64_t strex_failures; /**< STREX that lost its reservation. */
+        uint32_t dma_starts;
+        uint32_t dma_overlaps;   /**< DMA started while one was in flight (manager bug). */
+    } host_sim_mt_stats;
+
+    /** @brief Reset the model; the calling thread becomes context 0 and owns the CPU. */
+    void host_sim_mt_reset(uint64_t seed);
+    /** @brief Start @p fn(user) as another thread context. @return Context id, -1 if none left. */
+    int host_sim_mt_spawn(void (*fn)(void *user), void *user, pthread_t *thread);
+    /** @brief Context 0: run the other contexts to their end and join @p threads. */
+    void host_sim_mt_wait(const pthread_t *threads, int count);
+    /** @brief Context 0: release the CPU at the end of the test. */
+    void host_sim_mt_finish(void);
+    /** @brief Explicit preemption point (busy loops of the test contexts). */
+    void host_sim_mt_point(void);
+    const host_sim_mt_stats *host_sim_mt_get_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,68 @@
+#include "host_station.h"
+#include <string.h>
+
+/* Manager currently in the registry (the next setup takes its SPI2 slot) */
+static spi_bus_manager *host_station_registered;
+
+static void host_station_exti(uint16_t pin)
+{
+    if (pin == HOST_STATION_DISP_BUSY_PIN)
+        spi_bus_manager_tick_all();
+}
+
+void host_station_setup(host_station *st, uint16_t chunk, bool priority)
+{
+    host_sim_reset();
+
+    if (host_station_registered)
+        spi_bus_manager_unregister(host_station_registered);
+    memset(st, 0, sizeof(*st));
+
+    /* hspi2 as generated by CubeMX: master, mode 0, 8-bit, /32 */
+    st->hspi.Instance = SPI2;
+    st->hspi.Init.BaudRatePrescaler = 4u << SPI_CR1_BR_Pos;
+    SPI2->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | (4u << SPI_CR1_BR_Pos) | SPI_CR1_SPE;
+    SPI2->CR2 = (7u << SPI_CR2_DS_Pos) | SPI_CR2_FRXTH;
+
+    st->mgr = spi_bus_manager_create(&st->hspi, st->storage, (uint16_t)(sizeof(st->storage) / sizeof(st->storage[0])));
+    if (priority)
+        spi_bus_manager_set_priority_queue(&st->mgr, st->prio_storage, (uint16_t)(sizeof(st->prio_storage) / sizeof(st->prio_storage[0])));
+    spi_bus_manager_set_chunk_size(&st->mgr, chunk);
+    spi_bus_manager_set_timer(&st->mgr, host_sim_timer_start, &st->mgr);
+    spi_bus_manager_register(&st->mgr);
+    host_station_registered = &st->mgr;
+
+    st->epd = epd3in7_driver_create((epd3in7_driver_pins){
+                                        .reset_port = HOST_STATION_DISP_RST_PORT,
+                                        .reset_pin = HOST_STATION_DISP_RST_PIN,
+                                        .dc_port = HOST_STATION_DISP_DC_PORT,
+                                        .dc_pin = HOST_STATION_DISP_DC_PIN,
+                                        .busy_port = HOST_STATION_DISP_BUSY_PORT,
+                                        .busy_pin = HOST_STATION_DISP_BUSY_PIN,
+                                        .cs_port = HOST_STATION_DISP_CS_PORT,
+                                        .cs_pin = HOST_STATION_DISP_CS_PIN},
+                                    &st->hspi, true);
+
+    host_sim_attach_device(HOST_STATION_DEV_EPD, HOST_STATION_DISP_CS_PORT, HOST_STATION_DISP_CS_PIN, NULL, NULL);
+    host_sim_attach_dc(HOST_STATION_DISP_DC_PORT, HOST_STATION_DISP_DC_PIN);
+    host_sim_attach_panel(HOST_STATION_DEV_EPD, HOST_STATION_DISP_BUSY_PORT, HOST_STATION_DISP_BUSY_PIN);
+    host_sim_set_exti(host_station_exti);
+
+    /* SSD1677 timings, roughly: SW reset, RAM auto-fill, refresh */
+    host_sim_panel_busy_ms(0x12, 5u);
+    host_sim_panel_busy_ms(0x46, 20u);
+    host_sim_panel_busy_ms(0x47, 20u);
+    host_sim_panel_busy_ms(0x20, HOST_STATION_REFRESH_MS);
+}
+
+bool host_station_idle(void *user)
+{
+    host_station *st = (host_station *)user;
+    return spi_bus_manager_is_idle(&st->mgr) && !host_sim_panel_busy();
+}
+
+void host_station_init_epd(host_station *st)
+{
+    (void)epd3in7_driver_init_1_gray_dma(&st->epd, &st->mgr);
+    (void)host_sim_run_until(host_station_idle, st, 5000u);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * @file host_station.h
+ * @brief The station's SPI2 wiring on the host sim: bus manager set up as in app_init() (both lanes,
+ *        512-unit chunks, one-shot timer, registry), EPD and BME280 on their chip selects, BUSY
+ *        falling edge routed to spi_bus_manager_tick_all() as in app_gpio_exti_callback().
+ */
+
+#include "host_sim.h"
+#include "shared/drivers/spi_bus_manager.h"
+#include "app/drivers/epd3in7_driver.h"
+
+#define HOST_STATION_DEV_EPD 0u
+#define HOST_STATION_DEV_BME 1u
+
+#define HOST_STATION_DISP_CS_PORT GPIOB
+#define HOST_STATION_DISP_CS_PIN GPIO_PIN_0
+#define HOST_STATION_DISP_DC_PORT GPIOB
+#define HOST_STATION_DISP_DC_PIN GPIO_PIN_1
+#define HOST_STATION_DISP_RST_PORT GPIOB
+#define HOST_STATION_DISP_RST_PIN GPIO_PIN_2
+#define HOST_STATION_DISP_BUSY_PORT GPIOB
+#define HOST_STATION_DISP_BUSY_PIN GPIO_PIN_3
+#define HOST_STATION_BME_CS_PORT GPIOA
+#define HOST_STATION_BME_CS_PIN GPIO_PIN_4
+
+/** @brief Panel refresh time the fixture programs for DISPLAY_UPDATE_SEQUENCE (0x20), ms. */
+#define HOST_STATION_REFRESH_MS 300u
+
+typedef struct
+{
+    SPI_HandleTypeDef hspi;
+    spi_bus_transaction storage[64];     /* app_spiq_storage */
+    spi_bus_transaction prio_storage[8]; /* app_spiq_prio_storage */
+    spi_bus_manager mgr;
+    epd3in7_driver_handle epd;
+} host_station;
+
+/**
+ * @brief Reset the sim and bring up the station bus.
+ * @param st       Fixture (static storage: the manager and handles are kept by address).
+ * @param chunk    Chunk size in units (app: 512, 0 = no chunking).
+ * @param priority Attach the high-priority lane (app: yes).
+ */
+void host_station_setup(host_station *st, uint16_t chunk, bool priority);
+
+/** @brief Queue the 1-gray init program and run it to completion (panel ready). */
+void host_station_init_epd(host_station *st);
+
+/** @brief True once the manager is idle and the panel is not BUSY. */
+bool host_station_idle(void *st);
@@ -0,0 +1,53 @@
+#pragma once
+
+/* Minimal assertion helpers of the host tests: a failed check prints its location and marks the
+   test failed, the test keeps running so one run reports every broken expectation. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static int host_test_failures;
+
+#define CHECK(cond)                                                                \
+    do                                                                             \
+    {                                                                              \
+        if (!(cond))                                                               \
+        {                                                                          \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                                  \
+        }                                                                          \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                  \
+    do                                                                                  \
+    {                                                                                   \
+        long long _a = (long long)(a), _b = (long long)(b);                             \
+        if (_a != _b)                                                                   \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, \
+                    __LINE__, #a, #b, _a, _b);                                          \
+            host_test_failures++;                                                       \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_MEM(a, b, n)                                                                 \
+    do                                                                                     \
+    {                                                                                      \
+        if (memcmp((a), (b), (n)) != 0)                                                    \
+        {                                                                                  \
+            fprintf(stderr, "%s:%d: CHECK_MEM(%s, %s, %s) failed\n", __FILE__, __LINE__, #a, \
+                    #b, #n);                                                               \
+            host_test_failures++;                                                          \
+        }                                                                                  \
+    } while (0)
+
+#define RUN_TEST(fn)                                    \
+    do                                                  \
+    {                                                   \
+        int _before = host_test_failures;               \
+        fn();                                           \
+        printf("%-48s %s\n", #fn, host_test_failures == _before ? "ok" : "FAILED"); \
+    } while (0)
+
+#define HOST_TEST_RESULT() (host_test_failures == 0 ? 0 : 1)
@@ -0,0 +1,252 @@
+/* Frame diff kernel of the EPD adapter (epd3in7_lvgl_adapter_diff_i1 / count_flips): bounding box and
+   flip counts checked pixel by pixel against a reference, then timed on 16.8 KB I1 frames.
+   The adapter's kernels are static, so the adapter source is compiled into this test. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+#include "app/drivers/epd3in7_lvgl_adapter.c"
+#include <stdlib.h>
+#include <time.h>
+
+/* LVGL frame at LV_DISPLAY_ROTATION_90: 480 x 280 logical, 60 bytes per row */
+#define LOG_W EPD3IN7_HEIGHT
+#define LOG_H EPD3IN7_WIDTH
+#define STRIDE (LOG_W / 8)
+#define FRAME_BYTES (STRIDE * LOG_H)
+
+static uint8_t cur[FRAME_BYTES], prev[FRAME_BYTES];
+
+static bool pixel(const uint8_t *f, uint32_t stride, int32_t x, int32_t y)
+{
+    return (f[(size_t)y * stride + (x >> 3)] >> (7 - (x & 7))) & 1u;
+}
+
+static void flip(uint8_t *f, uint32_t stride, int32_t x, int32_t y)
+{
+    f[(size_t)y * stride + (x >> 3)] ^= (uint8_t)(0x80u >> (x & 7));
+}
+
+/* Per-pixel bounding box of the differences inside w x h */
+static bool diff_reference(const uint8_t *a, const uint8_t *b, int32_t w, int32_t h, uint32_t stride, lv_area_t *box)
+{
+    bool any = false;
+    lv_area_set(box, w, h, -1, -1);
+    for (int32_t y = 0; y < h; ++y)
+    {
+        for (int32_t x = 0; x < w; ++x)
+        {
+            if (pixel(a, stride, x, y) == pixel(b, stride, x, y))
+                continue;
+            any = true;
+            box->x1 = LV_MIN(box->x1, x);
+            box->y1 = LV_MIN(box->y1, y);
+            box->x2 = LV_MAX(box->x2, x);
+            box->y2 = LV_MAX(box->y2, y);
+        }
+    }
+    return any;
+}
+
+static void check_against_reference(int32_t w, int32_t h, uint32_t stride)
+{
+    lv_area_t got = {0}, want = {0};
+    const bool d = epd3in7_lvgl_adapter_diff_i1(cur, prev, w, h, stride, &got);
+    const bool r = diff_reference(cur, prev, w, h, stride, &want);
+    CHECK_EQ(d, r);
+    if (!d || !r)
+        return;
+    CHECK_EQ(got.x1, want.x1);
+    CHECK_EQ(got.y1, want.y1);
+    CHECK_EQ(got.x2, want.x2);
+    CHECK_EQ(got.y2, want.y2);
+
+    /* Flip count and its split over the regions */
+    uint32_t regions[EPD3IN7_LVGL_ADAPTER_REGIONS] = {0}, ref_regions[EPD3IN7_LVGL_ADAPTER_REGIONS] = {0};
+    const uint32_t total = epd3in7_lvgl_adapter_count_flips(cur, prev, h, stride, &got, regions);
+    uint32_t ref_total = 0;
+    const int32_t words = (int32_t)((stride + 3u) / 4u);
+    for (int32_t y = 0; y < h; ++y)
+    {
+        for (int32_t x = 0; x < w; ++x)
+        {
+            if (pixel(cur, stride, x, y) == pixel(prev, stride, x, y))
+                continue;
+            ref_total++;
+            ref_regions[(y * EPD3IN7_LVGL_ADAPTER_REGION_ROWS / h) * EPD3IN7_LVGL_ADAPTER_REGION_COLS +
+                        (x / 32) * EPD3IN7_LVGL_ADAPTER_REGION_COLS / words]++;
+        }
+    }
+    CHECK_EQ(total, ref_total);
+    CHECK_MEM(regions, ref_regions, sizeof(regions));
+}
+
+static void random_frame(uint8_t *f, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        f[i] = (uint8_t)rand();
+}
+
+static void test_identical(void)
+{
+    random_frame(prev, FRAME_BYTES);
+    memcpy(cur, prev, FRAME_BYTES);
+    lv_area_t box;
+    CHECK(!epd3in7_lvgl_adapter_diff_i1(cur, prev, LOG_W, LOG_H, STRIDE, &box));
+}
+
+static void test_single_pixels(void)
+{
+    random_frame(prev, FRAME_BYTES);
+    for (int i = 0; i < 2000; ++i)
+    {
+        memcpy(cur, prev, FRAME_BYTES);
+        const int32_t x = rand() % LOG_W, y = rand() % LOG_H;
+        flip(cur, STRIDE, x, y);
+        lv_area_t box = {0};
+        CHECK(epd3in7_lvgl_adapter_diff_i1(cur, prev, LOG_W, LOG_H, STRIDE, &box));
+        CHECK(box.x1 == x && box.x2 == x && box.y1 == y && box.y2 == y);
+    }
+    /* Word edges: first and last pixel of every 32-bit word of a row */
+    for (int32_t x = 0; x < LOG_W; x += 31)
+    {
+        memcpy(cur, prev, FRAME_BYTES);
+        flip(cur, STRIDE, x, 7);
+        check_against_reference(LOG_W, LOG_H, STRIDE);
+    }
+}
+
+static void test_random_changes(void)
+{
+    for (int i = 0; i < 300; ++i)
+    {
+        random_frame(prev, FRAME_BYTES);
+        memcpy(cur, prev, FRAME_BYTES);
+        const int n = 1 + rand() % 40;
+        for (int k = 0; k < n; ++k)
+            flip(cur, STRIDE, rand() % LOG_W, rand() % LOG_H);
+        check_against_reference(LOG_W, LOG_H, STRIDE);
+    }
+}
+
+static void test_padding_ignored(void)
+{
+    /* 470 px in 60-byte rows: the last 10 bits of a row are padding, not pixels */
+    const int32_t w = 470;
+    random_frame(prev, FRAME_BYTES);
+    memcpy(cur, prev, FRAME_BYTES);
+    flip(cur, STRIDE, 475, 3);
+    lv_area_t box = {0};
+    CHECK(!epd3in7_lvgl_adapter_diff_i1(cur, prev, w, LOG_H, STRIDE, &box));
+    flip(cur, STRIDE, 469, 9);
+    check_against_reference(w, LOG_H, STRIDE);
+}
+
+static void test_odd_stride(void)
+{
+    /* Panel orientation (LV_DISPLAY_ROTATION_0): 280 px in 35-byte rows, the last word of a row is
+       3 bytes; then 275 px, whose last 5 bits are padding */
+    const int32_t w = EPD3IN7_WIDTH, h = EPD3IN7_HEIGHT;
+    const uint32_t stride = EPD3IN7_WIDTH / 8;
+    random_frame(prev, FRAME_BYTES);
+    memcpy(cur, prev, FRAME_BYTES);
+    lv_area_t box = {0};
+    CHECK(!epd3in7_lvgl_adapter_diff_i1(cur, prev, w, h, stride, &box));
+
+    for (int32_t x = w - 1; x >= 0; x -= 29)
+    {
+        memcpy(cur, prev, FRAME_BYTES);
+        flip(cur, stride, x, 300);
+        check_against_reference(w, h, stride);
+    }
+    for (int i = 0; i < 200; ++i)
+    {
+        memcpy(cur, prev, FRAME_BYTES);
+        const int n = 1 + rand() % 40;
+        for (int k = 0; k < n; ++k)
+            flip(cur, stride, rand() % w, rand() % h);
+        check_against_reference(w, h, stride);
+    }
+
+    memcpy(cur, prev, FRAME_BYTES);
+    flip(cur, stride, 277, 5);
+    CHECK(!epd3in7_lvgl_adapter_diff_i1(cur, prev, 275, h, stride, &box));
+    flip(cur, stride, 274, 40);
+    check_against_reference(275, h, stride);
+}
+
+static double host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static volatile uint32_t sink;
+
+static double time_diff(void)
+{
+    const int reps = 2000;
+    lv_area_t box;
+    const double t0 = host_now_ns();
+    for (int i = 0; i < reps; ++i)
+        sink += epd3in7_lvgl_adapter_diff_i1(cur, prev, LOG_W, LOG_H, STRIDE, &box);
+    return (host_now_ns() - t0) / reps;
+}
+
+static double time_bytewise(void)
+{
+    const int reps = 2000;
+    const double t0 = host_now_ns();
+    for (int i = 0; i < reps; ++i)
+    {
+        /* Baseline: byte loop that only tracks the changed row range */
+        int32_t y1 = -1, y2 = -1;
+        for (int32_t y = 0; y < LOG_H; ++y)
+        {
+            for (int32_t b = 0; b < STRIDE; ++b)
+            {
+                if (cur[y * STRIDE + b] != prev[y * STRIDE + b])
+                {
+                    if (y1 < 0)
+                        y1 = y;
+                    y2 = y;
+                    break;
+                }
+            }
+        }
+        sink += (uint32_t)(y1 + y2);
+    }
+    return (host_now_ns() - t0) / reps;
+}
+
+static void bench_diff(void)
+{
+    random_frame(prev, FRAME_BYTES);
+
+    memcpy(cur, prev, FRAME_BYTES);
+    const double same = time_diff(), same_b = time_bytewise();
+    /* A temperature digit: 40 x 60 px changed in the middle of the screen */
+    for (int32_t y = 110; y < 170; ++y)
+        for (int32_t x = 220; x < 260; ++x)
+            flip(cur, STRIDE, x, y);
+    const double digit = time_diff(), digit_b = time_bytewise();
+    for (size_t i = 0; i < FRAME_BYTES; ++i)
+        cur[i] = (uint8_t)~prev[i];
+    const double full = time_diff(), full_b = time_bytewise();
+
+    printf("  diff_i1 on %u-byte frames (host ns/frame, byte loop in brackets):\n", FRAME_BYTES);
+    printf("    identical %8.0f (%8.0f)  digit changed %8.0f (%8.0f)  all changed %8.0f (%8.0f)\n",
+           same, same_b, digit, digit_b, full, full_b);
+}
+
+int main(void)
+{
+    srand(1234);
+    RUN_TEST(test_identical);
+    RUN_TEST(test_single_pixels);
+    RUN_TEST(test_random_changes);
+    RUN_TEST(test_padding_ignored);
+    RUN_TEST(test_odd_stride);
+    RUN_TEST(bench_diff);
+    return HOST_TEST_RESULT();
+}
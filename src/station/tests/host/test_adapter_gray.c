@@ -0,0 +1,248 @@
+/* 4-gray pipeline of the EPD adapter: the L8 -> I2 quantize/rotate kernel and the I2 -> two-plane
+   split are checked against per-pixel references (the plane reference is the original blocking
+   loop of epd3in7_driver_display_4_gray()) and timed; flush_4_gray_dma is replayed on the host sim,
+   including a frame whose enqueue fails half-way. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+#include "app/drivers/epd3in7_lvgl_adapter.c"
+#include <stdlib.h>
+#include <time.h>
+
+/* Logical L8 screen at LV_DISPLAY_ROTATION_90 */
+#define LOG_W EPD3IN7_HEIGHT
+#define LOG_H EPD3IN7_WIDTH
+#define I2_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 4)
+#define PLANE_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+
+static uint8_t l8[LOG_W * LOG_H];
+static uint8_t i2[I2_BYTES], i2_ref[I2_BYTES];
+static uint8_t planes[2 * PLANE_BYTES], planes_ref[2 * PLANE_BYTES];
+
+static double host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Original conversion of display_4_gray(): RAM takes white and gray2 (low bit), RAM2 white and gray1 (high bit) */
+static void planes_reference(const uint8_t *image, uint8_t *ram, uint8_t *ram2)
+{
+    for (uint32_t i = 0; i < PLANE_BYTES; i++)
+    {
+        uint8_t t_lo = 0, t_hi = 0;
+        for (uint32_t j = 0; j < 2; j++)
+        {
+            uint8_t px = image[i * 2 + j];
+            for (uint32_t k = 0; k < 4; k++)
+            {
+                const uint8_t v = px & 0xC0;
+                t_lo = (uint8_t)(t_lo << 1 | (v == 0xC0 || v == 0x40));
+                t_hi = (uint8_t)(t_hi << 1 | (v == 0xC0 || v == 0x80));
+                px <<= 2;
+            }
+        }
+        ram[i] = t_lo;
+        ram2[i] = t_hi;
+    }
+}
+
+/* Per pixel: panel (xd, yd) of logical (x, y), as rotate_i1 maps it */
+static void l8_to_i2_reference(const uint8_t *src, const lv_area_t *a, lv_display_rotation_t rot, uint8_t *dst)
+{
+    for (int32_t y = a->y1; y <= a->y2; ++y)
+    {
+        for (int32_t x = a->x1; x <= a->x2; ++x)
+        {
+            int32_t xd = x, yd = y;
+            if (rot == LV_DISPLAY_ROTATION_90)
+                xd = LOG_H - 1 - y, yd = x;
+            else if (rot == LV_DISPLAY_ROTATION_180)
+                xd = LOG_W - 1 - x, yd = LOG_H - 1 - y;
+            else if (rot == LV_DISPLAY_ROTATION_270)
+                xd = y, yd = LOG_W - 1 - x;
+            const uint32_t stride = (rot == LV_DISPLAY_ROTATION_90 || rot == LV_DISPLAY_ROTATION_270) ? EPD3IN7_WIDTH / 4 : LOG_W / 4;
+            uint8_t *b = dst + (size_t)yd * stride + xd / 4;
+            const int sh = 6 - 2 * (xd & 3);
+            *b = (uint8_t)((*b & ~(3 << sh)) | ((src[(y - a->y1) * lv_area_get_width(a) + (x - a->x1)] >> 6) << sh));
+        }
+    }
+}
+
+static void test_planes_match_reference(void)
+{
+    for (int round = 0; round < 4; ++round)
+    {
+        for (uint32_t i = 0; i < I2_BYTES; ++i)
+            i2[i] = (round == 0) ? (uint8_t)i : (uint8_t)rand();
+        epd3in7_driver_i2_to_planes(i2, planes, planes + PLANE_BYTES, I2_BYTES);
+        planes_reference(i2, planes_ref, planes_ref + PLANE_BYTES);
+        CHECK_MEM(planes, planes_ref, sizeof(planes));
+    }
+}
+
+static void test_l8_to_i2_matches_reference(void)
+{
+    static const lv_display_rotation_t rots[] = {LV_DISPLAY_ROTATION_90, LV_DISPLAY_ROTATION_270};
+    for (uint32_t r = 0; r < 2; ++r)
+    {
+        memset(i2, 0x5A, sizeof(i2));
+        memset(i2_ref, 0x5A, sizeof(i2_ref));
+        /* Partial bands as LVGL hands them out, odd sizes and offsets included */
+        for (int k = 0; k < 40; ++k)
+        {
+            lv_area_t a;
+            a.x1 = rand() % LOG_W;
+            a.y1 = rand() % LOG_H;
+            a.x2 = a.x1 + rand() % (LOG_W - a.x1);
+            a.y2 = a.y1 + rand() % LV_MIN(24, LOG_H - a.y1);
+            const int32_t n = lv_area_get_width(&a) * lv_area_get_height(&a);
+            for (int32_t i = 0; i < n; ++i)
+                l8[i] = (uint8_t)rand();
+            epd3in7_lvgl_adapter_l8_to_i2(l8, (uint32_t)lv_area_get_width(&a), &a, LOG_W, LOG_H, i2, EPD3IN7_WIDTH / 4, rots[r]);
+            l8_to_i2_reference(l8, &a, rots[r], i2_ref);
+        }
+        CHECK_MEM(i2, i2_ref, sizeof(i2));
+    }
+}
+
+static volatile uint8_t sink;
+
+/* Host figures only: the host compiler vectorizes the byte loop, the M4 runs it a pixel at a time */
+static void bench_gray_kernels(void)
+{
+    const lv_area_t full = {0, 0, LOG_W - 1, LOG_H - 1};
+    for (uint32_t i = 0; i < sizeof(l8); ++i)
+        l8[i] = (uint8_t)rand();
+
+    const int reps = 200;
+    double t0 = host_now_ns();
+    for (int i = 0; i < reps; ++i)
+        epd3in7_lvgl_adapter_l8_to_i2(l8, LOG_W, &full, LOG_W, LOG_H, i2, EPD3IN7_WIDTH / 4, LV_DISPLAY_ROTATION_90);
+    const double quantize = (host_now_ns() - t0) / reps;
+
+    t0 = host_now_ns();
+    for (int i = 0; i < reps; ++i)
+    {
+        epd3in7_driver_i2_to_planes(i2, planes, planes + PLANE_BYTES, I2_BYTES);
+        sink += planes[i];
+    }
+    const double split = (host_now_ns() - t0) / reps;
+
+    t0 = host_now_ns();
+    for (int i = 0; i < reps; ++i)
+    {
+        planes_reference(i2, planes_ref, planes_ref + PLANE_BYTES);
+        sink += planes_ref[i];
+    }
+    const double split_ref = (host_now_ns() - t0) / reps;
+
+    printf("  L8 -> I2 (rotated, %u px): %.0f ns | I2 -> planes: %.0f ns, byte loop %.0f ns (host, per frame)\n",
+           LOG_W * LOG_H, quantize, split, split_ref);
+}
+
+/* ---- flush_4_gray_dma on the host sim ---- */
+
+static host_station st;
+static epd3in7_lvgl_adapter_handle adapter;
+static lv_display_t disp;
+static host_sim_command cmds[256];
+static uint8_t wire[64 * 1024];
+
+static void flush_full_frame(void)
+{
+    const lv_area_t full = {0, 0, LOG_W - 1, LOG_H - 1};
+    disp.flush_is_last = true;
+    epd3in7_lvgl_adapter_flush_4_gray_dma(&disp, &full, l8);
+}
+
+/* Whether a plane upload (a RAM or RAM2 write of a whole plane) reached the panel */
+static uint32_t plane_uploads(void)
+{
+    const uint32_t n = host_sim_decode(HOST_STATION_DEV_EPD, 0, cmds, 256, wire, sizeof(wire));
+    uint32_t uploads = 0;
+    for (uint32_t i = 0; i < n; ++i)
+        uploads += (cmds[i].cmd == 0x24 || cmds[i].cmd == 0x26) && cmds[i].len == PLANE_BYTES;
+    return uploads;
+}
+
+static void setup_4_gray(void)
+{
+    host_station_setup(&st, 512, true);
+    adapter = epd3in7_lvgl_adapter_create_4_gray_with_bus_manager(&st.epd, i2, planes, &st.mgr);
+    disp = (lv_display_t){.driver_data = &adapter, .rotation = LV_DISPLAY_ROTATION_90,
+                          .color_format = LV_COLOR_FORMAT_L8, .hor_res = EPD3IN7_WIDTH, .ver_res = EPD3IN7_HEIGHT};
+    for (uint32_t i = 0; i < sizeof(l8); ++i)
+        l8[i] = (uint8_t)(i * 3u);
+}
+
+static void test_flush_4_gray_uploads_planes(void)
+{
+    setup_4_gray();
+    flush_full_frame();
+    CHECK_EQ(disp.flush_ready_calls, 1);
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+    CHECK(adapter.is_initialized);
+    CHECK_EQ(adapter.frames_queued, adapter.frames_done);
+    CHECK_EQ(plane_uploads(), 2);
+    CHECK_EQ(host_sim_panel_busy_violations(), 0);
+}
+
+static void test_flush_4_gray_enqueue_failure(void)
+{
+    static spi_bus_device filler;
+    static const uint8_t byte = 0;
+    setup_4_gray();
+    flush_full_frame();
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+    host_sim_wire_clear();
+
+    /* Hold the bus and fill the queue so only the first two items of the next frame fit */
+    filler = (spi_bus_device){.cs = {HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, true},
+                              .cr1 = SPI2->CR1, .cr2 = SPI2->CR2, .spi_timeout = HAL_MAX_DELAY};
+    uint8_t id;
+    CHECK_EQ(spi_bus_manager_add_device(&st.mgr, &filler, &id), SPI_BUS_MANAGER_OK);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, NULL, NULL);
+    const spi_bus_transaction t = {.tx = &byte, .len = 1, .dev = id, .kind = SPI_BUS_ITEM_TX, .dir = SPI_BUS_DIR_TX};
+    CHECK_EQ(spi_bus_manager_acquire(&st.mgr, 100u), SPI_BUS_MANAGER_OK);
+    uint32_t capacity = 0;
+    while (spi_bus_manager_submit(&st.mgr, &t) == SPI_BUS_MANAGER_OK)
+        capacity++;
+    spi_bus_manager_release(&st.mgr);
+    CHECK(host_sim_run_until(host_station_idle, &st, 100u));
+    CHECK_EQ(spi_bus_manager_acquire(&st.mgr, 100u), SPI_BUS_MANAGER_OK);
+    for (uint32_t i = 0; i + 2u < capacity; ++i)
+        CHECK_EQ(spi_bus_manager_submit(&st.mgr, &t), SPI_BUS_MANAGER_OK);
+
+    const uint32_t ready_before = disp.flush_ready_calls;
+    flush_full_frame();
+    CHECK_EQ(disp.flush_ready_calls, ready_before + 1u);
+    /* Re-init with the next frame; no fence outstanding for the dropped one */
+    CHECK(!adapter.is_initialized);
+    CHECK_EQ(adapter.frames_queued, adapter.frames_done);
+
+    spi_bus_manager_release(&st.mgr);
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+    /* The half-queued frame was dropped: no plane reached the panel */
+    CHECK_EQ(plane_uploads(), 0);
+
+    /* The next frame re-inits and goes out whole */
+    host_sim_wire_clear();
+    flush_full_frame();
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+    CHECK(adapter.is_initialized);
+    CHECK_EQ(plane_uploads(), 2);
+    CHECK_EQ(adapter.frames_queued, adapter.frames_done);
+}
+
+int main(void)
+{
+    srand(77);
+    RUN_TEST(test_planes_match_reference);
+    RUN_TEST(test_l8_to_i2_matches_reference);
+    RUN_TEST(bench_gray_kernels);
+    RUN_TEST(test_flush_4_gray_uploads_planes);
+    RUN_TEST(test_flush_4_gray_enqueue_failure);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,127 @@
+/* 8x8 block rotator of the EPD adapter (rotate_i1_blocks) against the per-pixel rotate_i1_bitwise
+   for every rotation: whole frames, bands of destination rows, padded source rows and random
+   sizes; plus the host time of both on a full 480x280 frame. */
+
+#include "sim/host_test.h"
+#include "app/drivers/epd3in7_lvgl_adapter.c"
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8 + 1024)
+
+static uint8_t src[MAX_BYTES];
+static uint8_t dst_blocks[MAX_BYTES], dst_bitwise[MAX_BYTES];
+
+static const lv_display_rotation_t rotations[] = {LV_DISPLAY_ROTATION_0, LV_DISPLAY_ROTATION_90,
+                                                  LV_DISPLAY_ROTATION_180, LV_DISPLAY_ROTATION_270};
+
+static double host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int32_t dst_width(int32_t w, int32_t h, lv_display_rotation_t rot)
+{
+    return (rot == LV_DISPLAY_ROTATION_0 || rot == LV_DISPLAY_ROTATION_180) ? w : h;
+}
+
+static int32_t dst_height(int32_t w, int32_t h, lv_display_rotation_t rot)
+{
+    return (rot == LV_DISPLAY_ROTATION_0 || rot == LV_DISPLAY_ROTATION_180) ? h : w;
+}
+
+/* Rotate destination rows [row0, row0 + rows) both ways and compare the pixels of every row */
+static void check_rotation(int32_t w, int32_t h, int32_t src_pad, lv_display_rotation_t rot, int32_t row0, int32_t rows)
+{
+    /* Rotation 0 copies whole source rows, so it takes equal strides only */
+    const int32_t src_stride = w / 8 + (rot == LV_DISPLAY_ROTATION_0 ? 0 : src_pad);
+    const int32_t dst_stride = dst_width(w, h, rot) / 8;
+    for (int32_t i = 0; i < src_stride * h; ++i)
+        src[i] = (uint8_t)rand();
+    memset(dst_blocks, 0xA5, (size_t)dst_stride * rows);
+
+    epd3in7_lvgl_adapter_rotate_i1(src, dst_blocks, w, h, src_stride, dst_stride, rot, row0, rows);
+    epd3in7_lvgl_adapter_rotate_i1_bitwise(src, dst_bitwise, w, h, src_stride, dst_stride, rot, row0, rows);
+    CHECK_MEM(dst_blocks, dst_bitwise, (size_t)dst_stride * rows);
+}
+
+static void test_full_frames(void)
+{
+    for (uint32_t r = 0; r < 4; ++r)
+    {
+        check_rotation(EPD3IN7_HEIGHT, EPD3IN7_WIDTH, 0, rotations[r], 0,
+                       dst_height(EPD3IN7_HEIGHT, EPD3IN7_WIDTH, rotations[r]));
+        check_rotation(EPD3IN7_WIDTH, EPD3IN7_HEIGHT, 0, rotations[r], 0,
+                       dst_height(EPD3IN7_WIDTH, EPD3IN7_HEIGHT, rotations[r]));
+    }
+}
+
+/* Bands as the DMA flush asks for them (row0 and rows multiples of 8), source rows with padding */
+static void test_bands(void)
+{
+    for (uint32_t r = 0; r < 4; ++r)
+    {
+        const int32_t w = EPD3IN7_HEIGHT, h = EPD3IN7_WIDTH;
+        const int32_t dh = dst_height(w, h, rotations[r]);
+        for (int32_t row0 = 0; row0 < dh; row0 += 40)
+            check_rotation(w, h, 0, rotations[r], row0, LV_MIN(40, dh - row0));
+        check_rotation(w, h, 3, rotations[r], 8, 16);
+    }
+}
+
+static void test_random_sizes(void)
+{
+    for (int k = 0; k < 200; ++k)
+    {
+        const lv_display_rotation_t rot = rotations[k & 3];
+        const int32_t w = 8 * (1 + rand() % 20), h = 8 * (1 + rand() % 20);
+        const int32_t dh = dst_height(w, h, rot);
+        const int32_t row0 = 8 * (rand() % (dh / 8));
+        const int32_t rows = 8 * (1 + rand() % ((dh - row0) / 8));
+        check_rotation(w, h, rand() % 3, rot, row0, rows);
+    }
+}
+
+static volatile uint8_t sink;
+
+static void bench_rotate(void)
+{
+    const int32_t w = EPD3IN7_HEIGHT, h = EPD3IN7_WIDTH, stride = w / 8;
+    for (int32_t i = 0; i < stride * h; ++i)
+        src[i] = (uint8_t)rand();
+
+    for (uint32_t r = 1; r < 4; ++r)
+    {
+        const int32_t dst_stride = dst_width(w, h, rotations[r]) / 8, rows = dst_height(w, h, rotations[r]);
+        const int reps = 100;
+        double t0 = host_now_ns();
+        for (int i = 0; i < reps; ++i)
+        {
+            epd3in7_lvgl_adapter_rotate_i1_blocks(src, dst_blocks, w, h, stride, dst_stride, rotations[r], 0, rows);
+            sink += dst_blocks[i];
+        }
+        const double blocks = (host_now_ns() - t0) / reps;
+        t0 = host_now_ns();
+        for (int i = 0; i < reps; ++i)
+        {
+            epd3in7_lvgl_adapter_rotate_i1_bitwise(src, dst_bitwise, w, h, stride, dst_stride, rotations[r], 0, rows);
+            sink += dst_bitwise[i];
+        }
+        const double bitwise = (host_now_ns() - t0) / reps;
+        printf("  rotation %3d, 480x280: blocks %.0f ns, bitwise %.0f ns (host, per frame)\n",
+               (int)rotations[r] * 90, blocks, bitwise);
+        CHECK(blocks < bitwise);
+    }
+}
+
+int main(void)
+{
+    srand(23);
+    RUN_TEST(test_full_frames);
+    RUN_TEST(test_bands);
+    RUN_TEST(test_random_sizes);
+    RUN_TEST(bench_rotate);
+    return HOST_TEST_RESULT();
+}
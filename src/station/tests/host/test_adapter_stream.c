@@ -0,0 +1,141 @@
+/* Streamed upload of the EPD adapter: fill_band (rotate a band of panel rows, keep the streamed
+   columns) against rotating the whole frame and packing the area, for every rotation and for
+   areas of several shapes; then flush_dma of an adapter created without a band buffer, whose
+   frame must reach the panel rotated. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+#include "app/drivers/epd3in7_lvgl_adapter.c"
+#include <stdlib.h>
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+#define PANEL_STRIDE (EPD3IN7_WIDTH / 8)
+
+static uint8_t frame[8 + FRAME_BYTES]; /* LVGL I1 buffer: palette, then pixels */
+static uint8_t rotated[FRAME_BYTES], packed[FRAME_BYTES];
+static uint8_t band[EPD3IN7_LVGL_ADAPTER_BAND_BYTES];
+static uint8_t streamed[FRAME_BYTES];
+
+static const lv_display_rotation_t rotations[] = {LV_DISPLAY_ROTATION_0, LV_DISPLAY_ROTATION_90,
+                                                  LV_DISPLAY_ROTATION_180, LV_DISPLAY_ROTATION_270};
+
+static void random_frame(void)
+{
+    for (uint32_t i = 0; i < sizeof(frame); ++i)
+        frame[i] = (uint8_t)rand();
+}
+
+/* Logical (LVGL) size of the full screen at @p rot */
+static int32_t logical_w(lv_display_rotation_t rot)
+{
+    return (rot == LV_DISPLAY_ROTATION_90 || rot == LV_DISPLAY_ROTATION_270) ? EPD3IN7_HEIGHT : EPD3IN7_WIDTH;
+}
+
+static int32_t logical_h(lv_display_rotation_t rot)
+{
+    return (rot == LV_DISPLAY_ROTATION_90 || rot == LV_DISPLAY_ROTATION_270) ? EPD3IN7_WIDTH : EPD3IN7_HEIGHT;
+}
+
+/* Bands produced as the driver asks for them vs the whole frame rotated, then packed to the area */
+static void check_area(lv_display_rotation_t rot, const epd3in7_driver_area *a)
+{
+    const int32_t w = logical_w(rot), h = logical_h(rot);
+    epd3in7_lvgl_adapter_handle hd = {0};
+    hd.stream_src = frame + 8;
+    hd.stream_src_w = w;
+    hd.stream_src_h = h;
+    hd.stream_src_stride = (uint32_t)w / 8u;
+    hd.stream_dst_stride = PANEL_STRIDE;
+    hd.stream_rotation = rot;
+    hd.stream_area = *a;
+
+    const size_t row_bytes = a->w / 8u;
+    for (uint16_t row = a->y; row < a->y + a->h; row += EPD3IN7_LVGL_ADAPTER_BAND_ROWS)
+    {
+        const uint16_t rows = (uint16_t)LV_MIN(EPD3IN7_LVGL_ADAPTER_BAND_ROWS, a->y + a->h - row);
+        epd3in7_lvgl_adapter_fill_band(&hd, row, rows, band);
+        memcpy(streamed + (row - a->y) * row_bytes, band, rows * row_bytes);
+    }
+
+    epd3in7_lvgl_adapter_rotate_i1(frame + 8, rotated, w, h, w / 8, PANEL_STRIDE, rot, 0, EPD3IN7_HEIGHT);
+    memcpy(packed, rotated, sizeof(rotated));
+    epd3in7_lvgl_adapter_pack_area(packed, PANEL_STRIDE, a);
+    CHECK_MEM(streamed, packed, a->h * row_bytes);
+}
+
+static void test_fill_band_matches_rotate_then_pack(void)
+{
+    static const epd3in7_driver_area areas[] = {
+        {0, 0, EPD3IN7_WIDTH, EPD3IN7_HEIGHT}, /* whole frame */
+        {0, 40, EPD3IN7_WIDTH, 96},            /* full-width rows */
+        {64, 8, 128, 200},                     /* box, band-aligned rows */
+        {8, 3, 8, 29},                         /* one byte wide, odd rows */
+        {272, 471, 8, 9},                      /* bottom-right corner */
+    };
+    for (uint32_t r = 0; r < 4; ++r)
+    {
+        for (uint32_t i = 0; i < sizeof(areas) / sizeof(areas[0]); ++i)
+        {
+            random_frame();
+            check_area(rotations[r], &areas[i]);
+        }
+        for (int k = 0; k < 50; ++k)
+        {
+            epd3in7_driver_area a;
+            a.x = (uint16_t)(8 * (rand() % (EPD3IN7_WIDTH / 8)));
+            a.w = (uint16_t)(8 * (1 + rand() % ((EPD3IN7_WIDTH - a.x) / 8)));
+            a.y = (uint16_t)(rand() % EPD3IN7_HEIGHT);
+            a.h = (uint16_t)(1 + rand() % (EPD3IN7_HEIGHT - a.y));
+            random_frame();
+            check_area(rotations[r], &a);
+        }
+    }
+}
+
+/* ---- flush_dma without a band buffer ---- */
+
+static host_station st;
+static host_sim_command cmds[64];
+static uint8_t wire[FRAME_BYTES + 1024];
+
+static void test_flush_without_band_buffer(void)
+{
+    host_station_setup(&st, 512, true);
+    epd3in7_lvgl_adapter_handle adapter = epd3in7_lvgl_adapter_create_with_bus_manager(&st.epd, NULL, 30,
+                                                                                       EPD3IN7_DRIVER_MODE_A2, &st.mgr);
+    lv_display_t disp = {.driver_data = &adapter, .rotation = LV_DISPLAY_ROTATION_90,
+                         .color_format = LV_COLOR_FORMAT_I1, .hor_res = EPD3IN7_WIDTH, .ver_res = EPD3IN7_HEIGHT};
+    const lv_area_t full = {0, 0, EPD3IN7_HEIGHT - 1, EPD3IN7_WIDTH - 1};
+    random_frame();
+
+    epd3in7_lvgl_adapter_flush_dma(&disp, &full, frame);
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+    CHECK_EQ(disp.flush_ready_calls, 1);
+    CHECK_EQ(adapter.frames_queued, adapter.frames_done);
+
+    /* The panel got the frame in its own orientation, not the landscape buffer as-is */
+    epd3in7_lvgl_adapter_rotate_i1(frame + 8, rotated, EPD3IN7_HEIGHT, EPD3IN7_WIDTH, EPD3IN7_HEIGHT / 8,
+                                   PANEL_STRIDE, LV_DISPLAY_ROTATION_90, 0, EPD3IN7_HEIGHT);
+    const uint32_t n = host_sim_decode(HOST_STATION_DEV_EPD, 0, cmds, 64, wire, sizeof(wire));
+    uint32_t uploads = 0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (cmds[i].cmd != 0x24)
+            continue;
+        uploads++;
+        CHECK_EQ(cmds[i].len, FRAME_BYTES);
+        if (cmds[i].len == FRAME_BYTES)
+            CHECK_MEM(&wire[cmds[i].first], rotated, FRAME_BYTES);
+    }
+    CHECK_EQ(uploads, 1);
+    CHECK_EQ(host_sim_get_stats()->cs_conflicts, 0);
+    CHECK_EQ(host_sim_panel_busy_violations(), 0);
+}
+
+int main(void)
+{
+    srand(24);
+    RUN_TEST(test_fill_band_matches_rotate_then_pack);
+    RUN_TEST(test_flush_without_band_buffer);
+    return HOST_TEST_RESULT();
+}
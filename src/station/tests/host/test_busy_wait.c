@@ -0,0 +1,206 @@
+/* Post-transfer BUSY waits run outside interrupt context: the completion ISR parks the lane and
+   returns, the BUSY falling edge (EXTI) or a tick resumes it, also when the edge finds the engine
+   taken by a thread-level submit. The ISR time must not depend on how
+   long the panel stays BUSY. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+
+/* Longest interrupt allowed anywhere in a frame: DMA restart plus a short polled program */
+#define ISR_BOUND_NS 100000u
+
+static host_station st;
+static uint8_t image[FRAME_BYTES];
+static host_sim_command cmds[64];
+static uint8_t data[2 * FRAME_BYTES];
+
+/* Virtual ISR time of one frame whose refresh keeps BUSY high for @p busy_ms */
+static uint64_t frame_isr_max(uint32_t busy_ms)
+{
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    host_sim_panel_busy_ms(0x20, busy_ms);
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(host_station_idle, &st, busy_ms + 1000u));
+    CHECK_EQ(host_sim_panel_busy_violations(), 0);
+    return host_sim_get_stats()->isr_ns_max;
+}
+
+static void test_isr_time_independent_of_busy(void)
+{
+    const uint64_t short_busy = frame_isr_max(300u);
+    const uint64_t long_busy = frame_isr_max(5000u);
+    printf("  isr max: %.2f us (BUSY 300 ms), %.2f us (BUSY 5000 ms)\n", short_busy / 1e3, long_busy / 1e3);
+    CHECK(short_busy < ISR_BOUND_NS);
+    CHECK_EQ(long_busy, short_busy);
+}
+
+static void test_busy_edge_resumes_queue(void)
+{
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    host_sim_wire_clear();
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+
+    /* No main loop ticks: only interrupts (DMA, timer, BUSY edge) move the queue */
+    const uint64_t deadline = host_sim_now_ns() + 2000ull * 1000000u;
+    while (!host_station_idle(&st) && host_sim_now_ns() < deadline)
+        host_sim_wfi();
+    CHECK(host_station_idle(&st));
+
+    uint32_t n = host_sim_decode(HOST_STATION_DEV_EPD, 0, cmds, 64, data, sizeof(data));
+    CHECK_EQ(n, 13);
+    if (n == 13)
+    {
+        /* Second frame starts right after the refresh ends, not at the next tick */
+        const uint64_t busy_end = cmds[6].t_ns + (uint64_t)HOST_STATION_REFRESH_MS * 1000000u;
+        CHECK_EQ(cmds[7].cmd, 0x44);
+        CHECK(cmds[7].t_ns >= busy_end);
+        CHECK(cmds[7].t_ns - busy_end < 100000u);
+    }
+    CHECK_EQ(host_sim_panel_busy_violations(), 0);
+}
+
+static void test_busy_edge_during_submit(void)
+{
+    static spi_bus_device bme;
+    static uint8_t tx[9] = {0xF7}, rx[9];
+
+    host_station_setup(&st, 512, true);
+    bme = (spi_bus_device){.cs = {HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, true},
+                           .cr1 = SPI2->CR1, .cr2 = SPI2->CR2, .max_sclk_hz = 10000000u,
+                           .spi_timeout = HAL_MAX_DELAY};
+    uint8_t id;
+    CHECK_EQ(spi_bus_manager_add_device(&st.mgr, &bme, &id), SPI_BUS_MANAGER_OK);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, NULL, NULL);
+    host_station_init_epd(&st);
+    host_sim_wire_clear();
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    while (!host_sim_panel_busy())
+        host_sim_wfi();
+    uint32_t n = host_sim_decode(HOST_STATION_DEV_EPD, 0, cmds, 64, data, sizeof(data));
+    CHECK_EQ(n, 7);
+    if (n != 7)
+        return;
+
+    /* Submit a sensor read from thread level 1 us before BUSY falls: the edge arrives while the
+       submit holds the engine lock (DMA start), and no main loop tick follows */
+    const uint64_t busy_end = cmds[6].t_ns + (uint64_t)HOST_STATION_REFRESH_MS * 1000000u;
+    host_sim_spend_ns(busy_end - 1000u - host_sim_now_ns());
+    const spi_bus_transaction t = {.tx = tx, .rx = rx, .len = 9, .dev = id, .kind = SPI_BUS_ITEM_TX,
+                                   .dir = SPI_BUS_DIR_TXRX, .priority = SPI_BUS_PRIO_HIGH};
+    CHECK_EQ(spi_bus_manager_submit(&st.mgr, &t), SPI_BUS_MANAGER_OK);
+
+    const uint64_t deadline = host_sim_now_ns() + 2000ull * 1000000u;
+    while (!host_station_idle(&st) && host_sim_now_ns() < deadline)
+        host_sim_wfi();
+    CHECK(host_station_idle(&st));
+
+    /* The edge was replayed when the submit released the lock: the second frame starts at once */
+    n = host_sim_decode(HOST_STATION_DEV_EPD, 0, cmds, 64, data, sizeof(data));
+    CHECK_EQ(n, 13);
+    if (n == 13)
+    {
+        CHECK_EQ(cmds[7].cmd, 0x44);
+        CHECK(cmds[7].t_ns - busy_end < 100000u);
+    }
+    CHECK_EQ(host_sim_panel_busy_violations(), 0);
+}
+
+static bool read_done(void *user)
+{
+    return *(volatile bool *)user;
+}
+
+static void on_read(spi_bus_manager *mgr, void *user)
+{
+    (void)mgr;
+    *(volatile bool *)user = true;
+}
+
+static bool refresh_running(void *user)
+{
+    (void)user;
+    return host_sim_panel_busy();
+}
+
+static void test_bus_free_while_parked(void)
+{
+    static spi_bus_device bme;
+    static const spi_bus_callbacks cbs = {.on_done = on_read};
+    static uint8_t tx[9] = {0xF7}, rx[9];
+    static volatile bool done;
+
+    host_station_setup(&st, 512, true);
+    bme = (spi_bus_device){.cs = {HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, true},
+                           .cr1 = SPI2->CR1, .cr2 = SPI2->CR2, .max_sclk_hz = 10000000u,
+                           .spi_timeout = HAL_MAX_DELAY, .cb = &cbs};
+    uint8_t id;
+    CHECK_EQ(spi_bus_manager_add_device(&st.mgr, &bme, &id), SPI_BUS_MANAGER_OK);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, NULL, NULL);
+    host_station_init_epd(&st);
+    host_sim_panel_busy_ms(0x20, 3000u);
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(refresh_running, NULL, 100u));
+
+    /* The EPD lane is parked on BUSY; a sensor read gets the bus at once */
+    done = false;
+    const spi_bus_transaction t = {.tx = tx, .rx = rx, .user = (void *)&done, .len = 9, .dev = id,
+                                   .kind = SPI_BUS_ITEM_TX, .dir = SPI_BUS_DIR_TXRX, .priority = SPI_BUS_PRIO_HIGH};
+    const uint64_t t0 = host_sim_now_ns();
+    CHECK_EQ(spi_bus_manager_submit(&st.mgr, &t), SPI_BUS_MANAGER_OK);
+    CHECK(host_sim_run_until(read_done, (void *)&done, 5u));
+    CHECK(host_sim_now_ns() - t0 < 1000000u);
+    CHECK(host_sim_panel_busy());
+
+    CHECK(host_sim_run_until(host_station_idle, &st, 4000u));
+}
+
+static bool queue_idle(void *user)
+{
+    (void)user;
+    return spi_bus_manager_is_idle(&st.mgr);
+}
+
+static void test_busy_timeout_fails_and_resumes(void)
+{
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    /* Stuck BUSY: longer than EPD3IN7_DRIVER_BUSY_TIMEOUT */
+    host_sim_panel_busy_ms(0x20, EPD3IN7_DRIVER_BUSY_TIMEOUT + 3000u);
+    host_sim_wire_clear();
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(refresh_running, NULL, 100u));
+    /* The wait gives up after the device timeout and the queue is free again, BUSY still high */
+    CHECK(host_sim_run_until(queue_idle, NULL, EPD3IN7_DRIVER_BUSY_TIMEOUT + 500u));
+    CHECK(host_sim_panel_busy());
+    CHECK(host_sim_get_stats()->isr_ns_max < ISR_BOUND_NS);
+#if SPI_BUS_MANAGER_STATS
+    spi_bus_stats s;
+    spi_bus_manager_get_stats(&st.mgr, &s);
+    CHECK(s.failed >= 1u);
+#endif
+    CHECK(host_sim_run_until(host_station_idle, &st, 5000u));
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < FRAME_BYTES; ++i)
+        image[i] = (uint8_t)(i * 13u);
+
+    RUN_TEST(test_isr_time_independent_of_busy);
+    RUN_TEST(test_busy_edge_resumes_queue);
+    RUN_TEST(test_busy_edge_during_submit);
+    RUN_TEST(test_bus_free_while_parked);
+    RUN_TEST(test_busy_timeout_fails_and_resumes);
+    return HOST_TEST_RESULT();
+}
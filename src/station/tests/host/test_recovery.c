@@ -0,0 +1,266 @@
+/* DMA watchdog and bus recovery under injected faults: a lost completion is failed through on_error
+   once the device's spi_timeout expires, the SPI is reset, CS is released and the queue resumes.
+   Refused starts, SPI error interrupts and stalled polled segments fail only their own item. Neither the watchdog reset nor a
+   cancel stopping a transfer on the wire runs HAL's abort with interrupts masked. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+#define DEV_TIMEOUT_MS 5u
+
+static host_station st;
+static uint8_t image[FRAME_BYTES];
+static spi_bus_device dev;
+static uint8_t dev_id;
+static uint8_t tx[16] = {0xF7}, rx[16];
+
+/* Outcome per item: 'd' done, 'e' error, 0 pending */
+static char outcome[8];
+static uint64_t error_ns;
+
+static void on_done(spi_bus_manager *mgr, void *user)
+{
+    (void)mgr;
+    outcome[(uintptr_t)user] = 'd';
+}
+
+static void on_error(spi_bus_manager *mgr, void *user)
+{
+    (void)mgr;
+    outcome[(uintptr_t)user] = 'e';
+    error_ns = host_sim_now_ns();
+}
+
+static const spi_bus_callbacks cbs = {.on_done = on_done, .on_error = on_error};
+
+static bool queue_idle(void *user)
+{
+    (void)user;
+    return spi_bus_manager_is_idle(&st.mgr);
+}
+
+static void setup(void)
+{
+    host_station_setup(&st, 512, true);
+    dev = (spi_bus_device){.cs = {HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, true},
+                           .cr1 = SPI2->CR1, .cr2 = SPI2->CR2, .max_sclk_hz = 10000000u,
+                           .spi_timeout = DEV_TIMEOUT_MS, .cb = &cbs};
+    CHECK_EQ(spi_bus_manager_add_device(&st.mgr, &dev, &dev_id), SPI_BUS_MANAGER_OK);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, NULL, NULL);
+    memset(outcome, 0, sizeof(outcome));
+    error_ns = 0u;
+}
+
+static void submit(uintptr_t n, spi_bus_priority prio)
+{
+    const spi_bus_transaction t = {.tx = tx, .rx = rx, .len = sizeof(tx), .dev = dev_id, .user = (void *)n,
+                                   .kind = SPI_BUS_ITEM_TX, .dir = SPI_BUS_DIR_TXRX, .priority = prio};
+    CHECK_EQ(spi_bus_manager_submit(&st.mgr, &t), SPI_BUS_MANAGER_OK);
+}
+
+static bool cs_released(void)
+{
+    return (HOST_STATION_BME_CS_PORT->ODR & HOST_STATION_BME_CS_PIN) != 0u;
+}
+
+static void test_lost_completion_recovers(void)
+{
+    setup();
+    host_sim_fault_lose_completion(1u);
+    const uint64_t t0 = host_sim_now_ns();
+    submit(0, SPI_BUS_PRIO_NORMAL);
+    submit(1, SPI_BUS_PRIO_NORMAL);
+    submit(2, SPI_BUS_PRIO_NORMAL);
+
+    CHECK(host_sim_run_until(queue_idle, NULL, 100u));
+    CHECK_EQ(outcome[0], 'e');
+    CHECK_EQ(outcome[1], 'd');
+    CHECK_EQ(outcome[2], 'd');
+    /* Failed by the first tick past the deadline, not by the 250 ms default */
+    CHECK(error_ns - t0 > (uint64_t)DEV_TIMEOUT_MS * 1000000u);
+    CHECK(error_ns - t0 <= (uint64_t)(DEV_TIMEOUT_MS + 2u) * 1000000u);
+    CHECK_EQ(st.mgr.recoveries, 1);
+    CHECK_EQ(host_sim_get_stats()->recoveries, 1);
+    /* The reset ran with interrupts on (HAL's abort waits on flags) */
+    CHECK_EQ(host_sim_get_stats()->masked_resets, 0);
+    CHECK_EQ(host_sim_get_stats()->dma_overlaps, 0);
+    CHECK(cs_released());
+#if SPI_BUS_MANAGER_STATS
+    spi_bus_stats s;
+    spi_bus_manager_get_stats(&st.mgr, &s);
+    CHECK_EQ(s.recoveries, 1);
+    CHECK_EQ(s.failed, 1);
+    CHECK_EQ(s.completed, 2);
+#endif
+}
+
+static void test_lost_completion_on_priority_lane(void)
+{
+    setup();
+    host_sim_fault_lose_completion(1u);
+    submit(0, SPI_BUS_PRIO_HIGH);
+    submit(1, SPI_BUS_PRIO_NORMAL);
+    submit(2, SPI_BUS_PRIO_HIGH);
+
+    CHECK(host_sim_run_until(queue_idle, NULL, 100u));
+    CHECK_EQ(outcome[0], 'e');
+    CHECK_EQ(outcome[1], 'd');
+    CHECK_EQ(outcome[2], 'd');
+    CHECK_EQ(st.mgr.recoveries, 1);
+    CHECK_EQ(host_sim_get_stats()->masked_resets, 0);
+    CHECK(!st.mgr.hq_active);
+    CHECK(cs_released());
+}
+
+static void test_refused_start_fails_item_only(void)
+{
+    setup();
+    host_sim_fault_refuse_dma(1u);
+    submit(0, SPI_BUS_PRIO_NORMAL);
+    submit(1, SPI_BUS_PRIO_NORMAL);
+
+    CHECK(host_sim_run_until(queue_idle, NULL, 10u));
+    CHECK_EQ(outcome[0], 'e');
+    CHECK_EQ(outcome[1], 'd');
+    /* Nothing hung: no watchdog involved */
+    CHECK_EQ(st.mgr.recoveries, 0);
+    CHECK(cs_released());
+}
+
+static void test_error_irq_fails_item_only(void)
+{
+    setup();
+    host_sim_fault_error_irq(1u);
+    submit(0, SPI_BUS_PRIO_NORMAL);
+    submit(1, SPI_BUS_PRIO_NORMAL);
+
+    CHECK(host_sim_run_until(queue_idle, NULL, 10u));
+    CHECK_EQ(outcome[0], 'e');
+    CHECK_EQ(outcome[1], 'd');
+    CHECK_EQ(st.mgr.recoveries, 0);
+    CHECK_EQ(host_sim_get_stats()->errors, 1);
+    CHECK(cs_released());
+}
+
+static void test_stalled_chain_segment_fails_item_only(void)
+{
+    static const uint8_t reg[] = {0x74, 0x25};
+    static const spi_bus_segment segs[] = {{reg, sizeof(reg), SPI_BUS_DC_UNUSED}};
+    setup();
+    /* No ms bound, as the EPD and BME280 profiles */
+    static spi_bus_device untimed;
+    untimed = dev;
+    untimed.spi_timeout = HAL_MAX_DELAY;
+    uint8_t untimed_id;
+    CHECK_EQ(spi_bus_manager_add_device(&st.mgr, &untimed, &untimed_id), SPI_BUS_MANAGER_OK);
+
+    host_sim_fault_stall_poll(1u);
+    const spi_bus_transaction t = {.segs = segs, .seg_count = 1u, .dev = untimed_id, .user = (void *)0,
+                                   .kind = SPI_BUS_ITEM_CHAIN, .dir = SPI_BUS_DIR_TX};
+    CHECK_EQ(spi_bus_manager_submit(&st.mgr, &t), SPI_BUS_MANAGER_OK);
+    submit(1, SPI_BUS_PRIO_NORMAL);
+
+    CHECK(host_sim_run_until(queue_idle, NULL, 10u));
+    CHECK_EQ(outcome[0], 'e');
+    CHECK_EQ(outcome[1], 'd');
+    /* Gave up after its loop bound, not after the device's ms timeout */
+    CHECK_EQ(host_sim_get_stats()->hung_polls, 0);
+    CHECK_EQ(st.mgr.recoveries, 0);
+    CHECK(cs_released());
+}
+
+static void test_stalled_program_op_fails_item_only(void)
+{
+    setup();
+    /* The first command of the EPD init program: polled, from a profile with no ms bound */
+    host_sim_fault_stall_poll(1u);
+    (void)epd3in7_driver_init_1_gray_dma(&st.epd, &st.mgr);
+    submit(0, SPI_BUS_PRIO_NORMAL);
+
+    CHECK(host_sim_run_until(host_station_idle, &st, 5000u));
+    CHECK_EQ(outcome[0], 'd');
+    CHECK_EQ(host_sim_get_stats()->hung_polls, 0);
+    CHECK_EQ(st.mgr.recoveries, 0);
+    CHECK((HOST_STATION_DISP_CS_PORT->ODR & HOST_STATION_DISP_CS_PIN) != 0u);
+#if SPI_BUS_MANAGER_STATS
+    spi_bus_stats s;
+    spi_bus_manager_get_stats(&st.mgr, &s);
+    CHECK_EQ(s.failed, 1);
+#endif
+}
+
+static bool upload_done(void *user)
+{
+    (void)user;
+    return host_sim_panel_busy();
+}
+
+static void test_lost_frame_chunk_then_next_frame(void)
+{
+    setup();
+    host_station_init_epd(&st);
+
+    /* The frame's first DMA transfer (the 0x24 data chunk) never completes */
+    host_sim_fault_lose_completion(1u);
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    submit(0, SPI_BUS_PRIO_HIGH);
+    CHECK(host_sim_run_until(queue_idle, NULL, SPI_BUS_MANAGER_DMA_TIMEOUT_MS + 500u));
+    CHECK_EQ(outcome[0], 'd');
+    CHECK_EQ(st.mgr.recoveries, 1);
+    CHECK((HOST_STATION_DISP_CS_PORT->ODR & HOST_STATION_DISP_CS_PIN) != 0u);
+    CHECK(host_sim_run_until(host_station_idle, &st, 1000u));
+
+    /* The bus works again: a full frame goes out */
+    host_sim_wire_clear();
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(upload_done, NULL, 100u));
+    CHECK(host_sim_run_until(host_station_idle, &st, 1000u));
+    CHECK_EQ(st.mgr.recoveries, 1);
+    CHECK_EQ(host_sim_get_stats()->cs_conflicts, 0);
+}
+
+static bool upload_on_wire(void *user)
+{
+    (void)user;
+    /* Past the first chunk, the next one in flight */
+    return st.mgr.busy && !st.mgr.hq_active && st.mgr.chunk_off != 0u;
+}
+
+static void test_cancel_stops_transfer_on_wire(void)
+{
+    setup();
+    host_station_init_epd(&st);
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(upload_on_wire, NULL, 100u));
+    const uint32_t completions = host_sim_get_stats()->completions;
+    CHECK_EQ(epd3in7_driver_cancel_frame_dma(&st.epd, &st.mgr, NULL), EPD3IN7_DRIVER_OK);
+
+    /* Stopped with interrupts on, CS released after the wire, no completion for the aborted chunk */
+    CHECK_EQ(host_sim_get_stats()->aborts, 1);
+    CHECK_EQ(host_sim_get_stats()->masked_resets, 0);
+    CHECK((HOST_STATION_DISP_CS_PORT->ODR & HOST_STATION_DISP_CS_PIN) != 0u);
+    CHECK(host_sim_run_until(host_station_idle, &st, 1000u));
+
+    submit(0, SPI_BUS_PRIO_NORMAL);
+    CHECK(host_sim_run_until(queue_idle, NULL, 10u));
+    CHECK_EQ(outcome[0], 'd');
+    CHECK_EQ(host_sim_get_stats()->completions, completions + 1u);
+    CHECK_EQ(host_sim_get_stats()->dma_overlaps, 0);
+    CHECK_EQ(host_sim_get_stats()->cs_conflicts, 0);
+    CHECK_EQ(st.mgr.recoveries, 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_lost_completion_recovers);
+    RUN_TEST(test_lost_completion_on_priority_lane);
+    RUN_TEST(test_refused_start_fails_item_only);
+    RUN_TEST(test_error_irq_fails_item_only);
+    RUN_TEST(test_stalled_chain_segment_fails_item_only);
+    RUN_TEST(test_stalled_program_op_fails_item_only);
+    RUN_TEST(test_lost_frame_chunk_then_next_frame);
+    RUN_TEST(test_cancel_stops_transfer_on_wire);
+    return HOST_TEST_RESULT();
+}
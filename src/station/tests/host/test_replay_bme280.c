@@ -0,0 +1,195 @@
+/* Replays bme280_async burst reads on the simulated SPI2, alone and in the middle of an EPD frame. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+#include "shared/drivers/bme280_async.h"
+
+/* Calibration globals of bmpxx80.c (not part of the host build), datasheet example values */
+uint16_t t1 = 27504, p1 = 36477;
+int16_t t2 = 26435, t3 = -1000, p2 = -10685, p3 = 3024, p4 = 2855, p5 = 140, p6 = -7, p7 = 15500, p8 = -14600, p9 = 6000;
+uint8_t h1, h3;
+int8_t h6;
+int16_t h2, h4, h5;
+int32_t t_fine;
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+
+/* 64-bit integer compensation of the datasheet example (the float variant gives 100653 Pa) */
+#define EXPECTED_PA 100656
+
+static host_station st;
+static bme280_async bme;
+static uint8_t image[FRAME_BYTES];
+static host_sim_command cmds[64];
+static uint8_t data[FRAME_BYTES + 1024];
+
+/* Burst from 0xF7: press (adc_P = 415148), temp (adc_T = 519888), hum */
+static const uint8_t bme_regs[8] = {0x65, 0x59, 0xC0, 0x7E, 0xED, 0x00, 0x00, 0x00};
+
+static uint8_t bme_respond(void *user, uint32_t index, uint8_t tx)
+{
+    (void)user;
+    (void)tx;
+    return (index >= 1u && index <= 8u) ? bme_regs[index - 1u] : 0x00u;
+}
+
+static void setup(void)
+{
+    host_station_setup(&st, 512, true);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, bme_respond, NULL);
+    bme280_async_init(&bme, &st.mgr,
+                      (spi_bus_gpio){.port = HOST_STATION_BME_CS_PORT, .pin = HOST_STATION_BME_CS_PIN, .active_low = true},
+                      SPI2->CR1, SPI2->CR2);
+}
+
+static bool bme_done(void *user)
+{
+    return !bme280_async_is_busy((const bme280_async *)user);
+}
+
+/* Index of the first wire byte of @p dev, count of its bytes in @p n */
+static uint32_t find_device_bytes(uint8_t dev, uint32_t *n)
+{
+    uint32_t count;
+    const host_sim_wire_byte *w = host_sim_wire(&count);
+    uint32_t first = count;
+    *n = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (w[i].dev != dev)
+            continue;
+        if (first == count)
+            first = i;
+        (*n)++;
+    }
+    return first;
+}
+
+static void test_burst_read(void)
+{
+    setup();
+    CHECK(!bme.error);
+    CHECK_EQ(spi_bus_manager_device_sclk_hz(&st.mgr, bme.bus_dev_id), 8000000);
+
+    CHECK(bme280_async_trigger_read(&bme));
+    CHECK(host_sim_run_until(bme_done, &bme, 10u));
+    CHECK(bme280_async_has_data(&bme));
+
+    bme280_measurement m = bme280_async_get_last(&bme);
+    CHECK(m.valid);
+    CHECK(m.temperature > 25.07f && m.temperature < 25.09f);
+    CHECK_EQ(m.pressure, EXPECTED_PA);
+
+    uint32_t n;
+    uint32_t first = find_device_bytes(HOST_STATION_DEV_BME, &n);
+    CHECK_EQ(n, 9);
+    uint32_t count;
+    const host_sim_wire_byte *w = host_sim_wire(&count);
+    if (n == 9)
+    {
+        CHECK_EQ(w[first].byte, 0xF7);
+        for (uint32_t i = 1; i < 9; ++i)
+            CHECK_EQ(w[first + i].byte, 0x00);
+    }
+    CHECK_EQ(host_sim_get_stats()->cs_conflicts, 0);
+}
+
+static bool frame_on_wire(void *user)
+{
+    (void)user;
+    uint32_t count;
+    (void)host_sim_wire(&count);
+    return count > 6000u;
+}
+
+static void test_read_during_frame(void)
+{
+    setup();
+    host_station_init_epd(&st);
+    host_sim_wire_clear();
+    for (uint32_t i = 0; i < FRAME_BYTES; ++i)
+        image[i] = (uint8_t)(i ^ (i >> 7));
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(frame_on_wire, NULL, 100u));
+    CHECK(bme280_async_trigger_read(&bme));
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+    CHECK(!bme280_async_is_busy(&bme));
+    CHECK_EQ(bme280_async_get_last(&bme).pressure, EXPECTED_PA);
+
+    /* The read slotted in between two chunks: its 9 bytes are back to back, under its own CS */
+    uint32_t n;
+    uint32_t first = find_device_bytes(HOST_STATION_DEV_BME, &n);
+    CHECK_EQ(n, 9);
+    uint32_t count;
+    const host_sim_wire_byte *w = host_sim_wire(&count);
+    for (uint32_t i = first; i < first + n && i < count; ++i)
+        CHECK_EQ(w[i].dev, HOST_STATION_DEV_BME);
+
+    /* ... before the end of the frame, and the frame arrived intact */
+    uint32_t cn = host_sim_decode(HOST_STATION_DEV_EPD, 0, cmds, 64, data, sizeof(data));
+    CHECK_EQ(cn, 7);
+    if (cn == 7)
+    {
+        CHECK_EQ(cmds[4].cmd, 0x24);
+        CHECK_EQ(cmds[4].len, FRAME_BYTES);
+        CHECK_MEM(&data[cmds[4].first], image, FRAME_BYTES);
+        CHECK(first < count && w[first].t_ns < cmds[5].t_ns);
+    }
+
+    const host_sim_stats *s = host_sim_get_stats();
+    CHECK_EQ(s->cs_conflicts, 0);
+    CHECK_EQ(s->bytes_without_cs, 0);
+    CHECK_EQ(s->dma_overlaps, 0);
+}
+
+static void test_reinit_keeps_profile(void)
+{
+    setup();
+    const uint8_t id = bme.bus_dev_id;
+    const uint8_t devices = st.mgr.device_count;
+    bme280_async_init(&bme, &st.mgr,
+                      (spi_bus_gpio){.port = HOST_STATION_BME_CS_PORT, .pin = HOST_STATION_BME_CS_PIN, .active_low = true},
+                      SPI2->CR1, SPI2->CR2);
+    CHECK(bme.registered);
+    CHECK_EQ(bme.bus_dev_id, id);
+    CHECK_EQ(st.mgr.device_count, devices);
+    CHECK(bme280_async_trigger_read(&bme));
+    CHECK(host_sim_run_until(bme_done, &bme, 10u));
+    CHECK_EQ(bme280_async_get_last(&bme).pressure, EXPECTED_PA);
+}
+
+static void test_unregistered_does_not_submit(void)
+{
+    static spi_bus_device others[SPI_BUS_MANAGER_MAX_DEVICES];
+    uint8_t id;
+    host_station_setup(&st, 512, true);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, bme_respond, NULL);
+    for (uint32_t i = 0; i < SPI_BUS_MANAGER_MAX_DEVICES; ++i)
+    {
+        others[i] = (spi_bus_device){.cs = {HOST_STATION_DISP_CS_PORT, HOST_STATION_DISP_CS_PIN, true},
+                                     .cr1 = SPI2->CR1, .cr2 = SPI2->CR2};
+        (void)spi_bus_manager_add_device(&st.mgr, &others[i], &id);
+    }
+
+    /* Manager full: no profile, and no read goes out on another device's id */
+    bme280_async_init(&bme, &st.mgr,
+                      (spi_bus_gpio){.port = HOST_STATION_BME_CS_PORT, .pin = HOST_STATION_BME_CS_PIN, .active_low = true},
+                      SPI2->CR1, SPI2->CR2);
+    CHECK(bme.error);
+    CHECK(!bme.registered);
+    CHECK(!bme280_async_trigger_read(&bme));
+    CHECK(bme.error);
+    CHECK(!bme280_async_is_busy(&bme));
+    host_sim_run_ms(5u);
+    CHECK_EQ(host_sim_get_stats()->dma_starts, 0);
+}
+
+int main(void)
+{
+    RUN_TEST(test_burst_read);
+    RUN_TEST(test_read_during_frame);
+    RUN_TEST(test_reinit_keeps_profile);
+    RUN_TEST(test_unregistered_does_not_submit);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,229 @@
+/* Replays the EPD traffic of the DMA drivers on the simulated SPI2 and checks what reached the
+   panel: command order, RAM window, frame payload and BUSY handling. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+#define ROW_BYTES (EPD3IN7_WIDTH / 8)
+
+static host_station st;
+static uint8_t image[FRAME_BYTES];
+static host_sim_command cmds[512];
+static uint8_t data[64 * 1024];
+
+static void fill_image(uint8_t seed)
+{
+    for (uint32_t i = 0; i < FRAME_BYTES; ++i)
+        image[i] = (uint8_t)(i * 7u + seed + (i >> 8));
+}
+
+static uint32_t decode_epd(uint32_t from)
+{
+    return host_sim_decode(HOST_STATION_DEV_EPD, from, cmds, 512, data, sizeof(data));
+}
+
+static void check_command(const host_sim_command *c, uint8_t cmd, const uint8_t *expect, uint32_t len)
+{
+    CHECK_EQ(c->cmd, cmd);
+    CHECK_EQ(c->len, len);
+    if (c->len == len && len)
+        CHECK_MEM(&data[c->first], expect, len);
+}
+
+static void check_bus_clean(void)
+{
+    const host_sim_stats *s = host_sim_get_stats();
+    CHECK_EQ(s->cs_conflicts, 0);
+    CHECK_EQ(s->bytes_without_cs, 0);
+    CHECK_EQ(s->dma_overlaps, 0);
+    CHECK_EQ(host_sim_panel_busy_violations(), 0);
+}
+
+static void test_init_1_gray_dma(void)
+{
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    CHECK(host_station_idle(&st));
+
+    uint32_t n = decode_epd(0);
+    static const uint8_t expect[] = {0x12, 0x46, 0x47, 0x01, 0x03, 0x04, 0x11, 0x3C, 0x0C, 0x18,
+                                     0x2C, 0x37, 0x44, 0x45, 0x22};
+    CHECK_EQ(n, sizeof(expect));
+    for (uint32_t i = 0; i < n && i < sizeof(expect); ++i)
+        CHECK_EQ(cmds[i].cmd, expect[i]);
+
+    /* RES# pulse and settle (10 + 10 ms), no fixed 300 ms waits */
+    printf("  first command at %.3f ms, init done at %.3f ms\n", cmds[0].t_ns / 1e6, cmds[n - 1].t_ns / 1e6);
+    CHECK(cmds[0].t_ns >= 20ull * 1000000u);
+    CHECK(cmds[0].t_ns < 21ull * 1000000u);
+    /* Nothing is sent while the controller is still resetting; the BUSY edge ends the wait */
+    CHECK(cmds[1].t_ns - cmds[0].t_ns >= 5ull * 1000000u);
+    CHECK(cmds[1].t_ns - cmds[0].t_ns < 5ull * 1000000u + 100000u);
+    CHECK_EQ(data[cmds[1].first], 0xF7);
+    CHECK_EQ(data[cmds[14].first], 0xCF);
+    /* RESET released (active low) */
+    CHECK(HOST_STATION_DISP_RST_PORT->ODR & HOST_STATION_DISP_RST_PIN);
+    check_bus_clean();
+}
+
+static void test_display_1_gray_dma(void)
+{
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    host_sim_wire_clear();
+    fill_image(3);
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+
+    uint32_t n = decode_epd(0);
+    CHECK_EQ(n, 7);
+    if (n == 7)
+    {
+        check_command(&cmds[0], 0x44, (const uint8_t[]){0x00, 0x00, 0x17, 0x01}, 4);
+        check_command(&cmds[1], 0x45, (const uint8_t[]){0x00, 0x00, 0xDF, 0x01}, 4);
+        check_command(&cmds[2], 0x4E, (const uint8_t[]){0x00}, 1);
+        check_command(&cmds[3], 0x4F, (const uint8_t[]){0x00, 0x00}, 2);
+        check_command(&cmds[4], 0x24, image, FRAME_BYTES);
+        CHECK_EQ(cmds[5].cmd, 0x32);
+        CHECK_EQ(cmds[5].len, 105);
+        check_command(&cmds[6], 0x20, NULL, 0);
+    }
+
+    /* The frame went by DMA in 512-byte chunks */
+    uint32_t count;
+    const host_sim_wire_byte *w = host_sim_wire(&count);
+    uint32_t dma_bytes = 0;
+    for (uint32_t i = 0; i < count; ++i)
+        dma_bytes += w[i].dma;
+    CHECK(dma_bytes >= FRAME_BYTES);
+    CHECK(host_sim_get_stats()->dma_starts >= FRAME_BYTES / 512u);
+    check_bus_clean();
+}
+
+static void test_second_frame_waits_for_busy(void)
+{
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    host_sim_wire_clear();
+    fill_image(5);
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(host_station_idle, &st, 3000u));
+
+    /* LUT is cached: the second frame has no 0x32 */
+    uint32_t n = decode_epd(0);
+    CHECK_EQ(n, 13);
+    if (n == 13)
+    {
+        CHECK_EQ(cmds[6].cmd, 0x20);
+        CHECK_EQ(cmds[7].cmd, 0x44);
+        CHECK_EQ(cmds[12].cmd, 0x20);
+        CHECK(cmds[7].t_ns - cmds[6].t_ns >= (uint64_t)HOST_STATION_REFRESH_MS * 1000000u);
+        check_command(&cmds[11], 0x24, image, FRAME_BYTES);
+    }
+    check_bus_clean();
+}
+
+/* Stream producer: rows of the source rectangle, packed */
+typedef struct
+{
+    const uint8_t *src;
+    uint16_t src_stride;
+    uint16_t y0;
+    uint32_t calls;
+} stream_source;
+
+static void stream_fill(void *user, uint16_t row, uint16_t rows, uint8_t *dst)
+{
+    stream_source *s = (stream_source *)user;
+    s->calls++;
+    memcpy(dst, s->src + (size_t)(row - s->y0) * s->src_stride, (size_t)rows * s->src_stride);
+}
+
+static uint8_t bands[2 * 14 * ROW_BYTES];
+
+static void test_stream_full_frame_matches_dma(void)
+{
+    fill_image(9);
+
+    /* Reference: whole-frame DMA */
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    host_sim_wire_clear();
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_A2), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+    static host_sim_command ref_cmds[16];
+    static uint8_t ref_data[FRAME_BYTES + 256];
+    uint32_t ref_n = host_sim_decode(HOST_STATION_DEV_EPD, 0, ref_cmds, 16, ref_data, sizeof(ref_data));
+
+    /* Same frame streamed in 14-row bands (490 bytes, about one chunk) */
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    host_sim_wire_clear();
+    stream_source src = {image, ROW_BYTES, 0, 0};
+    const epd3in7_driver_area full = {0, 0, EPD3IN7_WIDTH, EPD3IN7_HEIGHT};
+    CHECK_EQ(epd3in7_driver_display_1_gray_stream_dma(&st.epd, &st.mgr, &full, bands, sizeof(bands) / 2, 14,
+                                                      stream_fill, &src, EPD3IN7_DRIVER_MODE_A2),
+             EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+
+    uint32_t n = decode_epd(0);
+    CHECK_EQ(n, ref_n);
+    for (uint32_t i = 0; i < n && i < ref_n; ++i)
+    {
+        CHECK_EQ(cmds[i].cmd, ref_cmds[i].cmd);
+        CHECK_EQ(cmds[i].len, ref_cmds[i].len);
+        if (cmds[i].len == ref_cmds[i].len)
+            CHECK_MEM(&data[cmds[i].first], &ref_data[ref_cmds[i].first], cmds[i].len);
+    }
+    CHECK_EQ(src.calls, (EPD3IN7_HEIGHT + 13) / 14);
+    check_bus_clean();
+}
+
+static void test_stream_area(void)
+{
+    host_station_setup(&st, 512, true);
+    host_station_init_epd(&st);
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+    host_sim_wire_clear();
+
+    /* 80 x 50 rectangle at (40, 100), 10 bytes per row, 4-row bands */
+    static uint8_t rect[10 * 50];
+    for (uint32_t i = 0; i < sizeof(rect); ++i)
+        rect[i] = (uint8_t)(0xA5 ^ i);
+    stream_source src = {rect, 10, 100, 0};
+    const epd3in7_driver_area area = {40, 100, 80, 50};
+    CHECK_EQ(epd3in7_driver_display_1_gray_stream_dma(&st.epd, &st.mgr, &area, bands, 40, 4,
+                                                      stream_fill, &src, EPD3IN7_DRIVER_MODE_A2),
+             EPD3IN7_DRIVER_OK);
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+
+    uint32_t n = decode_epd(0);
+    CHECK_EQ(n, 7);
+    if (n == 7)
+    {
+        check_command(&cmds[0], 0x44, (const uint8_t[]){0x28, 0x00, 0x77, 0x00}, 4);
+        check_command(&cmds[1], 0x45, (const uint8_t[]){0x64, 0x00, 0x95, 0x00}, 4);
+        check_command(&cmds[2], 0x4E, (const uint8_t[]){0x28, 0x00}, 2);
+        check_command(&cmds[3], 0x4F, (const uint8_t[]){0x64, 0x00}, 2);
+        check_command(&cmds[4], 0x24, rect, sizeof(rect));
+        CHECK_EQ(cmds[5].cmd, 0x32);
+        check_command(&cmds[6], 0x20, NULL, 0);
+    }
+    CHECK_EQ(src.calls, 13);
+    check_bus_clean();
+}
+
+int main(void)
+{
+    RUN_TEST(test_init_1_gray_dma);
+    RUN_TEST(test_display_1_gray_dma);
+    RUN_TEST(test_second_frame_waits_for_busy);
+    RUN_TEST(test_stream_full_frame_matches_dma);
+    RUN_TEST(test_stream_area);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,105 @@
+/* Worst-case latency of a 9-byte sensor read (BME280 burst) submitted while an EPD frame is queued,
+   with and without the high-priority lane and chunking. The read is triggered at every 250 us
+   offset across the frame upload; latency is submit to on_done. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+#define OFFSET_STEP_NS 250000u
+#define OFFSET_END_NS 10000000u
+
+static host_station st;
+static uint8_t image[FRAME_BYTES];
+static spi_bus_device bme;
+static uint8_t tx[9] = {0xF7}, rx[9];
+static volatile uint64_t done_ns;
+
+static void on_read(spi_bus_manager *mgr, void *user)
+{
+    (void)mgr;
+    (void)user;
+    done_ns = host_sim_now_ns();
+}
+
+static const spi_bus_callbacks bme_cbs = {.on_done = on_read};
+
+static bool read_done(void *user)
+{
+    (void)user;
+    return done_ns != 0u;
+}
+
+static bool reached(void *user)
+{
+    return host_sim_now_ns() >= *(const uint64_t *)user;
+}
+
+/* Latency of one read submitted @p offset_ns after the frame */
+static uint64_t read_latency(uint16_t chunk, bool priority, uint64_t offset_ns)
+{
+    host_station_setup(&st, chunk, priority);
+    bme = (spi_bus_device){.cs = {HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, true},
+                           .cr1 = SPI2->CR1, .cr2 = SPI2->CR2, .max_sclk_hz = 10000000u,
+                           .spi_timeout = HAL_MAX_DELAY, .cb = &bme_cbs};
+    uint8_t id;
+    CHECK_EQ(spi_bus_manager_add_device(&st.mgr, &bme, &id), SPI_BUS_MANAGER_OK);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, NULL, NULL);
+    host_station_init_epd(&st);
+
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    uint64_t at = host_sim_now_ns() + offset_ns;
+    (void)host_sim_run_until(reached, &at, 100u);
+
+    done_ns = 0u;
+    const spi_bus_transaction t = {.tx = tx, .rx = rx, .len = 9, .dev = id, .kind = SPI_BUS_ITEM_TX,
+                                   .dir = SPI_BUS_DIR_TXRX, .priority = SPI_BUS_PRIO_HIGH};
+    const uint64_t t0 = host_sim_now_ns();
+    CHECK_EQ(spi_bus_manager_submit(&st.mgr, &t), SPI_BUS_MANAGER_OK);
+    CHECK(host_sim_run_until(read_done, NULL, 2000u));
+    const uint64_t latency = done_ns - t0;
+
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+    const host_sim_stats *s = host_sim_get_stats();
+    CHECK_EQ(s->cs_conflicts, 0);
+    CHECK_EQ(s->bytes_without_cs, 0);
+    CHECK_EQ(host_sim_panel_busy_violations(), 0);
+    return latency;
+}
+
+static uint64_t worst_latency(const char *label, uint16_t chunk, bool priority)
+{
+    uint64_t worst = 0;
+    for (uint64_t off = 0; off <= OFFSET_END_NS; off += OFFSET_STEP_NS)
+    {
+        const uint64_t l = read_latency(chunk, priority, off);
+        if (l > worst)
+            worst = l;
+    }
+    printf("  %-28s worst sensor read latency %9.3f ms\n", label, worst / 1e6);
+    return worst;
+}
+
+static void test_sensor_read_latency(void)
+{
+    const uint64_t fifo = worst_latency("one lane, no chunking", 0, false);
+    const uint64_t prio = worst_latency("priority lane, no chunking", 0, true);
+    const uint64_t both = worst_latency("priority lane + 512 chunks", 512, true);
+
+    /* Before: the read waits for the frame, the LUT and the refresh (BUSY) */
+    CHECK(fifo >= (uint64_t)HOST_STATION_REFRESH_MS * 1000000u);
+    /* Priority alone: at most one whole 16800-byte transfer (8.4 ms at 16 MHz) */
+    CHECK(prio < 10000000u);
+    /* Priority + chunks: at most one 512-byte chunk (256 us) plus the read itself */
+    CHECK(both < 500000u);
+    CHECK(both < prio && prio < fifo);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < FRAME_BYTES; ++i)
+        image[i] = (uint8_t)(i * 5u);
+
+    RUN_TEST(test_sensor_read_latency);
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,147 @@
+/* Multi-producer stress of the lock-free submit rings (LDREXH/STREXH) on the single-core model of
+   sim/host_sim_mt.c: three thread contexts submit to both lanes while the completion interrupt
+   retires items and submits follow-ups of its own. Every item must complete exactly once and in
+   submit order per producer and lane; no DMA may start while one is in flight. */
+
+#include "sim/host_sim_mt.h"
+#include "sim/host_test.h"
+#include "shared/drivers/spi_bus_manager.h"
+
+#define PRODUCERS 3
+#define ISR_PRODUCER PRODUCERS
+#define ITEMS_PER_PRODUCER 5000u
+#define ISR_FOLLOW_UP_EVERY 64u
+
+static SPI_HandleTypeDef hspi;
+static spi_bus_manager mgr;
+static spi_bus_transaction storage[16];
+static spi_bus_transaction prio_storage[8];
+static spi_bus_device dev;
+static uint8_t dev_id;
+static const uint8_t payload[4] = {0xA5, 0x5A, 0x01, 0x02};
+
+static uint32_t submitted[PRODUCERS + 1][2];
+static uint32_t expected[PRODUCERS + 1][2];
+static uint32_t completions;
+static uint32_t order_errors;
+static uint32_t full_retries;
+static uint32_t isr_dropped;
+
+/* user = producer << 24 | lane << 23 | sequence within that producer's lane */
+static void *encode(uint32_t producer, uint32_t lane, uint32_t seq)
+{
+    return (void *)(uintptr_t)((producer << 24) | (lane << 23) | seq);
+}
+
+static spi_bus_transaction item(uint32_t producer, uint32_t lane)
+{
+    return (spi_bus_transaction){.tx = payload, .len = sizeof(payload), .dev = dev_id,
+                                 .kind = SPI_BUS_ITEM_TX, .dir = SPI_BUS_DIR_TX,
+                                 .priority = lane ? SPI_BUS_PRIO_HIGH : SPI_BUS_PRIO_NORMAL,
+                                 .user = encode(producer, lane, submitted[producer][lane])};
+}
+
+static void on_done(spi_bus_manager *m, void *user)
+{
+    const uint32_t v = (uint32_t)(uintptr_t)user;
+    const uint32_t producer = v >> 24, lane = (v >> 23) & 1u, seq = v & 0x7FFFFFu;
+    if (producer > ISR_PRODUCER || seq != expected[producer][lane])
+        order_errors++;
+    else
+        expected[producer][lane]++;
+
+    /* Submit from the interrupt too, racing the producers it preempted */
+    if (++completions % ISR_FOLLOW_UP_EVERY == 0u)
+    {
+        const spi_bus_transaction t = item(ISR_PRODUCER, 0u);
+        if (spi_bus_manager_submit(m, &t) == SPI_BUS_MANAGER_OK)
+            submitted[ISR_PRODUCER][0]++;
+        else
+            isr_dropped++;
+    }
+}
+
+static const spi_bus_callbacks cbs = {.on_done = on_done};
+
+static void producer(void *user)
+{
+    const uint32_t id = (uint32_t)(uintptr_t)user;
+    for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; ++i)
+    {
+        const uint32_t lane = (i + id) & 1u;
+        for (;;)
+        {
+            const spi_bus_transaction t = item(id, lane);
+            const spi_bus_manager_status s = spi_bus_manager_submit(&mgr, &t);
+            if (s == SPI_BUS_MANAGER_OK)
+                break;
+            CHECK_EQ(s, SPI_BUS_MANAGER_ERR_FULL);
+            full_retries++;
+            host_sim_mt_point();
+        }
+        submitted[id][lane]++;
+    }
+}
+
+static void stress(uint64_t seed)
+{
+    host_sim_mt_reset(seed);
+    memset(submitted, 0, sizeof(submitted));
+    memset(expected, 0, sizeof(expected));
+    completions = order_errors = full_retries = isr_dropped = 0u;
+
+    hspi = (SPI_HandleTypeDef){0};
+    hspi.Instance = SPI2;
+    SPI2->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI | (4u << SPI_CR1_BR_Pos) | SPI_CR1_SPE;
+    SPI2->CR2 = (7u << SPI_CR2_DS_Pos) | SPI_CR2_FRXTH;
+    mgr = spi_bus_manager_create(&hspi, storage, (uint16_t)(sizeof(storage) / sizeof(storage[0])));
+    spi_bus_manager_set_priority_queue(&mgr, prio_storage, (uint16_t)(sizeof(prio_storage) / sizeof(prio_storage[0])));
+    spi_bus_manager_register(&mgr);
+    dev = (spi_bus_device){.cs = {GPIOA, GPIO_PIN_4, true}, .cr1 = SPI2->CR1, .cr2 = SPI2->CR2,
+                           .spi_timeout = HAL_MAX_DELAY, .cb = &cbs};
+    CHECK_EQ(spi_bus_manager_add_device(&mgr, &dev, &dev_id), SPI_BUS_MANAGER_OK);
+
+    pthread_t threads[PRODUCERS];
+    for (uint32_t p = 0; p < PRODUCERS; ++p)
+        CHECK(host_sim_mt_spawn(producer, (void *)(uintptr_t)p, &threads[p]) > 0);
+    host_sim_mt_wait(threads, PRODUCERS);
+    while (!spi_bus_manager_is_idle(&mgr))
+        host_sim_wfi();
+
+    const host_sim_mt_stats *s = host_sim_mt_get_stats();
+    uint32_t total = 0u;
+    for (uint32_t p = 0; p <= ISR_PRODUCER; ++p)
+    {
+        for (uint32_t lane = 0; lane < 2u; ++lane)
+        {
+            CHECK_EQ(expected[p][lane], submitted[p][lane]);
+            total += submitted[p][lane];
+        }
+    }
+    CHECK_EQ(order_errors, 0);
+    CHECK_EQ(completions, total);
+    CHECK_EQ(total, PRODUCERS * ITEMS_PER_PRODUCER + submitted[ISR_PRODUCER][0]);
+    CHECK_EQ(s->dma_overlaps, 0);
+    CHECK(s->strex_failures > 0u);
+    printf("  seed %-4llu %u items (%u from ISR, %u dropped full), %llu switches, %llu interrupts, "
+           "%llu STREX retries, %u full retries\n",
+           (unsigned long long)seed, total, submitted[ISR_PRODUCER][0], isr_dropped,
+           (unsigned long long)s->switches, (unsigned long long)s->interrupts,
+           (unsigned long long)s->strex_failures, full_retries);
+
+    spi_bus_manager_unregister(&mgr);
+    host_sim_mt_finish();
+}
+
+static void test_submit_stress(void)
+{
+    static const uint64_t seeds[] = {1u, 7u, 42u, 1234u, 99991u};
+    for (uint32_t i = 0; i < sizeof(seeds) / sizeof(seeds[0]); ++i)
+        stress(seeds[i]);
+}
+
+int main(void)
+{
+    RUN_TEST(test_submit_stress);
+    return HOST_TEST_RESULT();
+}
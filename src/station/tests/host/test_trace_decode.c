@@ -0,0 +1,119 @@
+/* Trace decoder (tools/spi_trace_decode.c): ring unrolling, and transaction pairing checked against
+   a traced run on the host sim, sensor reads on the high-priority lane during a chunked EPD frame. */
+
+#include "sim/host_station.h"
+#include "sim/host_test.h"
+#include "tools/spi_trace_decode.h"
+
+#define FRAME_BYTES (EPD3IN7_WIDTH * EPD3IN7_HEIGHT / 8)
+#define READS 5u
+#define CYCLES_PER_US (HOST_SIM_CPU_HZ / 1000000u)
+
+static host_station st;
+static uint8_t image[FRAME_BYTES];
+static spi_bus_trace_record ordered[SPI_BUS_TRACE_DEPTH];
+static uint32_t read_latency_max;
+static uint32_t read_t0;
+static volatile uint32_t reads_done;
+
+static void test_unroll_wrapped_ring(void)
+{
+    spi_bus_trace_record ring[4];
+    spi_bus_trace_record out[4];
+    for (uint32_t i = 0; i < 4u; ++i)
+        ring[i] = (spi_bus_trace_record){.stamp = i};
+    /* Six records written into four slots: the oldest valid one is record 2, in slot 2 */
+    ring[0].stamp = 4u;
+    ring[1].stamp = 5u;
+    CHECK_EQ(spi_trace_unroll(ring, 4u, 6u, out), 4);
+    for (uint32_t i = 0; i < 4u; ++i)
+        CHECK_EQ(out[i].stamp, i + 2u);
+    CHECK_EQ(spi_trace_unroll(ring, 4u, 3u, out), 3);
+    CHECK_EQ(out[2].stamp, 2);
+    CHECK(strcmp(spi_trace_event_name(SPI_BUS_TRACE_DONE | SPI_BUS_TRACE_HIGH_LANE), "DONE") == 0);
+}
+
+static void on_read(spi_bus_manager *mgr, void *user)
+{
+    (void)mgr;
+    (void)user;
+    const uint32_t l = host_sim_cycles() - read_t0;
+    if (l > read_latency_max)
+        read_latency_max = l;
+    reads_done++;
+}
+
+static bool read_done(void *user)
+{
+    return reads_done == *(const uint32_t *)user;
+}
+
+static void test_pairs_traced_run(void)
+{
+    static spi_bus_device bme;
+    static const spi_bus_callbacks cbs = {.on_done = on_read};
+    static uint8_t tx[9] = {0xF7}, rx[9];
+
+    host_station_setup(&st, 512, true);
+    bme = (spi_bus_device){.cs = {HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, true},
+                           .cr1 = SPI2->CR1, .cr2 = SPI2->CR2, .max_sclk_hz = 10000000u,
+                           .spi_timeout = HAL_MAX_DELAY, .cb = &cbs};
+    uint8_t id;
+    CHECK_EQ(spi_bus_manager_add_device(&st.mgr, &bme, &id), SPI_BUS_MANAGER_OK);
+    host_sim_attach_device(HOST_STATION_DEV_BME, HOST_STATION_BME_CS_PORT, HOST_STATION_BME_CS_PIN, NULL, NULL);
+    host_station_init_epd(&st);
+
+    g_spi_trace_pos = 0u;
+    reads_done = 0u;
+    read_latency_max = 0u;
+    CHECK_EQ(epd3in7_driver_display_1_gray_dma(&st.epd, &st.mgr, image, EPD3IN7_DRIVER_MODE_GC), EPD3IN7_DRIVER_OK);
+    for (uint32_t i = 0; i < READS; ++i)
+    {
+        /* One read at a time, 1 ms apart, so the measured latency is per read */
+        host_sim_run_ms(1u);
+        const spi_bus_transaction t = {.tx = tx, .rx = rx, .len = 9, .dev = id, .kind = SPI_BUS_ITEM_TX,
+                                       .dir = SPI_BUS_DIR_TXRX, .priority = SPI_BUS_PRIO_HIGH};
+        const uint32_t want = i + 1u;
+        read_t0 = host_sim_cycles();
+        CHECK_EQ(spi_bus_manager_submit(&st.mgr, &t), SPI_BUS_MANAGER_OK);
+        CHECK(host_sim_run_until(read_done, (void *)&want, 5u));
+    }
+    CHECK(host_sim_run_until(host_station_idle, &st, 2000u));
+
+    const uint32_t pos = g_spi_trace_pos;
+    CHECK(pos <= SPI_BUS_TRACE_DEPTH);
+    const uint32_t n = spi_trace_unroll(g_spi_trace, SPI_BUS_TRACE_DEPTH, pos, ordered);
+    spi_trace_summary s;
+    spi_trace_summarize(ordered, n, pos - n, &s);
+    spi_trace_print_summary(stdout, &s, CYCLES_PER_US);
+
+    const spi_trace_lane_stats *hi = &s.lane[1];
+    CHECK_EQ(hi->pushed, READS);
+    CHECK_EQ(hi->completed, READS);
+    CHECK_EQ(hi->failed, 0);
+    CHECK_EQ(hi->unmatched, 0);
+    CHECK_EQ(hi->total.count, READS);
+    /* PUSH..DONE brackets submit..on_done: same worst case within a few microseconds */
+    CHECK(hi->total.max <= read_latency_max);
+    CHECK(read_latency_max - hi->total.max < 5u * CYCLES_PER_US);
+    CHECK(hi->queue.max + hi->service.max >= hi->total.max);
+
+    /* The frame items all retire; none is left open or unmatched */
+    const spi_trace_lane_stats *lo = &s.lane[0];
+    CHECK(lo->pushed > 0u);
+    CHECK_EQ(lo->completed + lo->failed, lo->pushed);
+    CHECK_EQ(lo->failed, 0);
+    CHECK_EQ(lo->unmatched, 0);
+    CHECK_EQ(s.errors, 0);
+    CHECK(s.interrupts > 0u);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < FRAME_BYTES; ++i)
+        image[i] = (uint8_t)(i * 7u);
+
+    RUN_TEST(test_unroll_wrapped_ring);
+    RUN_TEST(test_pairs_traced_run);
+    return HOST_TEST_RESULT();
+}
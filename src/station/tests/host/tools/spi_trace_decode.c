@@ -0,0 +1,177 @@
+#include "spi_trace_decode.h"
+#include <string.h>
+
+#define EV(r) ((uint8_t)((r)->event & ~SPI_BUS_TRACE_HIGH_LANE))
+#define LANE(r) (((r)->event & SPI_BUS_TRACE_HIGH_LANE) ? 1u : 0u)
+
+/* Slots of a lane are ring indices (uint16_t) */
+#define SLOTS 65536u
+
+typedef struct
+{
+    uint32_t push;
+    uint32_t start;
+    bool open;
+    bool started;
+} trace_item;
+
+static const char *const trace_names[] = {
+    "MARK", "PUSH", "FULL", "REJECT", "START", "CHAIN", "SEG_PIO", "SEG_DMA",
+    "CALLBACK", "HALF", "CPLT", "CHUNK", "PARK", "DONE", "WAIT_TIMEOUT", "FAIL",
+    "HAL_ERROR", "CANCEL", "WATCHDOG", "LEASE", "RELEASE", "PROGRAM", "RESUME", "ABORT"};
+
+uint32_t spi_trace_unroll(const spi_bus_trace_record *ring, uint32_t depth, uint32_t pos,
+                          spi_bus_trace_record *out)
+{
+    const uint32_t n = (pos < depth) ? pos : depth;
+    const uint32_t first = pos - n;
+    for (uint32_t i = 0; i < n; ++i)
+        out[i] = ring[(first + i) & (depth - 1u)];
+    return n;
+}
+
+const char *spi_trace_event_name(uint8_t event)
+{
+    event &= (uint8_t)~SPI_BUS_TRACE_HIGH_LANE;
+    return (event < sizeof(trace_names) / sizeof(trace_names[0])) ? trace_names[event] : "?";
+}
+
+void spi_trace_print_timeline(FILE *f, const spi_bus_trace_record *r, uint32_t n, uint32_t cycles_per_us)
+{
+    if (cycles_per_us == 0u)
+        cycles_per_us = 1u;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const uint32_t since = r[i].stamp - r[0].stamp;
+        const uint32_t delta = i ? r[i].stamp - r[i - 1].stamp : 0u;
+        fprintf(f, "%12.3f %+10.3f  %c %-12s arg %3u  head %5u  tail %5u  len %5u\n",
+                (double)since / cycles_per_us, (double)delta / cycles_per_us, LANE(&r[i]) ? 'H' : 'N',
+                spi_trace_event_name(r[i].event), r[i].arg, r[i].head, r[i].tail, r[i].len);
+    }
+}
+
+static void latency_add(spi_trace_latency *l, uint32_t v)
+{
+    if (l->count == 0u || v < l->min)
+        l->min = v;
+    if (v > l->max)
+        l->max = v;
+    l->sum += v;
+    l->count++;
+}
+
+static void retire(spi_trace_lane_stats *ls, trace_item *it, uint32_t stamp, bool ok)
+{
+    if (!it->open)
+    {
+        ls->unmatched++;
+        return;
+    }
+    if (ok)
+        ls->completed++;
+    else
+        ls->failed++;
+    if (it->started)
+        latency_add(&ls->service, stamp - it->start);
+    else
+        latency_add(&ls->queue, stamp - it->push); /* Failed before it reached the wire */
+    latency_add(&ls->total, stamp - it->push);
+    it->open = false;
+}
+
+void spi_trace_summarize(const spi_bus_trace_record *r, uint32_t n, uint32_t lost, spi_trace_summary *s)
+{
+    static trace_item items[2][SLOTS];
+    memset(items, 0, sizeof(items));
+    memset(s, 0, sizeof(*s));
+    s->records = n;
+    s->lost = lost;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const uint32_t lane = LANE(&r[i]);
+        spi_trace_lane_stats *ls = &s->lane[lane];
+        trace_item *it = &items[lane][r[i].head];
+
+        switch (EV(&r[i]))
+        {
+        case SPI_BUS_TRACE_PUSH:
+            ls->pushed++;
+            *it = (trace_item){.push = r[i].stamp, .open = true};
+            break;
+        case SPI_BUS_TRACE_START:
+        case SPI_BUS_TRACE_CHAIN:
+        case SPI_BUS_TRACE_PROGRAM:
+            /* START repeats per chunk and PROGRAM per resumed op: only the first one counts */
+            if (it->open && !it->started)
+            {
+                it->started = true;
+                it->start = r[i].stamp;
+                latency_add(&ls->queue, it->start - it->push);
+            }
+            break;
+        case SPI_BUS_TRACE_CALLBACK:
+            /* Runs and retires in one go, no DONE follows */
+            if (it->open)
+            {
+                latency_add(&ls->queue, r[i].stamp - it->push);
+                it->started = true;
+                it->start = r[i].stamp;
+            }
+            retire(ls, it, r[i].stamp, true);
+            break;
+        case SPI_BUS_TRACE_DONE:
+            retire(ls, it, r[i].stamp, true);
+            break;
+        case SPI_BUS_TRACE_FAIL:
+        case SPI_BUS_TRACE_WAIT_TIMEOUT:
+            retire(ls, it, r[i].stamp, false);
+            break;
+        case SPI_BUS_TRACE_ABORT:
+            /* Started head dropped by cancel(): neither done nor failed */
+            it->open = false;
+            break;
+        case SPI_BUS_TRACE_HALF:
+        case SPI_BUS_TRACE_CPLT:
+            s->interrupts++;
+            break;
+        case SPI_BUS_TRACE_HAL_ERROR:
+        case SPI_BUS_TRACE_WATCHDOG:
+            s->errors++;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void print_latency(FILE *f, const char *name, const spi_trace_latency *l, uint32_t cycles_per_us)
+{
+    if (l->count == 0u)
+    {
+        fprintf(f, "    %-8s -\n", name);
+        return;
+    }
+    fprintf(f, "    %-8s n %6u  min %10.3f  avg %10.3f  max %10.3f us\n", name, l->count,
+            (double)l->min / cycles_per_us, (double)l->sum / l->count / cycles_per_us,
+            (double)l->max / cycles_per_us);
+}
+
+void spi_trace_print_summary(FILE *f, const spi_trace_summary *s, uint32_t cycles_per_us)
+{
+    static const char *const lanes[2] = {"normal", "high"};
+    if (cycles_per_us == 0u)
+        cycles_per_us = 1u;
+    fprintf(f, "%u records (%u lost), %u interrupts, %u errors\n", s->records, s->lost, s->interrupts, s->errors);
+    for (uint32_t l = 0; l < 2u; ++l)
+    {
+        const spi_trace_lane_stats *ls = &s->lane[l];
+        if (ls->pushed == 0u && ls->completed == 0u && ls->failed == 0u)
+            continue;
+        fprintf(f, "  %s lane: %u pushed, %u done, %u failed, %u unmatched\n", lanes[l], ls->pushed,
+                ls->completed, ls->failed, ls->unmatched);
+        print_latency(f, "queue", &ls->queue, cycles_per_us);
+        print_latency(f, "service", &ls->service, cycles_per_us);
+        print_latency(f, "total", &ls->total, cycles_per_us);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+/**
+ * @file spi_trace_decode.h
+ * @brief Offline decoder of the bus manager's binary trace ring (SPI_BUS_MANAGER_DEBUG=1):
+ *        unrolls a g_spi_trace dump into chronological order, prints it as a timeline and pairs
+ *        PUSH -> START -> DONE of each transaction (same lane, same slot) into latency statistics.
+ */
+
+#include "shared/drivers/spi_bus_manager.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Latency summary of one lane, in trace stamp units (cycles, or ms on cores without DWT).
+     */
+    typedef struct
+    {
+        uint32_t count;     /**< Samples. */
+        uint32_t min;       /**< Smallest sample. */
+        uint32_t max;       /**< Largest sample. */
+        uint64_t sum;       /**< Sum of samples (mean = sum / count). */
+    } spi_trace_latency;
+
+    typedef struct
+    {
+        uint32_t pushed;           /**< PUSH records. */
+        uint32_t completed;        /**< Transactions retired with DONE (or run as callback items). */
+        uint32_t failed;           /**< Transactions retired with FAIL or WAIT_TIMEOUT. */
+        uint32_t unmatched;        /**< Retirements whose PUSH is older than the dump. */
+        spi_trace_latency queue;   /**< PUSH to first START / CHAIN / PROGRAM / CALLBACK. */
+        spi_trace_latency service; /**< First start to retirement (chunks, waits and parks included). */
+        spi_trace_latency total;   /**< PUSH to retirement. */
+    } spi_trace_lane_stats;
+
+    typedef struct
+    {
+        uint32_t records;              /**< Records decoded. */
+        uint32_t lost;                 /**< Records overwritten before the dump (ring wrapped). */
+        uint32_t interrupts;           /**< HALF + CPLT records. */
+        uint32_t errors;               /**< HAL_ERROR + WATCHDOG records. */
+        spi_trace_lane_stats lane[2];  /**< [0] normal lane, [1] high-priority lane. */
+    } spi_trace_summary;
+
+    /**
+     * @brief Copy the valid records of a trace ring into @p out, oldest first.
+     *
+     * @param ring   Dump of g_spi_trace.
+     * @param depth  Ring size in records (SPI_BUS_TRACE_DEPTH of the dumped build, power of two).
+     * @param pos    Value of g_spi_trace_pos at the time of the dump.
+     * @param out    Destination, room for @p depth records.
+     * @return       Number of records written (min(pos, depth)).
+     */
+    uint32_t spi_trace_unroll(const spi_bus_trace_record *ring, uint32_t depth, uint32_t pos,
+                              spi_bus_trace_record *out);
+
+    /** @brief Event name without the lane flag ("?" for unknown ids). */
+    const char *spi_trace_event_name(uint8_t event);
+
+    /**
+     * @brief Print one line per record: time since the first record in us, delta to the previous
+     *        record, lane, event and its fields.
+     *
+     * @param cycles_per_us Stamp units per microsecond (64 for DWT at 64 MHz).
+     */
+    void spi_trace_print_timeline(FILE *f, const spi_bus_trace_record *r, uint32_t n, uint32_t cycles_per_us);
+
+    /**
+     * @brief Pair the transactions of @p r (chronological) and collect latency statistics.
+     *
+     * @param lost Records lost before r[0] (from spi_trace_unroll(): pos - n), reported as is.
+     */
+    void spi_trace_summarize(const spi_bus_trace_record *r, uint32_t n, uint32_t lost, spi_trace_summary *s);
+
+    /** @brief Print @p s with latencies converted to microseconds. */
+    void spi_trace_print_summary(FILE *f, const spi_trace_summary *s, uint32_t cycles_per_us);
+
+#ifdef __cplusplus
+}
+#endif
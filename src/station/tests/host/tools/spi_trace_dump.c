@@ -0,0 +1,67 @@
+/* Decode a trace ring dumped from the target, e.g. with GDB:
+     dump binary value trace.bin g_spi_trace
+     print g_spi_trace_pos
+   then: spi_trace_dump trace.bin <g_spi_trace_pos> [cycles_per_us=64] [--summary] */
+
+#include "spi_trace_decode.h"
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <g_spi_trace.bin> <g_spi_trace_pos> [cycles_per_us] [--summary]\n", argv[0]);
+        return 2;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(in, 0, SEEK_END);
+    const long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    const uint32_t depth = (uint32_t)(size / (long)sizeof(spi_bus_trace_record));
+    if (depth == 0u || (depth & (depth - 1u)) != 0u)
+    {
+        fprintf(stderr, "%s: %ld bytes is not a power-of-two number of %zu-byte records\n", argv[1], size,
+                sizeof(spi_bus_trace_record));
+        fclose(in);
+        return 1;
+    }
+
+    spi_bus_trace_record *ring = malloc(2u * depth * sizeof(*ring));
+    if (!ring || fread(ring, sizeof(*ring), depth, in) != depth)
+    {
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        fclose(in);
+        free(ring);
+        return 1;
+    }
+    fclose(in);
+
+    const uint32_t pos = (uint32_t)strtoul(argv[2], NULL, 0);
+    uint32_t cycles_per_us = 64u;
+    bool summary_only = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--summary") == 0)
+            summary_only = true;
+        else
+            cycles_per_us = (uint32_t)strtoul(argv[i], NULL, 0);
+    }
+
+    spi_bus_trace_record *ordered = ring + depth;
+    const uint32_t n = spi_trace_unroll(ring, depth, pos, ordered);
+    if (!summary_only)
+        spi_trace_print_timeline(stdout, ordered, n, cycles_per_us);
+
+    spi_trace_summary s;
+    spi_trace_summarize(ordered, n, pos - n, &s);
+    spi_trace_print_summary(stdout, &s, cycles_per_us);
+    free(ring);
+    return 0;
+}
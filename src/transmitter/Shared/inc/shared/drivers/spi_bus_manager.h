@@ -15,22 +15,115 @@ extern "C"
      *
      * Features:
      * - Single SPI instance arbitrated among multiple devices (slaves).
+     * - Several managers (one per SPI instance) can run in parallel; a static registry keyed by
+     *   SPI_HandleTypeDef* routes HAL callbacks to the right manager in constant time.
      * - Transaction queue (ring buffer) with user-supplied storage (no malloc).
-     * - Per-transaction CS and optional DC control.
+     * - Lock-free multi-producer submission: submit / enqueue_callback are safe from thread
+     *   level and from any ISR (slot reservation with LDREX/STREX, per-slot publish flag).
+     * - Optional high-priority lane (second ring) served at every transaction/chunk boundary,
+     *   and optional chunking of long normal-priority TX transfers, so a short sensor read
+     *   never waits behind a whole display frame.
+     * - Compact 20-byte transactions: CS/DC lines, CR1/CR2, wait predicate and callbacks live in
+     *   a per-device profile (spi_bus_manager_add_device()); descriptors can be queued by pointer.
+     * - Per-device CS and optional per-transaction DC control.
+     * - Per-device SCLK limit: the manager picks the fastest baud-rate prescaler the device allows from
+     *   the SPI kernel clock, and re-derives it after clock changes (spi_bus_manager_update_clocks()).
+     * - CS-grouped chains: a list of segments (e.g. command + payload pairs) sent under one CS
+     *   assertion with DC switched between segments; short segments are polled, so a register
+     *   setup sequence costs no interrupts and a long payload costs one.
+     * - Programs: const (flash-resident) op lists of command, data, delay, GPIO-set (e.g. RESET) and
+     *   wait-ready steps, interpreted by the engine from completion interrupts and on_tick. A whole
+     *   panel init or refresh is one queue item and never spins the CPU; the bus is free during its
+     *   delays and waits.
+     * - Delay items (and program DELAY ops) backed by an optional hardware one-shot timer
+     *   (spi_bus_manager_set_timer()), so settle times are queued instead of spent in HAL_Delay().
      * - TX-only or TXRX DMA transfers.
-     * - Optional post-transfer wait hook (e.g., wait on device BUSY pin).
-     * - Completion, half-completion and error callbacks per transaction.
+     * - Selective cancellation by device and/or caller tag (spi_bus_manager_cancel()), optionally
+     *   aborting the item on the wire, so superseded work (e.g. an outdated frame) never goes out.
+     * - DMA watchdog: a lost completion no longer stalls the bus; the transfer is aborted, the SPI
+     *   reset, CS released and the item failed through on_error (checked from on_tick).
+     * - Exclusive lease (spi_bus_manager_acquire() / _release()) so blocking legacy drivers can use the
+     *   same SPI between queued transfers instead of hoping the queue is idle.
+     * - Optional post-transfer wait hook (e.g., wait on device BUSY pin), evaluated outside of
+     *   the DMA ISR: the transaction is parked and re-checked from spi_bus_manager_on_tick().
+     * - Completion, half-completion and error callbacks (shared per device).
      * - HAL integration via spi_bus_manager_on_* functions called from HAL callbacks.
+     * - Hardware access isolated behind SPI_BUS_PORT_* hooks (defaults: STM32 HAL); the glue header can
+     *   retarget them, e.g. to a simulated SPI/DMA backend with a virtual clock in a host build.
+     * - Optional DWT cycle profiling of the completion ISR path (SPI_BUS_MANAGER_PROFILE=1, CM3+ only).
+     * - Always-on statistics (SPI_BUS_MANAGER_STATS): queue high-water marks, bytes per device,
+     *   enqueue-to-start / start-to-complete / post-wait histograms, snapshot and reset API.
+     * - Optional binary event trace (SPI_BUS_MANAGER_DEBUG=1): fixed 12-byte records with a cycle stamp,
+     *   written with a handful of stores, so tracing barely moves ISR timing.
      *
      * Typical flow:
      *  1) Create manager with spi_bus_manager_create().
-     *  2) Enqueue transactions with spi_bus_manager_submit().
-     *  3) In HAL SPI callbacks, call spi_bus_manager_on_tx_cplt() / _on_txrx_cplt() / _on_error().
-     *  4) (Optional) Poll spi_bus_manager_is_idle() or use callbacks to chain higher-level logic.
+     *  2) Register device profiles with spi_bus_manager_add_device(), then enqueue transactions
+     *     with spi_bus_manager_submit() / spi_bus_manager_submit_ref().
+     *  3) In HAL SPI callbacks, call spi_bus_manager_on_tx_cplt() / _on_txrx_cplt() / _on_error(),
+     *     or register the manager with spi_bus_manager_register() and use spi_bus_manager_dispatch_*().
+     *  4) Call spi_bus_manager_on_tick() periodically (main loop / low-rate timer): it runs the DMA
+     *     watchdog and resumes waits; also call it from the EXTI of the device BUSY line.
+     *  5) (Optional) Poll spi_bus_manager_is_idle() or use callbacks to chain higher-level logic.
      */
 
     /* --------------------------------- Status --------------------------------- */
 
+/**
+ * @brief Number of SPI instances the registry can hold (SPI1..SPI4 on G4).
+ */
+#ifndef SPI_BUS_MANAGER_MAX_INSTANCES
+#define SPI_BUS_MANAGER_MAX_INSTANCES 4
+#endif
+
+/**
+ * @brief Chain segments up to this many data units are written by polling instead of DMA
+ *        (8 bytes = 32 us at 2 Mbit/s, about the cost of a DMA start plus its interrupt).
+ */
+#ifndef SPI_BUS_MANAGER_PIO_MAX_UNITS
+#define SPI_BUS_MANAGER_PIO_MAX_UNITS 8
+#endif
+
+/**
+ * @brief Bound of every flag wait of a polled segment, in loop iterations (not ms: HAL_GetTick does
+ *        not advance in the completion and EXTI interrupts that run them). About 1 ms at 64 MHz,
+ *        many byte times at any SCLK a profile sets. A segment that runs out fails its item.
+ */
+#ifndef SPI_BUS_MANAGER_PIO_SPINS
+#define SPI_BUS_MANAGER_PIO_SPINS 16000u
+#endif
+
+/**
+ * @brief Number of device profiles one manager can hold (transactions refer to them by index).
+ */
+#ifndef SPI_BUS_MANAGER_MAX_DEVICES
+#define SPI_BUS_MANAGER_MAX_DEVICES 4
+#endif
+
+/**
+ * @brief DMA watchdog: a transfer still in flight after this many ms is aborted, the SPI is reset
+ *        and the item fails through on_error. Used for devices whose spi_timeout is HAL_MAX_DELAY.
+ *        Checked from spi_bus_manager_on_tick(); 0 disables it for such devices.
+ */
+#ifndef SPI_BUS_MANAGER_DMA_TIMEOUT_MS
+#define SPI_BUS_MANAGER_DMA_TIMEOUT_MS 250
+#endif
+
+/**
+ * @brief Always-on bus statistics (queue high-water marks, bytes per device, latency histograms).
+ *        Costs a few loads/stores per transfer and 4 bytes per queue slot; set to 0 to drop them.
+ */
+#ifndef SPI_BUS_MANAGER_STATS
+#define SPI_BUS_MANAGER_STATS 1
+#endif
+
+/**
+ * @brief Buckets per latency histogram (log2 scale, last bucket is open-ended).
+ */
+#ifndef SPI_BUS_STATS_BUCKETS
+#define SPI_BUS_STATS_BUCKETS 16
+#endif
+
     typedef enum
     {
         SPI_BUS_MANAGER_OK = 0,
@@ -43,10 +136,27 @@ extern "C"
     /* ---------------------------- Transaction kind ---------------------------- */
     typedef enum
     {
-        SPI_BUS_ITEM_TX = 0,      /**< Normal DMA transaction (TX/TXRX). */
-        SPI_BUS_ITEM_CALLBACK = 1 /**< Fence/callback item (no DMA, no CS/DC). */
+        SPI_BUS_ITEM_TX = 0,       /**< Normal DMA transaction (TX/TXRX). */
+        SPI_BUS_ITEM_CALLBACK = 1, /**< Fence/callback item (no DMA, no CS/DC). */
+        SPI_BUS_ITEM_CHAIN = 2,    /**< Segment list under one CS assertion (TX only). */
+        SPI_BUS_ITEM_REF = 3,      /**< Internal: queue slot pointing at a static descriptor. */
+        SPI_BUS_ITEM_PROGRAM = 4,  /**< Op list run by the engine (normal lane only, see spi_bus_op). */
+        SPI_BUS_ITEM_DELAY = 5,    /**< Pause the normal lane for delay_ms (no CS/DC, bus stays free). */
+        SPI_BUS_ITEM_SKIP = 6      /**< Internal: cancelled slot, dropped when it reaches the head. */
     } spi_bus_item_kind;
 
+/**
+ * @brief Wildcard device / tag for spi_bus_manager_cancel().
+ */
+#define SPI_BUS_MATCH_ANY 0xFFu
+
+    /* ---------------------------- Priority classes ---------------------------- */
+    typedef enum
+    {
+        SPI_BUS_PRIO_NORMAL = 0, /**< Bulk traffic (display frames, init sequences). */
+        SPI_BUS_PRIO_HIGH = 1    /**< Short latency-sensitive transfers (sensor reads). */
+    } spi_bus_priority;
+
     /* ------------------------------- GPIO helpers ------------------------------ */
 
     typedef struct
@@ -77,19 +187,80 @@ extern "C"
         SPI_BUS_DC_DATA        /**< Set DC=1 before transfer (data phase).       */
     } spi_bus_dc_mode;
 
+    /**
+     * @brief One segment of a SPI_BUS_ITEM_CHAIN transaction.
+     *        Segment arrays are referenced, not copied: keep them alive (ideally static const)
+     *        until the chain completes.
+     */
+    typedef struct
+    {
+        const uint8_t *tx;       /**< Segment data (required). */
+        uint16_t len;            /**< Number of SPI data units. */
+        spi_bus_dc_mode dc_mode; /**< DC level for this segment (UNUSED = leave as is). */
+    } spi_bus_segment;
+
+    /**
+     * @brief Program op codes (SPI_BUS_ITEM_PROGRAM).
+     *        Consecutive CMD/DATA ops share one CS assertion, exactly like chain segments.
+     *        DELAY, GPIO and WAIT release CS first; DELAY and a WAIT whose predicate is not ready yet
+     *        park the normal lane (the bus stays free) and the program resumes from on_tick.
+     */
+    typedef enum
+    {
+        SPI_BUS_OP_CMD = 0, /**< Send arg units from tx with DC = command. */
+        SPI_BUS_OP_DATA,    /**< Send arg units from tx with DC = data. */
+        SPI_BUS_OP_DELAY,   /**< Pause for at least arg ms (timer one-shot if set, else on_tick period). */
+        SPI_BUS_OP_GPIO,    /**< Drive the device reset line: arg 1 = active, 0 = inactive. */
+        SPI_BUS_OP_WAIT,    /**< Wait for the device wait_ready predicate (wait_timeout_ms applies). */
+    } spi_bus_op_code;
+
+    /**
+     * @brief One program op (8 bytes). Programs are referenced, not copied: keep them static const.
+     */
+    typedef struct
+    {
+        const uint8_t *tx; /**< Bytes to send (CMD/DATA), NULL otherwise. */
+        uint16_t arg;      /**< CMD/DATA: units; DELAY: ms; GPIO: line level (1 = active). */
+        uint8_t op;        /**< spi_bus_op_code */
+    } spi_bus_op;
+
+/**
+ * @brief Program op builders for static const tables, e.g.
+ *        `SPI_BUS_CMD(0x12), SPI_BUS_DELAY(300), SPI_BUS_CMD(0x44), SPI_BUS_DATA(0x00, 0x00, 0x17, 0x01)`.
+ *        CMD/DATA bytes become file-scope compound literals (static storage, flash on const data).
+ */
+#define SPI_BUS_CMD(...) {(const uint8_t[]){__VA_ARGS__}, (uint16_t)sizeof((const uint8_t[]){__VA_ARGS__}), SPI_BUS_OP_CMD}
+#define SPI_BUS_DATA(...) {(const uint8_t[]){__VA_ARGS__}, (uint16_t)sizeof((const uint8_t[]){__VA_ARGS__}), SPI_BUS_OP_DATA}
+#define SPI_BUS_DATA_BUF(buf, units) {(buf), (uint16_t)(units), SPI_BUS_OP_DATA}
+#define SPI_BUS_DELAY(ms) {NULL, (uint16_t)(ms), SPI_BUS_OP_DELAY}
+#define SPI_BUS_GPIO(active) {NULL, (uint16_t)((active) ? 1u : 0u), SPI_BUS_OP_GPIO}
+#define SPI_BUS_WAIT_READY() {NULL, 0u, SPI_BUS_OP_WAIT}
+#define SPI_BUS_PROGRAM_LEN(prog) ((uint16_t)(sizeof(prog) / sizeof((prog)[0])))
+
     /* Forward decl for handle */
     struct spi_bus_manager;
 
     /**
      * @brief Post-transfer wait function (e.g., wait until device BUSY de-asserts).
      * Should return true when device is ready to accept a new transaction.
-     * Called repeatedly until returns true or until timeout_ms elapses (if >0).
+     * Called once right after the transfer completes (ISR context) and then from every
+     * spi_bus_manager_on_tick() until it returns true or until timeout_ms elapses (if >0).
+     * Must be a cheap, non-blocking check (e.g., a single GPIO read).
      *
      * @param user       User pointer provided in transaction.
      * @return bool      true = ready; false = still busy (manager will retry until timeout).
      */
     typedef bool (*spi_bus_wait_ready_fn)(void *user);
 
+    /**
+     * @brief Start (or restart) a one-shot timer that calls spi_bus_manager_on_timer() after @p ms.
+     *        Runs in engine context (possibly ISR); must not block. Restarting cancels the previous shot.
+     *
+     * @param ctx Context pointer given to spi_bus_manager_set_timer().
+     * @param ms  Delay in milliseconds (1..65535).
+     */
+    typedef void (*spi_bus_timer_start_fn)(void *ctx, uint32_t ms);
+
     /**
      * @brief Completion/half/error callback prototype.
      * Callbacks execute in ISR context (HAL DMA/SPI IRQ). Keep them short.
@@ -99,60 +270,258 @@ extern "C"
      */
     typedef void (*spi_bus_done_cb)(struct spi_bus_manager *mgr, void *user);
 
-    /* ------------------------------ Transaction ------------------------------- */
+    /* ----------------------------- Device profile ----------------------------- */
 
     /**
-     * @brief SPI transaction descriptor. Provide a const instance per submit.
+     * @brief Callbacks shared by all transactions of a device (ISR context).
+     *        Usually one static const table per driver.
      */
     typedef struct
     {
-        spi_bus_item_kind kind; /**< SPI_BUS_ITEM_TX or SPI_BUS_ITEM_CALLBACK */
+        spi_bus_done_cb on_half;  /**< Half-transfer callback (optional). */
+        spi_bus_done_cb on_done;  /**< Transfer complete callback (optional). */
+        spi_bus_done_cb on_error; /**< Error callback (optional). */
+    } spi_bus_callbacks;
 
+    /**
+     * @brief Per-device bus settings, registered once with spi_bus_manager_add_device().
+     *        The manager keeps a pointer: the profile must outlive the manager.
+     */
+    typedef struct
+    {
         /* Bus lines */
-        spi_bus_gpio cs;         /**< Chip Select line (required). */
-        spi_bus_gpio dc;         /**< Optional DC line; set .port=NULL if unused. */
-        spi_bus_dc_mode dc_mode; /**< How to set DC before transfer. */
+        spi_bus_gpio cs; /**< Chip Select line (required). */
+        spi_bus_gpio dc; /**< Optional DC line; set .port=NULL if unused. */
+        spi_bus_gpio reset; /**< Optional line driven by program GPIO ops (e.g. RESET); .port=NULL if unused. */
 
         /* SPI config snapshot (fast switch, no re-init). Fill only fields you need.
            Manager will write CR1/CR2 directly around SPE. */
         uint32_t cr1;
         uint32_t cr2;
-
-        /* Buffers & sizes */
-        const uint8_t *tx;     /**< TX buffer (required). */
-        uint8_t *rx;           /**< RX buffer (required if dir=TXRX). */
-        uint16_t len;          /**< Number of SPI data units (8-bit when DS=8, 16-bit when DS=16). */
-        spi_bus_direction dir; /**< TX or TXRX. */
+        uint32_t max_sclk_hz; /**< Fastest SCLK the device accepts; replaces the BR bits of cr1 (0 = keep them). */
 
         /* Timeouts */
-        uint32_t spi_timeout; /**< Fallback timeout (usually not used with DMA, keep HAL_MAX_DELAY). */
+        uint32_t spi_timeout; /**< DMA watchdog per transfer, ms (HAL_MAX_DELAY = default watchdog). Polled segments use SPI_BUS_MANAGER_PIO_SPINS. */
 
-        /* Optional post-transfer wait (e.g., BUSY pin) */
-        spi_bus_wait_ready_fn wait_ready; /**< Optional ready predicate; may be NULL. */
+        /* Optional post-transfer wait (e.g., BUSY pin), used by transactions with .wait = 1 and program WAIT ops */
+        spi_bus_wait_ready_fn wait_ready; /**< Ready predicate; may be NULL. */
         uint32_t wait_timeout_ms;         /**< 0 = no timeout (avoid infinite if you can't guarantee). */
 
-        /* Callbacks (ISR context) */
-        spi_bus_done_cb on_half;  /**< Half-transfer callback (optional). */
-        spi_bus_done_cb on_done;  /**< Transfer complete callback (optional). */
-        spi_bus_done_cb on_error; /**< Error callback (optional). */
+        const spi_bus_callbacks *cb; /**< Shared callback table (optional). */
+    } spi_bus_device;
+
+    /* ------------------------------ Transaction ------------------------------- */
 
-        /* User payload passed to callbacks and wait_ready */
-        void *user;
+    /**
+     * @brief Compact SPI transaction descriptor (20 bytes on Cortex-M, 24 with SPI_BUS_MANAGER_STATS).
+     *        Static settings live in the device profile; submit copies the descriptor into the
+     *        queue, spi_bus_manager_submit_ref() queues only a pointer to it.
+     */
+    typedef struct spi_bus_transaction
+    {
+        union
+        {
+            const uint8_t *tx;                     /**< TX buffer (kind TX, required). */
+            const spi_bus_segment *segs;           /**< Segments sent back-to-back under one CS (kind CHAIN). */
+            const spi_bus_op *prog;                /**< Ops to interpret (kind PROGRAM). */
+            spi_bus_done_cb fn;                    /**< Function to run (kind CALLBACK). */
+            const struct spi_bus_transaction *ref; /**< Referenced descriptor (kind REF, internal). */
+        };
+        uint8_t *rx; /**< RX buffer (required if dir=TXRX). */
+        void *user;  /**< User payload passed to callbacks and wait_ready. */
+        union
+        {
+            uint16_t len;       /**< Number of SPI data units (8-bit when DS=8, 16-bit when DS=16). */
+            uint16_t seg_count; /**< Number of segments (kind CHAIN). */
+            uint16_t op_count;  /**< Number of ops (kind PROGRAM). */
+            uint16_t delay_ms;  /**< Pause length, ms (kind DELAY). */
+        };
+        uint8_t dev;          /**< Device profile index from spi_bus_manager_add_device(). */
+        uint8_t tag;          /**< Caller-chosen group for spi_bus_manager_cancel() (0 = untagged, 0xFF reserved). */
+        uint8_t kind : 3;     /**< spi_bus_item_kind */
+        uint8_t dir : 1;      /**< spi_bus_direction */
+        uint8_t dc_mode : 2;  /**< spi_bus_dc_mode: how to set DC before transfer */
+        uint8_t priority : 1; /**< spi_bus_priority; HIGH needs spi_bus_manager_set_priority_queue(), else NORMAL. */
+        uint8_t wait : 1;     /**< 1 = hold the device after transfer until its wait_ready predicate passes. */
+
+        /* Internal ring state, owned by the manager (value in submitted descriptors is ignored). */
+        volatile uint8_t published;
+#if SPI_BUS_MANAGER_STATS
+        uint32_t enq_stamp; /**< Cycle stamp of the push (internal, enqueue-to-start latency). */
+#endif
     } spi_bus_transaction;
 
+    /* ------------------------------- Debug trace ------------------------------- */
+
+/**
+ * @brief Number of records in the binary trace ring (SPI_BUS_MANAGER_DEBUG=1). Power of two.
+ */
+#ifndef SPI_BUS_TRACE_DEPTH
+#define SPI_BUS_TRACE_DEPTH 512
+#endif
+
+/**
+ * @brief Set in spi_bus_trace_record::event when the event belongs to the high-priority lane.
+ */
+#define SPI_BUS_TRACE_HIGH_LANE 0x80u
+
+    /**
+     * @brief Trace event ids (low 7 bits of spi_bus_trace_record::event).
+     *        For item events `head` is the ring slot of the item, so PUSH -> START -> DONE
+     *        of one transaction share the same slot number within their lane.
+     */
+    typedef enum
+    {
+        SPI_BUS_TRACE_MARK = 0,     /**< spi_bus_trace_mark(): arg = tag, len = value. */
+        SPI_BUS_TRACE_PUSH,         /**< Item published: head = slot, arg = kind, len = units / segments. */
+        SPI_BUS_TRACE_FULL,         /**< Push refused, ring full: arg = kind. */
+        SPI_BUS_TRACE_REJECT,       /**< Submit refused by validation: arg = spi_bus_trace_reject. */
+        SPI_BUS_TRACE_START,        /**< DMA started: arg = device, len = units of this transfer/chunk. */
+        SPI_BUS_TRACE_CHAIN,        /**< Chain started: arg = device, len = segment count. */
+        SPI_BUS_TRACE_SEG_PIO,      /**< Chain segment polled: arg = segment index, len = units. */
+        SPI_BUS_TRACE_SEG_DMA,      /**< Chain segment handed to DMA: arg = segment index, len = units. */
+        SPI_BUS_TRACE_CALLBACK,     /**< Callback item run. */
+        SPI_BUS_TRACE_HALF,         /**< Half-transfer interrupt. */
+        SPI_BUS_TRACE_CPLT,         /**< Transfer-complete interrupt (entry). */
+        SPI_BUS_TRACE_CHUNK,        /**< Chunk boundary: len = units sent so far. */
+        SPI_BUS_TRACE_PARK,         /**< Normal lane parked: len = reason (0 post-transfer wait, 1 program delay, 2 program wait). */
+        SPI_BUS_TRACE_DONE,         /**< Item retired successfully (on_done). */
+        SPI_BUS_TRACE_WAIT_TIMEOUT, /**< Post-transfer wait timed out (on_error). */
+        SPI_BUS_TRACE_FAIL,         /**< Item dropped after a HAL failure (on_error). */
+        SPI_BUS_TRACE_HAL_ERROR,    /**< HAL error interrupt. */
+        SPI_BUS_TRACE_CANCEL,       /**< cancel_pending(): head/tail before the cut; cancel(): arg = tag, len = items dropped. */
+        SPI_BUS_TRACE_WATCHDOG,     /**< DMA watchdog fired, bus recovered: len = units of the stuck transfer. */
+        SPI_BUS_TRACE_LEASE,        /**< Bus lease granted to a blocking caller. */
+        SPI_BUS_TRACE_RELEASE,      /**< Bus lease released, queue resumes. */
+        SPI_BUS_TRACE_PROGRAM,      /**< Program (re)entered: arg = device, len = next op index. */
+        SPI_BUS_TRACE_RESUME,       /**< Parked program step over (delay elapsed / device ready): len = next op. */
+        SPI_BUS_TRACE_ABORT,        /**< Started head dropped by cancel(): arg = device, len = 1 if its DMA was stopped. */
+    } spi_bus_trace_event;
+
+    /**
+     * @brief Validation failures reported by SPI_BUS_TRACE_REJECT.
+     */
+    typedef enum
+    {
+        SPI_BUS_TRACE_REJ_NULL = 0,  /**< NULL manager/descriptor or no storage. */
+        SPI_BUS_TRACE_REJ_REF,       /**< Nested reference item or internal item kind. */
+        SPI_BUS_TRACE_REJ_CALLBACK,  /**< Callback item without a function. */
+        SPI_BUS_TRACE_REJ_DEVICE,    /**< Unknown device index. */
+        SPI_BUS_TRACE_REJ_CHAIN,     /**< Bad chain (segments, direction). */
+        SPI_BUS_TRACE_REJ_BUFFER,    /**< Missing tx buffer or zero length. */
+        SPI_BUS_TRACE_REJ_RX,        /**< TXRX without an rx buffer. */
+        SPI_BUS_TRACE_REJ_WAIT,      /**< wait set but the device has no predicate. */
+        SPI_BUS_TRACE_REJ_WAIT_HIGH, /**< wait or program on a high-priority item. */
+        SPI_BUS_TRACE_REJ_PROGRAM,   /**< Bad program (op code, buffer, missing reset line or predicate). */
+        SPI_BUS_TRACE_REJ_DELAY,     /**< Delay item of 0 ms or on the high-priority lane. */
+    } spi_bus_trace_reject;
+
+    /**
+     * @brief One trace record (12 bytes). The ring is g_spi_trace[SPI_BUS_TRACE_DEPTH];
+     *        g_spi_trace_pos counts records ever written, so the oldest valid record is at
+     *        (g_spi_trace_pos - SPI_BUS_TRACE_DEPTH) once the ring has wrapped.
+     */
+    typedef struct
+    {
+        uint32_t stamp; /**< DWT->CYCCNT (HAL_GetTick() on cores without DWT). */
+        uint8_t event;  /**< spi_bus_trace_event | SPI_BUS_TRACE_HIGH_LANE. */
+        uint8_t arg;    /**< Event-specific (see spi_bus_trace_event). */
+        uint16_t head;  /**< Item slot (item events) or lane head. */
+        uint16_t tail;  /**< Lane tail at the time of the event. */
+        uint16_t len;   /**< Event-specific length. */
+    } spi_bus_trace_record;
+
+    /* -------------------------------- Statistics -------------------------------- */
+
+    /**
+     * @brief Bus statistics since the last reset.
+     *        Cycle histograms: bucket 0 counts samples below 64 cycles, bucket k counts samples in
+     *        [2^(k+5), 2^(k+6)) cycles (1 us .. 16 ms at 64 MHz); the last bucket takes everything above.
+     *        The post-wait histogram is in milliseconds: bucket 0 = under 1 ms, bucket k = [2^(k-1), 2^k) ms.
+     *        On cores without DWT, cycle values are HAL ticks.
+     */
+    typedef struct
+    {
+        uint32_t elapsed_ms;                                /**< Time covered by this snapshot. */
+        uint64_t busy_cycles;                               /**< Sum of start-to-complete times (bus utilisation). */
+        uint32_t completed;                                 /**< Transactions retired through on_done. */
+        uint32_t failed;                                    /**< Transactions retired through on_error. */
+        uint32_t rejected;                                  /**< Submits refused (invalid or queue full). */
+        uint32_t recoveries;                                /**< DMA watchdog recoveries. */
+        uint32_t cancelled;                                 /**< Transactions dropped by spi_bus_manager_cancel(). */
+        uint16_t q_hwm;                                     /**< Normal lane depth high-water mark. */
+        uint16_t hq_hwm;                                    /**< High-priority lane depth high-water mark. */
+        uint32_t bytes[SPI_BUS_MANAGER_MAX_DEVICES];        /**< Bytes moved per device profile. */
+        uint32_t enq_to_start_max;                          /**< Worst enqueue-to-start latency (cycles). */
+        uint32_t start_to_cplt_max;                         /**< Worst single transfer (cycles). */
+        uint32_t post_wait_max_ms;                          /**< Worst post-transfer wait (ms). */
+        uint32_t enq_to_start[SPI_BUS_STATS_BUCKETS];       /**< Queueing delay, first transfer of an item. */
+        uint32_t start_to_cplt[SPI_BUS_STATS_BUCKETS];      /**< Per transfer: DMA transfer, chunk or whole chain. */
+        uint32_t post_wait_ms[SPI_BUS_STATS_BUCKETS];       /**< Device wait after transfer (wait items). */
+    } spi_bus_stats;
+
     /* --------------------------------- Handle --------------------------------- */
 
+    /**
+     * @brief Ring buffer of transactions (user-supplied storage).
+     */
+    typedef struct
+    {
+        spi_bus_transaction *items; /**< Ring buffer storage. */
+        uint16_t capacity;          /**< Ring buffer capacity. */
+        volatile uint16_t head;     /**< Pop index. */
+        volatile uint16_t tail;     /**< Push index. */
+        uint8_t lane;               /**< 0 = normal lane, 1 = high-priority lane (trace tag). */
+    } spi_bus_queue;
+
     typedef struct spi_bus_manager
     {
         SPI_HandleTypeDef *spi; /**< Bound SPI handle. */
-        /* Queue */
-        spi_bus_transaction *q;   /**< Ring buffer storage (user-supplied). */
-        uint16_t q_capacity;      /**< Ring buffer capacity. */
-        volatile uint16_t q_head; /**< Pop index. */
-        volatile uint16_t q_tail; /**< Push index. */
-        volatile bool busy;       /**< True while a DMA transfer is in progress or waiting post hook. */
+        /* Queues */
+        spi_bus_queue q;         /**< Normal-priority lane. */
+        spi_bus_queue hq;        /**< High-priority lane (optional, capacity 0 = disabled). */
+        volatile bool busy;      /**< True while a DMA transfer (or chunk) is in flight. */
+        volatile bool waiting;   /**< True while the normal-lane head is parked on its wait_ready predicate. */
+        volatile bool hq_active; /**< True while the in-flight transfer comes from the high-priority lane. */
+        uint32_t wait_start_ms;  /**< HAL_GetTick() when the current post-transfer wait started. */
+        /* DMA watchdog */
+        volatile uint32_t xfer_timeout_ms; /**< Deadline of the in-flight DMA transfer (0 = none armed). */
+        uint32_t xfer_start_ms;            /**< HAL_GetTick() when the in-flight DMA transfer started. */
+        uint32_t recoveries;               /**< Watchdog recoveries since create (abort + SPI reset). */
+        /* Exclusive lease for blocking (non-queued) drivers */
+        volatile uint8_t lease_req; /**< Set by spi_bus_manager_acquire(); the engine grants at the next boundary. */
+        volatile bool leased;       /**< True while a blocking caller owns the bus (engine starts nothing). */
+        /* Chunking of long normal-priority TX transfers */
+        uint16_t chunk_max;          /**< Max data units per DMA chunk (0 = no chunking). */
+        volatile uint16_t chunk_off; /**< Data units of the normal-lane head already sent. */
+        uint16_t cur_len;            /**< Data units of the in-flight DMA chunk. */
+        volatile uint16_t seg_idx;   /**< Current segment of an in-flight chain. */
+        /* Program interpreter (normal lane) */
+        volatile uint16_t prog_pc; /**< Next op of the normal-lane head program (0 = not started). */
+        uint16_t park_ms;          /**< Length of the program DELAY the lane is parked on, ms. */
+        uint8_t park;              /**< Why the normal lane is parked (post-transfer wait, delay, wait op). */
+        bool prog_cs;              /**< CS of the running program is asserted. */
+        /* Optional one-shot timer for delays */
+        spi_bus_timer_start_fn timer_start; /**< Starts the one-shot (NULL = delays resolve from on_tick). */
+        void *timer_ctx;                    /**< Context for timer_start. */
+        volatile uint8_t timer_fired;       /**< Set by spi_bus_manager_on_timer() for the armed delay. */
+        /* Engine serialization (start/advance logic runs in one context at a time) */
+        volatile uint8_t engine_lock; /**< Try-lock taken by the context running the engine. */
+        volatile uint8_t kick;        /**< Set by contexts that found the engine busy; served by the owner. */
+        volatile uint8_t ready_pending; /**< on_tick found the engine busy (BUSY edge): the owner re-runs it. */
+        /* Device profiles referenced by transaction index */
+        const spi_bus_device *devices[SPI_BUS_MANAGER_MAX_DEVICES];
+        uint32_t dev_cr1[SPI_BUS_MANAGER_MAX_DEVICES]; /**< CR1 applied per device (BR derived from max_sclk_hz). */
+        uint8_t device_count;
+        uint32_t base_cr1, base_cr2; /**< CR1/CR2 at create(), restored when a lease is granted. */
         /* Cache management (for M7 etc.): set true to clean DCache before TX DMA */
         bool clean_dcache_before_tx;
+#if SPI_BUS_MANAGER_STATS
+        /* Statistics */
+        uint32_t xfer_stamp; /**< Cycle stamp of the in-flight transfer start. */
+        uint32_t stats_reset_ms;
+        spi_bus_stats stats;
+#endif
     } spi_bus_manager;
 
     /* ------------------------------ Public API -------------------------------- */
@@ -169,24 +538,168 @@ extern "C"
                                            uint16_t capacity);
 
     /**
-     * @brief Submit a transaction to the queue. Non-blocking.
+     * @brief Attach storage for the high-priority lane.
+     *        Call before the first submit. Pass NULL to disable (HIGH items then go to the normal lane).
      * @param mgr      Manager.
-     * @param t        Transaction descriptor (contents copied by value).
-     * @return SPI_BUS_MANAGER_OK on success; *_ERR_FULL if queue full; *_ERR_PARAM on invalid args.
+     * @param storage  Pointer to transaction array for the high-priority ring buffer.
+     * @param capacity Number of entries in @p storage.
+     */
+    void spi_bus_manager_set_priority_queue(spi_bus_manager *mgr,
+                                            spi_bus_transaction *storage,
+                                            uint16_t capacity);
+
+    /**
+     * @brief Back DELAY items and program DELAY ops with a hardware one-shot timer.
+     *        Without a timer, delays end at the first on_tick() after they elapse.
+     *        Thread level, before the first submit.
+     * @param mgr   Manager.
+     * @param start Starts the one-shot; its interrupt must call spi_bus_manager_on_timer().
+     * @param ctx   Context passed to @p start (e.g. the TIM handle).
+     */
+    void spi_bus_manager_set_timer(spi_bus_manager *mgr, spi_bus_timer_start_fn start, void *ctx);
+
+    /**
+     * @brief Register a device profile (CS/DC lines, CR1/CR2, wait predicate, callbacks).
+     *        Thread level, before submitting transactions for it. Registering the same profile
+     *        again returns the same id. With max_sclk_hz set, the BR field is derived here from
+     *        the current SPI kernel clock.
+     * @param mgr      Manager.
+     * @param dev      Profile (kept by pointer; must outlive the manager).
+     * @param id       Out: index to put in spi_bus_transaction.dev.
+     * @return SPI_BUS_MANAGER_OK; *_ERR_FULL if SPI_BUS_MANAGER_MAX_DEVICES reached; *_ERR_PARAM.
+     */
+    spi_bus_manager_status spi_bus_manager_add_device(spi_bus_manager *mgr,
+                                                      const spi_bus_device *dev,
+                                                      uint8_t *id);
+
+    /**
+     * @brief Re-derive the prescaler of every device with max_sclk_hz from the current SPI kernel
+     *        clock (APB1/APB2). Call after changing SYSCLK or the APB dividers; thread level.
+     *        A transfer already on the wire finishes at the old rate.
+     * @param mgr Manager.
+     */
+    void spi_bus_manager_update_clocks(spi_bus_manager *mgr);
+
+    /**
+     * @brief SCLK frequency a device currently runs at.
+     * @param mgr Manager.
+     * @param id  Device id from spi_bus_manager_add_device().
+     * @return Frequency in Hz, 0 for an unknown id.
+     */
+    uint32_t spi_bus_manager_device_sclk_hz(const spi_bus_manager *mgr, uint8_t id);
+
+    /**
+     * @brief Submit a transaction to the queue. Non-blocking, safe from thread level and ISR
+     *        (including completion callbacks of this manager).
+     * @param mgr      Manager.
+     * @param t        Transaction descriptor (contents copied by value). For a chain set
+     *                 kind = SPI_BUS_ITEM_CHAIN, segs/seg_count, dev and dir = TX;
+     *                 callbacks and wait apply to the chain as a whole. For a program set
+     *                 kind = SPI_BUS_ITEM_PROGRAM, prog/op_count, dev and user (passed to wait_ready).
+     * @return SPI_BUS_MANAGER_OK on success; *_ERR_FULL if queue full; *_ERR_PARAM on invalid args
+     *         (also for a HIGH item with wait or a HIGH program: the high-priority lane never parks).
      */
     spi_bus_manager_status spi_bus_manager_submit(spi_bus_manager *mgr, const spi_bus_transaction *t);
 
     /**
-     * @brief Returns true if no transfer in progress and queue empty.
+     * @brief Like spi_bus_manager_submit(), but queues only a pointer to @p t (no copy).
+     *        @p t must stay valid and unchanged until its transfer completes; intended for
+     *        static / per-driver descriptors that are resubmitted as-is.
+     */
+    spi_bus_manager_status spi_bus_manager_submit_ref(spi_bus_manager *mgr, const spi_bus_transaction *t);
+
+    /**
+     * @brief Returns true if no transfer in progress, nothing parked and both queues empty.
      */
     bool spi_bus_manager_is_idle(const spi_bus_manager *mgr);
 
     /**
-     * @brief Cancel all pending transactions. Does not abort current DMA.
+     * @brief Cancel all pending transactions (both lanes). Does not abort current DMA;
+     *        a partially sent (chunked) or parked transaction is kept and completes normally.
      *        Safe to call from thread-level only (not ISR).
      */
     void spi_bus_manager_cancel_pending(spi_bus_manager *mgr);
 
+    /**
+     * @brief Cancel the transactions of one device and/or one tag, in both lanes.
+     *        An item matches when its dev equals @p dev and its tag equals @p tag; SPI_BUS_MATCH_ANY
+     *        matches everything for that field. Callback and delay items have no device and match
+     *        only with @p dev = SPI_BUS_MATCH_ANY. Queued matches are skipped without callbacks,
+     *        the other items keep their order.
+     *        A matching item that already started (on the wire, between chunks, parked on its wait,
+     *        half-way through a program) is kept unless @p abort: then its DMA is stopped, CS
+     *        released, the lane unparked and the item dropped, also without callbacks. An aborted
+     *        device may have taken a partial byte or command; the next transaction to it starts
+     *        with DC set and a fresh CS assertion, which resets the serial interface of most slaves.
+     *        Thread level. From this manager's callbacks only queued items are cancelled.
+     * @param mgr   Manager.
+     * @param dev   Device id, or SPI_BUS_MATCH_ANY.
+     * @param tag   Tag, or SPI_BUS_MATCH_ANY.
+     * @param abort Also drop a matching item that already started.
+     * @return Number of transactions dropped.
+     */
+    uint16_t spi_bus_manager_cancel(spi_bus_manager *mgr, uint8_t dev, uint8_t tag, bool abort);
+
+    /**
+     * @brief Count the transactions of one device and/or one tag that are queued or still running
+     *        (same matching as spi_bus_manager_cancel()). An item stops counting once it is retired,
+     *        so 0 means the buffers it referenced are no longer read. Any context.
+     * @param mgr Manager.
+     * @param dev Device id, or SPI_BUS_MATCH_ANY.
+     * @param tag Tag, or SPI_BUS_MATCH_ANY.
+     * @return Number of matching transactions.
+     */
+    uint16_t spi_bus_manager_pending(spi_bus_manager *mgr, uint8_t dev, uint8_t tag);
+
+#if SPI_BUS_MANAGER_STATS
+    /**
+     * @brief Copy the statistics accumulated since the last reset. Safe from thread-level and ISR.
+     * @param mgr Manager.
+     * @param out Snapshot (elapsed_ms filled in at the time of the call).
+     */
+    void spi_bus_manager_get_stats(const spi_bus_manager *mgr, spi_bus_stats *out);
+
+    /**
+     * @brief Clear all statistics and start a new measurement window.
+     */
+    void spi_bus_manager_reset_stats(spi_bus_manager *mgr);
+#endif
+
+    /**
+     * @brief Take exclusive ownership of the bus for blocking code (legacy HAL_SPI_Transmit/Receive
+     *        drivers, one-off init sequences). The lease is granted when the bus is between transfers:
+     *        right away if it is idle, otherwise at the end of the in-flight transaction or chunk
+     *        (long chunked frames therefore yield within one chunk). The engine then starts nothing
+     *        until spi_bus_manager_release(); submits keep queueing meanwhile.
+     *        A normal-lane item parked on its device wait does not hold the bus, so the lease can be
+     *        granted while it waits; code that talks to that same device must wait for it itself.
+     *        Blocks (runs spi_bus_manager_on_tick() while spinning). Thread-level only, not reentrant.
+     * @param mgr        Manager.
+     * @param timeout_ms Give up after this long (HAL_MAX_DELAY = wait forever).
+     * @return SPI_BUS_MANAGER_OK when the bus is leased, ERR_BUSY on timeout or if already leased.
+     */
+    spi_bus_manager_status spi_bus_manager_acquire(spi_bus_manager *mgr, uint32_t timeout_ms);
+
+    /**
+     * @brief End a lease taken with spi_bus_manager_acquire() and resume the queue.
+     *        CR1/CR2 are re-applied per transfer, so the holder may leave the SPI configured as it likes
+     *        (but with no transfer running). The lease starts with CR1/CR2 as they were at create(), so
+     *        blocking code runs at the CubeMX rate, not at the last queued device's.
+     */
+    void spi_bus_manager_release(spi_bus_manager *mgr);
+
+    /**
+     * @brief Split normal-priority TX transfers longer than @p max_units into DMA chunks of
+     *        @p max_units data units. CS is released between chunks and the high-priority lane
+     *        is served at each boundary. Each chunk re-applies CR1/CR2, DC and CS, so use it only
+     *        for devices that keep streaming data across CS toggles (e.g. SSD-style display RAM writes).
+     *        Transactions with on_half and chains are never split. 0 disables chunking (default).
+     */
+    static inline void spi_bus_manager_set_chunk_size(spi_bus_manager *mgr, uint16_t max_units)
+    {
+        mgr->chunk_max = max_units;
+    }
+
     /**
      * @brief Enable/disable D-Cache cleaning before TX DMA (for CM7 targets).
      *        On G4 this is a no-op but kept for API compatibility.
@@ -222,9 +735,25 @@ extern "C"
      */
     void spi_bus_manager_on_error(spi_bus_manager *mgr, SPI_HandleTypeDef *hspi);
 
+    /**
+     * @brief Re-check a parked post-transfer wait (wait_ready) and resume the queue when ready,
+     *        advance programs parked on a DELAY / WAIT op, and run the DMA watchdog. Call from a low-rate tick (main loop, SysTick, timer) and/or
+     *        from the EXTI of the device BUSY line. Cheap no-op when nothing is waiting or in flight.
+     *        Safe from thread and ISR. On wait timeout the transaction is failed through on_error
+     *        and the queue moves on; on a DMA timeout the bus is recovered first.
+     */
+    void spi_bus_manager_on_tick(spi_bus_manager *mgr);
+
+    /**
+     * @brief Call from the interrupt of the timer started through spi_bus_manager_set_timer().
+     *        Ends the delay the normal lane is parked on and resumes the queue.
+     */
+    void spi_bus_manager_on_timer(spi_bus_manager *mgr);
+
     /**
      * @brief Enqueue a pure callback item that fires after all previously queued
      *        transactions complete. Executes in manager context (often ISR).
+     *        Safe to call from thread level and ISR.
      * @param mgr   Manager
      * @param cb    Callback to invoke (must be non-NULL)
      * @param user  User pointer passed to callback
@@ -234,6 +763,70 @@ extern "C"
                                                             spi_bus_done_cb cb,
                                                             void *user);
 
+    /**
+     * @brief Enqueue a pause of @p ms milliseconds on the normal lane: transactions queued after it
+     *        start no earlier than @p ms after everything before it has completed. The bus is free
+     *        meanwhile (the high-priority lane keeps running). Safe from thread level and ISR.
+     * @param mgr   Manager
+     * @param ms    Pause length, 1..65535 ms
+     * @return SPI_BUS_MANAGER_OK or *_ERR_*
+     */
+    spi_bus_manager_status spi_bus_manager_enqueue_delay(spi_bus_manager *mgr, uint16_t ms);
+
+    /* ------------------------------- Registry -------------------------------- */
+
+    /**
+     * @brief Register a manager so HAL callbacks for its SPI handle are routed to it by
+     *        spi_bus_manager_dispatch_*(). One manager per SPI instance.
+     *        The manager must live at a stable address (register the final copy, not the
+     *        temporary returned by spi_bus_manager_create()). Call from thread level.
+     * @return SPI_BUS_MANAGER_OK; *_ERR_PARAM for unknown SPI instance;
+     *         *_ERR_BUSY if another manager already owns that instance.
+     */
+    spi_bus_manager_status spi_bus_manager_register(spi_bus_manager *mgr);
+
+    /**
+     * @brief Remove a manager from the registry (no-op if not registered).
+     */
+    void spi_bus_manager_unregister(spi_bus_manager *mgr);
+
+    /**
+     * @brief O(1) lookup of the manager owning @p hspi. Returns NULL if none.
+     */
+    spi_bus_manager *spi_bus_manager_lookup(const SPI_HandleTypeDef *hspi);
+
+    /**
+     * @brief Route HAL SPI callbacks to the registered manager (O(1), ISR-safe).
+     *        Unregistered handles are ignored.
+     */
+    void spi_bus_manager_dispatch_tx_cplt(SPI_HandleTypeDef *hspi);
+    void spi_bus_manager_dispatch_txrx_cplt(SPI_HandleTypeDef *hspi);
+    void spi_bus_manager_dispatch_tx_half(SPI_HandleTypeDef *hspi);
+    void spi_bus_manager_dispatch_txrx_half(SPI_HandleTypeDef *hspi);
+    void spi_bus_manager_dispatch_error(SPI_HandleTypeDef *hspi);
+
+    /**
+     * @brief Call spi_bus_manager_on_tick() on every registered manager.
+     */
+    void spi_bus_manager_tick_all(void);
+
+    /* ------------------------------- Debug trace ------------------------------- */
+
+#if SPI_BUS_MANAGER_DEBUG
+    /** Trace ring and record counter; dump both (e.g. GDB `dump binary value`) to decode offline. */
+    extern spi_bus_trace_record g_spi_trace[SPI_BUS_TRACE_DEPTH];
+    extern volatile uint32_t g_spi_trace_pos;
+
+    /**
+     * @brief Drop a user marker into the trace (e.g. frame start). ISR-safe.
+     * @param tag   Caller-defined marker id.
+     * @param value Caller-defined payload.
+     */
+    void spi_bus_trace_mark(uint8_t tag, uint16_t value);
+#else
+#define spi_bus_trace_mark(tag, value) ((void)0)
+#endif
+
     /* ------------------------------ Usage example ------------------------------
      *
      * // Storage
@@ -248,49 +841,44 @@ extern "C"
      *     return HAL_GPIO_ReadPin(BUSY_PORT, BUSY_PIN) == GPIO_PIN_RESET;
      * }
      *
-     * void app_spi_init(void) {
+     * static spi_bus_device epd_dev;
+     * static uint8_t epd_id;
+     *
+     * void app_spi_init(spi_bus_gpio cs, spi_bus_gpio dc) {
      *     extern SPI_HandleTypeDef hspi1;
      *     spi_mgr = spi_bus_manager_create(&hspi1, spiq_storage, 8);
+     *
+     *     // One profile per slave: lines, CR1/CR2 snapshot (CPOL/CPHA, DS), SCLK limit, BUSY wait
+     *     epd_dev.cs = cs;
+     *     epd_dev.dc = dc;
+     *     epd_dev.cr1 = hspi1.Instance->CR1;
+     *     epd_dev.cr2 = hspi1.Instance->CR2;
+     *     epd_dev.max_sclk_hz = 20000000; // prescaler picked by the manager
+     *     epd_dev.spi_timeout = HAL_MAX_DELAY;
+     *     epd_dev.wait_ready = epd_wait_ready;
+     *     epd_dev.wait_timeout_ms = 12000;
+     *     epd_dev.cb = NULL;
+     *     spi_bus_manager_add_device(&spi_mgr, &epd_dev, &epd_id);
      * }
      *
      * // Enqueue a command and then a big data block for an EPD
      * void epd_send_frame(const uint8_t *cmd, uint16_t cmd_len,
-     *                     const uint8_t *frame, uint16_t frame_len_bytes,
-     *                     spi_bus_gpio cs, spi_bus_gpio dc)
+     *                     const uint8_t *frame, uint16_t frame_len_bytes)
      * {
-     *     spi_bus_transaction t_cmd = {
-     *         .cs = cs,
-     *         .dc = dc,
-     *         .dc_mode = SPI_BUS_DC_COMMAND,
-     *         .cr1 = (hspi1.Instance->CR1 & ~0U), // reuse current CR1 or precompute per device
-     *         .cr2 = (hspi1.Instance->CR2 & ~0U),
-     *         .tx = cmd,
-     *         .rx = NULL,
-     *         .len = cmd_len,
-     *         .dir = SPI_BUS_DIR_TX,
-     *         .spi_timeout = HAL_MAX_DELAY,
-     *         .wait_ready = NULL, .wait_timeout_ms = 0,
-     *         .on_done = NULL, .on_half = NULL, .on_error = NULL,
-     *         .user = NULL
-     *     };
+     *     spi_bus_transaction t_cmd = {0};
+     *     t_cmd.kind = SPI_BUS_ITEM_TX;
+     *     t_cmd.dev = epd_id;
+     *     t_cmd.dir = SPI_BUS_DIR_TX;
+     *     t_cmd.dc_mode = SPI_BUS_DC_COMMAND;
+     *     t_cmd.tx = cmd;
+     *     t_cmd.len = cmd_len;
      *     spi_bus_manager_submit(&spi_mgr, &t_cmd);
      *
-     *     spi_bus_transaction t_data = {
-     *         .cs = cs,
-     *         .dc = dc,
-     *         .dc_mode = SPI_BUS_DC_DATA,
-     *         .cr1 = t_cmd.cr1,
-     *         .cr2 = t_cmd.cr2,
-     *         .tx = frame,
-     *         .rx = NULL,
-     *         .len = frame_len_bytes, // with DS=8; if DS=16 then count in half-words
-     *         .dir = SPI_BUS_DIR_TX,
-     *         .spi_timeout = HAL_MAX_DELAY,
-     *         .wait_ready = epd_wait_ready,      // wait BUSY after data
-     *         .wait_timeout_ms = 12000,
-     *         .on_done = NULL, .on_half = NULL, .on_error = NULL,
-     *         .user = NULL
-     *     };
+     *     spi_bus_transaction t_data = t_cmd;
+     *     t_data.dc_mode = SPI_BUS_DC_DATA;
+     *     t_data.tx = frame;
+     *     t_data.len = frame_len_bytes; // with DS=8; if DS=16 then count in half-words
+     *     t_data.wait = 1;              // wait BUSY after data (device predicate)
      *     spi_bus_manager_submit(&spi_mgr, &t_data);
      * }
      *
@@ -301,10 +889,20 @@ extern "C"
      * void HAL_SPI_TxRxHalfCpltCallback(SPI_HandleTypeDef *h){ spi_bus_manager_on_txrx_half(&spi_mgr, h); }
      * void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)    { spi_bus_manager_on_error(&spi_mgr, hspi); }
      *
+     * // Post-transfer waits are resolved outside of the DMA ISR:
+     * void HAL_GPIO_EXTI_Callback(uint16_t pin)               { if (pin == BUSY_PIN) spi_bus_manager_on_tick(&spi_mgr); }
+     * void app_loop(void)                                     { spi_bus_manager_on_tick(&spi_mgr); ... }
+     *
+     * // Or, with several buses (one manager per SPI instance):
+     * //   spi_bus_manager_register(&spi2_mgr); spi_bus_manager_register(&spi3_mgr);
+     * void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)   { spi_bus_manager_dispatch_tx_cplt(hspi); }
+     * // ... same for the remaining callbacks, and spi_bus_manager_tick_all() from the main loop.
+     *
      * Notes:
      * - Prepare CR1/CR2 snapshots per slave (prescaler, CPOL/CPHA, DS=8/16 etc.) to minimize overhead.
-     * - For large frames, just enqueue one big transaction; DMA handles the bulk. If you need chunking, enqueue multiple.
-     * - If you need to know when "everything drained", poll spi_bus_manager_is_idle() or set per-transaction .on_done.
+     * - For large frames, just enqueue one big transaction; DMA handles the bulk (spi_bus_manager_set_chunk_size()
+     *   splits it so high-priority reads can slip in).
+     * - If you need to know when "everything drained", poll spi_bus_manager_is_idle() or set the device's on_done.
      * -------------------------------------------------------------------------- */
 
 #ifdef __cplusplus
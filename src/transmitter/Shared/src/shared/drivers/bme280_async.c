@@ -1,4 +1,5 @@
 #include "shared/drivers/bme280_async.h"
+#include <stddef.h>
 #include <string.h>
 
 /* ---------------- Reuse danych kalibracyjnych z bmpxx80.c ----------------
@@ -116,20 +117,64 @@ static void _bme280_async_on_error(spi_bus_manager *mgr, void *user)
     dev->error = true;
 }
 
+// wspólna tablica callbacków dla wszystkich transakcji BME280
+static const spi_bus_callbacks _bme280_async_callbacks = {
+    .on_half = NULL,
+    .on_done = _bme280_async_on_done,
+    .on_error = _bme280_async_on_error,
+};
+
 /* --------------------------------- API ---------------------------------- */
 void bme280_async_init(bme280_async *dev,
                        spi_bus_manager *mgr,
                        spi_bus_gpio cs,
                        uint32_t cr1, uint32_t cr2)
 {
-    memset(dev, 0, sizeof(*dev));
+    // profil już w tym managerze (trzyma wskaźnik na bus_dev): nie rejestruj go drugi raz
+    // i nie zeruj go managerowi pod nogami — czyścimy tylko stan od read_tx w dół
+    const bool registered = dev->registered && dev->mgr == mgr &&
+                            dev->bus_dev_id < mgr->device_count &&
+                            mgr->devices[dev->bus_dev_id] == &dev->bus_dev;
+    if (registered)
+        memset(&dev->read_tx, 0, sizeof(*dev) - offsetof(bme280_async, read_tx));
+    else
+        memset(dev, 0, sizeof(*dev));
     dev->mgr = mgr;
-    dev->cs = cs;
-    dev->cr1 = cr1;
-    dev->cr2 = cr2;
     dev->tx9[0] = BME280_PRESSUREDATA | 0x80; // 0xF7 | READ (bit7)
     for (int i = 1; i < 9; i++)
         dev->tx9[i] = 0x00; // dummy clocks
+
+    // profil urządzenia: CS, snapshot CR1/CR2, limit SCLK, callbacki (DC nieużywane)
+    if (!registered)
+    {
+        dev->bus_dev = (spi_bus_device){
+            .cs = cs,
+            .dc = (spi_bus_gpio){.port = NULL, .pin = 0, .active_low = true},
+            .cr1 = cr1,
+            .cr2 = cr2,
+            .max_sclk_hz = BME280_ASYNC_SPI_MAX_HZ,
+            .spi_timeout = HAL_MAX_DELAY,
+            .wait_ready = NULL,
+            .wait_timeout_ms = 0,
+            .cb = &_bme280_async_callbacks};
+        if (spi_bus_manager_add_device(mgr, &dev->bus_dev, &dev->bus_dev_id) == SPI_BUS_MANAGER_OK)
+            dev->registered = true;
+        else
+            dev->error = true; // bus_dev_id nieważne: trigger_read nic nie zleci
+    }
+
+    // deskryptor odczytu jest stały — kolejkowany przez wskaźnik, bez kopiowania
+    dev->read_tx = (spi_bus_transaction){
+        .tx = dev->tx9,
+        .rx = dev->rx9,
+        .user = dev,
+        .len = 9, // 1 bajt adresu + 8 danych
+        .dev = dev->bus_dev_id,
+        .kind = SPI_BUS_ITEM_TX,
+        .dir = SPI_BUS_DIR_TXRX,
+        .dc_mode = SPI_BUS_DC_UNUSED,
+        .priority = SPI_BUS_PRIO_HIGH, // krótki odczyt nie czeka za ramką EPD
+        .wait = 0};
 }
 
 bool bme280_async_is_busy(const bme280_async *dev) { return dev->busy; }
@@ -138,31 +183,14 @@ bme280_measurement bme280_async_get_last(const bme280_async *dev) { return dev->
 
 bool bme280_async_trigger_read(bme280_async *dev)
 {
+    if (!dev->registered)
+        return false; // bez profilu dev 0 to cudze urządzenie (EPD)
     if (dev->busy)
         return true; // już w toku; nie duplikuj
     dev->busy = true;
     dev->error = false;
 
-    spi_bus_transaction t = {
-        .kind = SPI_BUS_ITEM_TX,
-        .cs = dev->cs,
-        .dc = (spi_bus_gpio){.port = NULL, .pin = 0, .active_low = true},
-        .dc_mode = SPI_BUS_DC_UNUSED,
-        .cr1 = dev->cr1,
-        .cr2 = dev->cr2,
-        .tx = dev->tx9,
-        .rx = dev->rx9,
-        .len = 9, // 1 bajt adresu + 8 danych
-        .dir = SPI_BUS_DIR_TXRX,
-        .spi_timeout = HAL_MAX_DELAY,
-        .wait_ready = NULL,
-        .wait_timeout_ms = 0,
-        .on_half = NULL,
-        .on_done = _bme280_async_on_done,
-        .on_error = _bme280_async_on_error,
-        .user = dev};
-
-    spi_bus_manager_status st = spi_bus_manager_submit(dev->mgr, &t);
+    spi_bus_manager_status st = spi_bus_manager_submit_ref(dev->mgr, &dev->read_tx);
     if (st != SPI_BUS_MANAGER_OK)
     {
         dev->busy = false;
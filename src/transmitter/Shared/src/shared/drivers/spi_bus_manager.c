@@ -1,97 +1,256 @@
 #include "shared/drivers/spi_bus_manager.h"
 #include <string.h>
 
-#if SPI_BUS_MANAGER_DEBUG
-#include <stdarg.h>
-#include <stdio.h>
-#include <stdint.h>
-
-/* ============================ DEBUG LOG BUFFER ============================ */
-/* Huge ring buffer for debug logs. Inspect with GDB (g_spi_dbg_log / g_spi_dbg_pos). */
-#ifndef SPI_DBG_LOG_BUF_SIZE
-#define SPI_DBG_LOG_BUF_SIZE (16 * 1024) /* 256 KB; adjust if you need more */
+/* ============================== PLATFORM PORT ============================== */
+/* Every peripheral, clock and interrupt-mask access goes through these hooks. The defaults map
+   to STM32 HAL / CMSIS; spi_bus_manager_glue.h may define any of them first, e.g. to run the
+   manager against a simulated SPI/DMA peripheral and a virtual clock in a host build. */
+#ifndef SPI_BUS_PORT_TX_DMA
+#define SPI_BUS_PORT_TX_DMA(hspi, tx, len) HAL_SPI_Transmit_DMA((hspi), (tx), (len))
 #endif
-
-/* Exposed globals for GDB inspection */
-char g_spi_dbg_log[SPI_DBG_LOG_BUF_SIZE];
-volatile uint32_t g_spi_dbg_pos = 0;
-
-/* Internal helper: fast, IRQ-safe append into ring buffer. */
-static inline void spi_dbg_log_write(const char *src, size_t n)
+#ifndef SPI_BUS_PORT_TXRX_DMA
+#define SPI_BUS_PORT_TXRX_DMA(hspi, tx, rx, len) HAL_SPI_TransmitReceive_DMA((hspi), (tx), (rx), (len))
+#endif
+/* Polled TX of a short segment, every flag wait bounded by @p spins loop iterations: it runs from
+   interrupts where HAL_GetTick is frozen, so HAL_SPI_Transmit's ms timeout would never expire */
+#ifndef SPI_BUS_PORT_TX_POLL
+#define SPI_BUS_PORT_TX_POLL(hspi, tx, len, spins) spi_bus_tx_poll((hspi), (tx), (len), (spins))
+static HAL_StatusTypeDef spi_bus_tx_poll(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint16_t len, uint32_t spins)
 {
-    if (!src || n == 0)
-        return;
-
-    /* Enter short critical section (preserve PRIMASK) */
-    uint32_t primask = __get_PRIMASK();
-    __disable_irq();
-
-    uint32_t pos = g_spi_dbg_pos;
-    uint32_t cap = (uint32_t)SPI_DBG_LOG_BUF_SIZE;
+    SPI_TypeDef *SPIx = hspi->Instance;
+    const bool wide = (SPIx->CR2 & SPI_CR2_DS) > SPI_DATASIZE_8BIT;
+    uint32_t n;
 
-    /* Write with wrap-around. We never block; we just overwrite old data. */
-    for (size_t i = 0; i < n; ++i)
+    for (uint16_t i = 0; i < len; ++i)
     {
-        // DEBUG: Place placeholder here, and get memory address.
-        // Then open cortex-debug memory window (legacy) to see live log.
-        char *addr_dbg_fetcher = &g_spi_dbg_log[pos];
-        g_spi_dbg_log[pos] = src[i];
-        pos++;
-        if (pos >= cap)
-            pos = 0;
+        for (n = spins; (SPIx->SR & SPI_SR_TXE) == 0U; --n)
+            if (n == 0U)
+                return HAL_TIMEOUT;
+        if (wide)
+            SPIx->DR = ((const uint16_t *)(const void *)tx)[i];
+        else
+            *(__IO uint8_t *)&SPIx->DR = tx[i];
     }
-    g_spi_dbg_pos = pos;
 
-    /* Leave critical section */
+    /* Last bit on the wire (CS or DC may change next), as HAL's end-of-transfer check */
+    for (n = spins; (SPIx->SR & SPI_SR_FTLVL) != 0U; --n)
+        if (n == 0U)
+            return HAL_TIMEOUT;
+    for (n = spins; (SPIx->SR & SPI_SR_BSY) != 0U; --n)
+        if (n == 0U)
+            return HAL_TIMEOUT;
+
+    /* Full duplex: drop what was clocked in and the overrun it raised */
+    while ((SPIx->SR & SPI_SR_FRLVL) != 0U)
+        (void)*(__IO uint8_t *)&SPIx->DR;
+    (void)SPIx->SR;
+    return HAL_OK;
+}
+#endif
+#ifndef SPI_BUS_PORT_GPIO_WRITE
+#define SPI_BUS_PORT_GPIO_WRITE(port, pin, state) HAL_GPIO_WritePin((port), (pin), (state))
+#endif
+/* Reprogram CR1/CR2 of the bound SPI */
+#ifndef SPI_BUS_PORT_APPLY_REGS
+#define SPI_BUS_PORT_APPLY_REGS(hspi, cr1, cr2) spi_bus_apply_regs((hspi)->Instance, (cr1), (cr2))
+/* Fast switch SPI registers without full HAL re-init. Stop SPE, write CR1/CR2, restart SPE. */
+static void spi_bus_apply_regs(SPI_TypeDef *SPIx, uint32_t cr1, uint32_t cr2)
+{
+    /* Disable SPI to safely change CR1/CR2 */
+    CLEAR_BIT(SPIx->CR1, SPI_CR1_SPE);
+    SPIx->CR1 = cr1;
+    SPIx->CR2 = cr2;
+    SET_BIT(SPIx->CR1, SPI_CR1_SPE);
+}
+#endif
+/* Read back CR1/CR2 of the bound SPI (the configuration a lease hands to blocking code) */
+#ifndef SPI_BUS_PORT_READ_REGS
+#define SPI_BUS_PORT_READ_REGS(hspi, cr1, cr2) \
+    do                                         \
+    {                                          \
+        (cr1) = (hspi)->Instance->CR1;         \
+        (cr2) = (hspi)->Instance->CR2;         \
+    } while (0)
+#endif
+/* Kernel clock of the bound SPI, divided by the baud-rate prescaler (SPI1/SPI4 on APB2, others on APB1) */
+#ifndef SPI_BUS_PORT_KERNEL_HZ
+#define SPI_BUS_PORT_KERNEL_HZ(hspi) spi_bus_kernel_hz((hspi)->Instance)
+static uint32_t spi_bus_kernel_hz(const SPI_TypeDef *SPIx)
+{
+#if defined(SPI1)
+    if (SPIx == SPI1)
+        return HAL_RCC_GetPCLK2Freq();
+#endif
+#if defined(SPI4)
+    if (SPIx == SPI4)
+        return HAL_RCC_GetPCLK2Freq();
+#endif
+    (void)SPIx;
+    return HAL_RCC_GetPCLK1Freq();
+}
+#endif
+/* Bring the SPI back after a lost DMA completion: abort both DMA channels, then re-init the
+   peripheral from hspi->Init (MspDeInit/MspInit also reset its DMA channels) */
+#ifndef SPI_BUS_PORT_RECOVER
+#define SPI_BUS_PORT_RECOVER(hspi) spi_bus_recover_periph(hspi)
+static void spi_bus_recover_periph(SPI_HandleTypeDef *hspi)
+{
+    (void)HAL_SPI_Abort(hspi);
+    (void)HAL_SPI_DeInit(hspi);
+    (void)HAL_SPI_Init(hspi);
+}
+#endif
+/* Stop the SPI and its DMA channels from raising anything more for the transfer in flight, without
+   waiting on any flag (interrupts are off). RECOVER or ABORT then stop the wire itself. */
+#ifndef SPI_BUS_PORT_QUIESCE
+#define SPI_BUS_PORT_QUIESCE(hspi) spi_bus_quiesce_periph(hspi)
+static void spi_bus_quiesce_periph(SPI_HandleTypeDef *hspi)
+{
+    CLEAR_BIT(hspi->Instance->CR2, SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN | SPI_CR2_TXEIE | SPI_CR2_RXNEIE | SPI_CR2_ERRIE);
+    if (hspi->hdmatx)
+        __HAL_DMA_DISABLE_IT(hspi->hdmatx, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+    if (hspi->hdmarx)
+        __HAL_DMA_DISABLE_IT(hspi->hdmarx, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+}
+#endif
+/* Stop the transfer on the wire on request (spi_bus_manager_cancel()); the peripheral stays configured */
+#ifndef SPI_BUS_PORT_ABORT
+#define SPI_BUS_PORT_ABORT(hspi) ((void)HAL_SPI_Abort(hspi))
+#endif
+#ifndef SPI_BUS_PORT_TICK_MS
+#define SPI_BUS_PORT_TICK_MS() HAL_GetTick()
+#endif
+/* Free-running cycle counter for trace stamps, statistics and profiling (HAL tick without DWT) */
+#ifndef SPI_BUS_PORT_CYCLES
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3U)
+#define SPI_BUS_PORT_CYCLES() (DWT->CYCCNT)
+#define SPI_BUS_PORT_CYCLES_INIT()                          \
+    do                                                      \
+    {                                                       \
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     \
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                \
+    } while (0)
+#else
+#define SPI_BUS_PORT_CYCLES() HAL_GetTick()
+#endif
+#endif
+#ifndef SPI_BUS_PORT_CYCLES_INIT
+#define SPI_BUS_PORT_CYCLES_INIT() ((void)0)
+#endif
+/* Short critical section; nests (restores the previous mask) and works from any ISR */
+#ifndef SPI_BUS_PORT_IRQ_SAVE
+#define SPI_BUS_PORT_IRQ_SAVE() spi_bus_irq_save()
+#define SPI_BUS_PORT_IRQ_RESTORE(state) spi_bus_irq_restore(state)
+static inline uint32_t spi_bus_irq_save(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+static inline void spi_bus_irq_restore(uint32_t primask)
+{
     if (!primask)
         __enable_irq();
 }
+#endif
+/* 1 = LDREX/STREX available for the lock-free paths, 0 = fall back to critical sections */
+#ifndef SPI_BUS_PORT_HAS_EXCLUSIVES
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3U)
+#define SPI_BUS_PORT_HAS_EXCLUSIVES 1
+#else
+#define SPI_BUS_PORT_HAS_EXCLUSIVES 0
+#endif
+#endif
 
-/* printf-style logger. Keep messages short in ISR. */
-static void spi_dbg_log(const char *fmt, ...)
+/* Cycle stamp for trace records and statistics */
+static inline uint32_t spi_bus_now(void)
 {
-    char tmp[192]; /* small stack buffer to limit ISR time; truncate if needed */
-    va_list ap;
-    va_start(ap, fmt);
-    int len = vsnprintf(tmp, sizeof(tmp), fmt, ap);
-    va_end(ap);
-
-    if (len <= 0)
-        return;
-    size_t n = (size_t)((len < (int)sizeof(tmp)) ? len : (int)sizeof(tmp));
-    spi_dbg_log_write(tmp, n);
+    return SPI_BUS_PORT_CYCLES();
 }
 
-/* Optional helper: put a newline quickly (avoids extra format work). */
-static inline void spi_dbg_nl(void) { spi_dbg_log_write("\n", 1); }
+#if SPI_BUS_MANAGER_DEBUG
+/* ============================ BINARY EVENT TRACE ============================ */
+/* Fixed 12-byte records instead of formatted text: a trace point costs a PRIMASK section and
+   six stores, so enabling it no longer shifts ISR timing. Dump g_spi_trace / g_spi_trace_pos
+   and decode offline with src/station/tests/host/tools/spi_trace_dump (record layout and event
+   ids in spi_bus_manager.h). */
+#if (SPI_BUS_TRACE_DEPTH & (SPI_BUS_TRACE_DEPTH - 1)) != 0
+#error "SPI_BUS_TRACE_DEPTH must be a power of two"
+#endif
 
-/* Quick hexdump of small buffers (useful for SPI headers). Keep tiny in ISR). */
-static void spi_dbg_hexdump(const uint8_t *p, size_t n)
+spi_bus_trace_record g_spi_trace[SPI_BUS_TRACE_DEPTH];
+volatile uint32_t g_spi_trace_pos = 0;
+
+/* Append one record; safe from thread and any ISR (oldest records are overwritten). */
+static void spi_trace_put(uint8_t event, uint8_t arg, uint16_t head, uint16_t tail, uint16_t len)
 {
-    if (!p || n == 0)
-        return;
-    /* Cap to avoid huge ISR time */
-    if (n > 32)
-        n = 32;
-    char line[3 * 32 + 8];
-    size_t off = 0;
-    for (size_t i = 0; i < n && off + 3 < sizeof(line); ++i)
-        off += (size_t)snprintf(line + off, sizeof(line) - off, "%02X ", p[i]);
-    spi_dbg_log_write(line, off);
-    spi_dbg_nl();
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+
+    spi_bus_trace_record *r = &g_spi_trace[g_spi_trace_pos & (SPI_BUS_TRACE_DEPTH - 1u)];
+    g_spi_trace_pos++;
+    r->stamp = spi_bus_now();
+    r->event = event;
+    r->arg = arg;
+    r->head = head;
+    r->tail = tail;
+    r->len = len;
+
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
 }
 
-/* Quick helper to reset/mark the log (call from your code if needed) */
-void spi_dbg_mark(const char *tag)
+/* Item event on lane @p rq: head = slot of the lane head */
+#define spi_trace(ev, rq, arg, len)                                                       \
+    spi_trace_put((uint8_t)((ev) | ((rq)->lane ? SPI_BUS_TRACE_HIGH_LANE : 0u)), (uint8_t)(arg), \
+                  (rq)->head, (rq)->tail, (uint16_t)(len))
+/* Event on an explicit slot (push) */
+#define spi_trace_slot(ev, rq, slot, arg, len)                                            \
+    spi_trace_put((uint8_t)((ev) | ((rq)->lane ? SPI_BUS_TRACE_HIGH_LANE : 0u)), (uint8_t)(arg), \
+                  (slot), (rq)->tail, (uint16_t)(len))
+
+/* Submit refused by validation (mgr may be NULL) */
+static inline void spi_trace_reject(const spi_bus_manager *mgr, spi_bus_trace_reject why)
 {
-    spi_dbg_log("=== %s ===\n", tag ? tag : "MARK");
+    spi_trace_put(SPI_BUS_TRACE_REJECT, (uint8_t)why, mgr ? mgr->q.head : 0u, mgr ? mgr->q.tail : 0u, 0u);
+}
+
+void spi_bus_trace_mark(uint8_t tag, uint16_t value)
+{
+    spi_trace_put(SPI_BUS_TRACE_MARK, tag, 0u, 0u, value);
 }
 #else
 /* No-op if debug disabled */
-#define spi_dbg_log(...) ((void)0)
-#define spi_dbg_nl() ((void)0)
-#define spi_dbg_hexdump(p, n) ((void)0)
-#define spi_dbg_mark(tag) ((void)0)
+#define spi_trace(ev, rq, arg, len) ((void)0)
+#define spi_trace_slot(ev, rq, slot, arg, len) ((void)0)
+#define spi_trace_reject(mgr, why) ((void)0)
+#endif
+
+#if SPI_BUS_MANAGER_DEBUG || SPI_BUS_MANAGER_PROFILE || SPI_BUS_MANAGER_STATS
+#define spi_cyccnt_init() SPI_BUS_PORT_CYCLES_INIT()
+#else
+#define spi_cyccnt_init() ((void)0)
+#endif
+
+#if SPI_BUS_MANAGER_PROFILE
+/* ============================ ISR CYCLE PROFILER ============================ */
+/* DWT cycle counts spent in the completion path. Inspect with GDB; clear
+   g_spi_prof_isr_* before an EPD frame to get per-frame totals. */
+volatile uint32_t g_spi_prof_isr_cycles = 0; /* accumulated cycles */
+volatile uint32_t g_spi_prof_isr_count = 0;  /* number of completions */
+volatile uint32_t g_spi_prof_isr_max = 0;    /* worst single completion */
+
+static inline uint32_t spi_prof_begin(void) { return spi_bus_now(); }
+
+static inline void spi_prof_end(uint32_t start)
+{
+    uint32_t dt = spi_bus_now() - start;
+    g_spi_prof_isr_cycles += dt;
+    g_spi_prof_isr_count++;
+    if (dt > g_spi_prof_isr_max)
+        g_spi_prof_isr_max = dt;
+}
+#else
+#define spi_prof_begin() 0u
+#define spi_prof_end(start) ((void)(start))
 #endif
 
 /* ------------------------- Internal helpers/macros ------------------------- */
@@ -123,14 +282,71 @@ static inline bool spi_is_16bit(uint32_t cr2)
 }
 
 #define SPI_Q_INCR(i, cap) (uint16_t)(((i) + 1) % (cap))
-#define SPI_Q_EMPTY(m) ((m)->q_head == (m)->q_tail)
-#define SPI_Q_FULL(m) (SPI_Q_INCR((m)->q_tail, (m)->q_capacity) == (m)->q_head)
+#define SPI_Q_EMPTY(rq) ((rq)->head == (rq)->tail)
+#define SPI_Q_VALID(rq) ((rq)->items != NULL && (rq)->capacity > 1)
+
+/* Lock-free primitives.
+   Producers (thread or any ISR) reserve a ring slot with a CAS on tail, fill it and publish it
+   through its `published` flag. The engine (start / advance logic) is serialized by a try-lock:
+   a context that fails to take it leaves a kick for the owner instead of waiting. */
+#if SPI_BUS_PORT_HAS_EXCLUSIVES
+static inline bool spi_bus_cas16(volatile uint16_t *p, uint16_t expected, uint16_t desired)
+{
+    do
+    {
+        if (__LDREXH(p) != expected)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXH(desired, p) != 0U);
+    return true;
+}
 
-static inline void spi_bus_gpio_set(const spi_bus_gpio *g, bool active)
+static inline bool spi_bus_try_lock(volatile uint8_t *lock)
+{
+    do
+    {
+        if (__LDREXB(lock) != 0U)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXB(1U, lock) != 0U);
+    __DMB();
+    return true;
+}
+#else
+/* No exclusives (ARMv6-M, host port): a few-instruction critical section does the same job */
+static inline bool spi_bus_cas16(volatile uint16_t *p, uint16_t expected, uint16_t desired)
+{
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+    bool ok = (*p == expected);
+    if (ok)
+        *p = desired;
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+    return ok;
+}
+
+static inline bool spi_bus_try_lock(volatile uint8_t *lock)
+{
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+    bool ok = (*lock == 0U);
+    if (ok)
+        *lock = 1U;
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+    return ok;
+}
+#endif
+
+static inline void spi_bus_unlock(volatile uint8_t *lock)
 {
-    spi_dbg_log("gpio_set port=%p pin=%u active=%d (active_low=%d)\n",
-                (void *)g->port, (unsigned)g->pin, (int)active, (int)g->active_low);
+    __DMB();
+    *lock = 0U;
+}
 
+static inline void spi_bus_gpio_set(const spi_bus_gpio *g, bool active)
+{
     if (!g->port)
         return;
     GPIO_PinState s = GPIO_PIN_RESET;
@@ -138,25 +354,22 @@ static inline void spi_bus_gpio_set(const spi_bus_gpio *g, bool active)
     if (g->active_low)
         want_active = !active;
     s = want_active ? GPIO_PIN_SET : GPIO_PIN_RESET;
-    HAL_GPIO_WritePin(g->port, g->pin, s);
+    SPI_BUS_PORT_GPIO_WRITE(g->port, g->pin, s);
 }
 
 /* Active means asserting the line (CS active, DC=1 for data, DC=0 for command) */
 static inline void spi_bus_cs_assert(const spi_bus_gpio *cs)
 {
-    spi_dbg_log("cs_assert port=%p pin=%u\n", (void *)cs->port, (unsigned)cs->pin);
     spi_bus_gpio_set(cs, true);
 }
 static inline void spi_bus_cs_deassert(const spi_bus_gpio *cs)
 {
-    spi_dbg_log("cs_deassert port=%p pin=%u\n", (void *)cs->port, (unsigned)cs->pin);
     spi_bus_gpio_set(cs, false);
 }
 
 /* DC helper: mode -> level */
 static inline void spi_bus_dc_apply(const spi_bus_gpio *dc, spi_bus_dc_mode mode)
 {
-    spi_dbg_log("dc_apply port=%p pin=%u mode=%d\n", (void *)dc->port, (unsigned)dc->pin, (int)mode);
     if (!dc->port || mode == SPI_BUS_DC_UNUSED)
         return;
     /* COMMAND -> active=false; DATA -> active=true (treat active as DC=1) */
@@ -165,21 +378,9 @@ static inline void spi_bus_dc_apply(const spi_bus_gpio *dc, spi_bus_dc_mode mode
     spi_bus_gpio_set(dc, as_active);
 }
 
-/* Fast switch SPI registers without full HAL re-init. Stop SPE, write CR1/CR2, restart SPE. */
-static void spi_bus_apply_regs(SPI_TypeDef *SPIx, uint32_t cr1, uint32_t cr2)
-{
-    spi_dbg_log("apply_regs SPIx=%p CR1=0x%08lX CR2=0x%08lX\n", (void *)SPIx, (unsigned long)cr1, (unsigned long)cr2);
-    /* Disable SPI to safely change CR1/CR2 */
-    CLEAR_BIT(SPIx->CR1, SPI_CR1_SPE);
-    SPIx->CR1 = cr1;
-    SPIx->CR2 = cr2;
-    SET_BIT(SPIx->CR1, SPI_CR1_SPE);
-}
-
 /* Optional D-Cache clean (no-op on CM4/G4) */
 static inline void spi_bus_clean_dcache_region(const void *addr, size_t len)
 {
-    spi_dbg_log("dcache_clean addr=%p len=%lu\n", addr, (unsigned long)len);
 #if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
     /* Align to 32 bytes lines */
     uintptr_t a = (uintptr_t)addr;
@@ -192,316 +393,1488 @@ static inline void spi_bus_clean_dcache_region(const void *addr, size_t len)
 #endif
 }
 
-/* Current in-flight transaction pointer (not re-entrant) */
-static spi_bus_transaction *spi_bus_peek_current(spi_bus_manager *mgr)
+/* Ring of the in-flight / parked item */
+static inline spi_bus_queue *spi_bus_active_queue(spi_bus_manager *mgr)
+{
+    return mgr->hq_active ? &mgr->hq : &mgr->q;
+}
+
+/* Head of a ring, or NULL if empty or its producer has not published it yet
+   (that producer kicks the engine right after publishing). Reference slots are resolved
+   to the static descriptor they point at. */
+static const spi_bus_transaction *spi_bus_peek(spi_bus_queue *rq)
 {
-    spi_dbg_log("peek_current busy=%d head=%u tail=%u\n", (int)mgr->busy, mgr->q_head, mgr->q_tail);
-    if (SPI_Q_EMPTY(mgr))
+    if (!SPI_Q_VALID(rq) || SPI_Q_EMPTY(rq))
         return NULL;
-    return &mgr->q[mgr->q_head];
+    const spi_bus_transaction *t = &rq->items[rq->head];
+    if (!t->published)
+        return NULL;
+    __DMB();
+    return (t->kind == SPI_BUS_ITEM_REF) ? t->ref : t;
 }
 
-/* Pop head (after finishing a transaction) */
-static void spi_bus_pop(spi_bus_manager *mgr)
+/* Device profile of a transaction (validated at submit) */
+static inline const spi_bus_device *spi_bus_dev(const spi_bus_manager *mgr, const spi_bus_transaction *t)
 {
-    spi_dbg_log("pop head=%u -> %u (cap=%u)\n", mgr->q_head, SPI_Q_INCR(mgr->q_head, mgr->q_capacity), mgr->q_capacity);
-    if (!SPI_Q_EMPTY(mgr))
-        mgr->q_head = SPI_Q_INCR(mgr->q_head, mgr->q_capacity);
+    return mgr->devices[t->dev];
 }
 
-/* Start next transaction if any (called at thread-level and ISR-level). */
-static void spi_bus_try_start(spi_bus_manager *mgr)
+/* Shared callback table of the transaction's device (may be NULL) */
+static inline const spi_bus_callbacks *spi_bus_cbs(const spi_bus_manager *mgr, const spi_bus_transaction *t)
 {
-    spi_dbg_log("try_start busy=%d empty=%d\n", (int)mgr->busy, (int)SPI_Q_EMPTY(mgr));
+    return spi_bus_dev(mgr, t)->cb;
+}
 
-    if (mgr->busy)
-        return;
+/* Switch the SPI to a device's registers (CR1 with the derived prescaler) */
+static inline void spi_bus_apply_device(spi_bus_manager *mgr, uint8_t dev)
+{
+    SPI_BUS_PORT_APPLY_REGS(mgr->spi, mgr->dev_cr1[dev], mgr->devices[dev]->cr2);
+}
 
-    if (SPI_Q_EMPTY(mgr))
-        return;
+static inline void spi_bus_notify_half(spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    const spi_bus_callbacks *cb = spi_bus_cbs(mgr, t);
+    if (cb && cb->on_half)
+        cb->on_half(mgr, t->user);
+}
 
-    spi_bus_transaction *t = &mgr->q[mgr->q_head];
+static inline void spi_bus_notify_done(spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    const spi_bus_callbacks *cb = spi_bus_cbs(mgr, t);
+    if (cb && cb->on_done)
+        cb->on_done(mgr, t->user);
+}
 
-    /* callback-only item – no DMA, no CS/DC */
-    if (t->kind == SPI_BUS_ITEM_CALLBACK)
-    {
-        spi_dbg_log("start callback at head=%u user=%p\n", mgr->q_head, t->user);
-        if (t->on_done)
-            t->on_done(mgr, t->user);
-        /* Pop and immediately try the next one (may chain callbacks) */
-        spi_bus_pop(mgr);
-        /* Do not set busy for pure callback */
-        spi_bus_try_start(mgr);
-        return;
-    }
+static inline void spi_bus_notify_error(spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    const spi_bus_callbacks *cb = spi_bus_cbs(mgr, t);
+    if (cb && cb->on_error)
+        cb->on_error(mgr, t->user);
+}
 
-    mgr->busy = true;
+#if SPI_BUS_MANAGER_STATS
+/* ============================ BUS STATISTICS ============================ */
+/* Engine-side counters are written under the engine lock; the producer-side ones (high-water
+   marks, rejects) are plain read-modify-writes and may rarely lose a concurrent update. */
 
-    spi_dbg_log("start tx head=%u dir=%d len=%u dc_mode=%d cs.port=%p ds=%s\n",
-                mgr->q_head, (int)t->dir, (unsigned)t->len, (int)t->dc_mode,
-                (void *)t->cs.port, spi_is_16bit(t->cr2) ? "16" : "8");
+/* Cycle histograms start at 64 cycles (1 us at 64 MHz) */
+#define SPI_STATS_CYCLE_SHIFT 6u
 
-    /* Apply SPI registers quickly */
-    spi_bus_apply_regs(mgr->spi->Instance, t->cr1, t->cr2);
+/* log2 bucket: 0 for v == 0, k for v in [2^(k-1), 2^k), last bucket open-ended */
+static inline uint32_t spi_stats_bucket(uint32_t v)
+{
+    if (v == 0u)
+        return 0u;
+    uint32_t b = 32u - __CLZ(v);
+    return (b < SPI_BUS_STATS_BUCKETS) ? b : (SPI_BUS_STATS_BUCKETS - 1u);
+}
 
-    /* DC first, then CS - very important */
-    spi_bus_dc_apply(&t->dc, t->dc_mode);
-    spi_bus_cs_assert(&t->cs);
+static inline void spi_stats_reject(spi_bus_manager *mgr)
+{
+    if (mgr)
+        mgr->stats.rejected++;
+}
 
-    /* Clean DCache for TX if enabled */
-    if (mgr->clean_dcache_before_tx && t->tx && t->len)
-    {
-        size_t bytes = (size_t)t->len * (spi_is_16bit(t->cr2) ? 2u : 1u);
-        spi_bus_clean_dcache_region(t->tx, bytes);
-    }
+/* Item published on @p rq: track the lane depth high-water mark */
+static inline void spi_stats_pushed(spi_bus_manager *mgr, const spi_bus_queue *rq)
+{
+    uint16_t depth = (uint16_t)((rq->tail + rq->capacity - rq->head) % rq->capacity);
+    uint16_t *hwm = rq->lane ? &mgr->stats.hq_hwm : &mgr->stats.q_hwm;
+    if (depth > *hwm)
+        *hwm = depth;
+}
 
-    HAL_StatusTypeDef hs;
-    if (t->dir == SPI_BUS_DIR_TXRX)
-    {
-        spi_dbg_log("HAL_SPI_TransmitReceive_DMA tx=%p rx=%p len=%u\n", t->tx, t->rx, (unsigned)t->len);
-        hs = HAL_SPI_TransmitReceive_DMA(mgr->spi, (uint8_t *)t->tx, t->rx, t->len);
-    }
-    else
-    {
-        spi_dbg_log("HAL_SPI_Transmit_DMA tx=%p len=%u\n", t->tx, (unsigned)t->len);
-        hs = HAL_SPI_Transmit_DMA(mgr->spi, (uint8_t *)t->tx, t->len);
-    }
+/* A transfer of the head item of @p rq starts; @p first = first transfer of the item */
+static inline void spi_stats_start(spi_bus_manager *mgr, const spi_bus_queue *rq, bool first)
+{
+    uint32_t now = spi_bus_now();
+    mgr->xfer_stamp = now;
+    if (!first)
+        return;
+    uint32_t dt = now - rq->items[rq->head].enq_stamp;
+    mgr->stats.enq_to_start[spi_stats_bucket(dt >> SPI_STATS_CYCLE_SHIFT)]++;
+    if (dt > mgr->stats.enq_to_start_max)
+        mgr->stats.enq_to_start_max = dt;
+}
 
-    if (hs != HAL_OK)
-    {
-        spi_dbg_log("DMA start FAILED hs=%d\n", (int)hs);
-        /* Deassert CS to avoid holding the bus if start failed */
-        spi_bus_cs_deassert(&t->cs);
-        mgr->busy = false;
-        if (t->on_error)
-            t->on_error(mgr, t->user);
-        /* Drop this transaction to avoid stalling the queue */
-        spi_bus_pop(mgr);
-        /* Try next (prevent infinite loop if all fail) */
-        mgr->busy = false;
-        spi_bus_try_start(mgr);
-    }
+/* The in-flight transfer (DMA transfer, chunk or whole chain) has left the wire */
+static inline void spi_stats_xfer_done(spi_bus_manager *mgr)
+{
+    uint32_t dt = spi_bus_now() - mgr->xfer_stamp;
+    mgr->stats.busy_cycles += dt;
+    mgr->stats.start_to_cplt[spi_stats_bucket(dt >> SPI_STATS_CYCLE_SHIFT)]++;
+    if (dt > mgr->stats.start_to_cplt_max)
+        mgr->stats.start_to_cplt_max = dt;
 }
 
-/* Process post-transfer wait (busy predicate) in a tight loop with timeout.
-   Called in ISR tail (still interrupt context), keep it short: polling + HAL_GetTick() is OK. */
-static bool spi_bus_do_post_wait(spi_bus_transaction *t)
+static inline void spi_stats_bytes(spi_bus_manager *mgr, const spi_bus_transaction *t, uint32_t units)
 {
-    spi_dbg_log("post_wait timeout=%lu has_cb=%d\n", (unsigned long)t->wait_timeout_ms, (int)(t->wait_ready != NULL));
-    if (!t->wait_ready)
-        return true;
-    uint32_t start = HAL_GetTick();
-    for (;;)
-    {
-        if (t->wait_ready(t->user))
-        {
-            spi_dbg_log("post_wait done ok\n");
-            return true;
-        }
-        if (t->wait_timeout_ms > 0U)
-        {
-            if ((HAL_GetTick() - start) >= t->wait_timeout_ms)
-            {
-                spi_dbg_log("post_wait TIMEOUT after %lu ms\n", (unsigned long)(HAL_GetTick() - start));
-                return false;
-            }
-        }
-        __NOP();
-        __NOP();
-        __NOP();
-    }
+    uint32_t unit = spi_is_16bit(spi_bus_dev(mgr, t)->cr2) ? 2u : 1u;
+    mgr->stats.bytes[t->dev] += units * unit;
 }
 
-/* Common tail for complete (TX or TXRX) */
-static void spi_bus_on_complete_common(spi_bus_manager *mgr, bool half, bool is_txrx)
+static inline void spi_stats_post_wait(spi_bus_manager *mgr, uint32_t ms)
 {
-    spi_dbg_log("on_complete_common half=%d txrx=%d\n", (int)half, (int)is_txrx);
-    spi_bus_transaction *t = spi_bus_peek_current(mgr);
-    if (!t)
-    {
-        spi_dbg_log("on_complete: no current tx\n");
-        mgr->busy = false;
-        return;
-    }
+    mgr->stats.post_wait_ms[spi_stats_bucket(ms)]++;
+    if (ms > mgr->stats.post_wait_max_ms)
+        mgr->stats.post_wait_max_ms = ms;
+}
 
-    if (half)
+#define spi_stats_inc(mgr, field) ((mgr)->stats.field++)
+#define spi_stats_add(mgr, field, n) ((mgr)->stats.field += (n))
+#else
+#define spi_stats_reject(mgr) ((void)0)
+#define spi_stats_pushed(mgr, rq) ((void)0)
+#define spi_stats_start(mgr, rq, first) ((void)0)
+#define spi_stats_xfer_done(mgr) ((void)0)
+#define spi_stats_bytes(mgr, t, units) ((void)0)
+#define spi_stats_post_wait(mgr, ms) ((void)0)
+#define spi_stats_inc(mgr, field) ((void)0)
+#define spi_stats_add(mgr, field, n) ((void)0)
+#endif
+
+/* Pop head (after finishing a transaction). Engine-only: head has a single writer. */
+static void spi_bus_pop(spi_bus_queue *rq)
+{
+    if (!SPI_Q_EMPTY(rq))
     {
-        spi_dbg_log("on_half user=%p\n", t->user);
-        if (t->on_half)
-            t->on_half(mgr, t->user);
-        return; /* still in progress; don't touch CS or queue */
+        rq->items[rq->head].published = 0U;
+        __DMB();
+        rq->head = SPI_Q_INCR(rq->head, rq->capacity);
     }
+}
 
+/* Multi-producer push, safe from thread and ISR context: reserve a slot (CAS on tail),
+   copy the item in and publish it. */
+static spi_bus_manager_status spi_bus_push(spi_bus_queue *rq, const spi_bus_transaction *t)
+{
+    uint16_t slot;
+    uint16_t next;
+    do
     {
-        /* ensure last bit is clocked out */
-        uint32_t t0 = HAL_GetTick();
-        while (__HAL_SPI_GET_FLAG(mgr->spi, SPI_FLAG_BSY))
+        slot = rq->tail;
+        next = SPI_Q_INCR(slot, rq->capacity);
+        if (next == rq->head)
         {
-            if ((HAL_GetTick() - t0) > 2)
-                break; /* ~2 ms guard */
+            spi_trace(SPI_BUS_TRACE_FULL, rq, t->kind, 0u);
+            return SPI_BUS_MANAGER_ERR_FULL;
         }
-        spi_bus_cs_deassert(&t->cs);
-    }
+    } while (!spi_bus_cas16(&rq->tail, slot, next));
 
-    /* Post-transfer wait (e.g., device BUSY). Fail -> call error callback. */
-    if (!spi_bus_do_post_wait(t))
-    {
-        spi_dbg_log("on_done: post_wait failed -> on_error\n");
-        if (t->on_error)
-            t->on_error(mgr, t->user);
-    }
-    else
+    /* Copy via a local so the slot never shows a stale `published` while being filled */
+    spi_bus_transaction item = *t;
+    item.published = 0U;
+#if SPI_BUS_MANAGER_STATS
+    item.enq_stamp = spi_bus_now();
+#endif
+    rq->items[slot] = item;
+    __DMB();
+    rq->items[slot].published = 1U;
+
+    spi_trace_slot(SPI_BUS_TRACE_PUSH, rq, slot, t->kind, (t->kind == SPI_BUS_ITEM_REF) ? t->ref->len : t->len);
+    return SPI_BUS_MANAGER_OK;
+}
+
+/* Normal-lane head has started but not finished (mid-chunk, mid-program, in flight or parked). */
+static inline bool spi_bus_normal_head_active(const spi_bus_manager *mgr)
+{
+    return mgr->waiting || mgr->chunk_off != 0 || mgr->prog_pc != 0 || (mgr->busy && !mgr->hq_active);
+}
+
+/* Why the normal lane is parked (mgr->park) */
+typedef enum
+{
+    SPI_BUS_PARK_RETIRE = 0, /* post-transfer wait, the item retires when ready */
+    SPI_BUS_PARK_DELAY,      /* program DELAY op, resumes after park_ms */
+    SPI_BUS_PARK_READY       /* program WAIT op, resumes when wait_ready passes */
+} spi_bus_park;
+
+/* Park the normal-lane head for spi_bus_manager_on_tick(). The bus itself stays free.
+   A delay (park_ms set by the caller) also starts the one-shot timer when one is attached. */
+static inline void spi_bus_park_head(spi_bus_manager *mgr, const spi_bus_queue *rq, const spi_bus_transaction *t, spi_bus_park why)
+{
+    spi_trace(SPI_BUS_TRACE_PARK, rq, t->dev, (uint16_t)why);
+    mgr->park = (uint8_t)why;
+    mgr->wait_start_ms = SPI_BUS_PORT_TICK_MS();
+    if (why == SPI_BUS_PARK_DELAY)
     {
-        spi_dbg_log("on_done: invoking on_done user=%p\n", t->user);
-        if (t->on_done)
-            t->on_done(mgr, t->user);
+        mgr->timer_fired = 0U;
+        if (mgr->timer_start)
+            mgr->timer_start(mgr->timer_ctx, mgr->park_ms);
     }
+    mgr->waiting = true;
+}
 
-    /* Remove transaction and move on */
-    spi_bus_pop(mgr);
-    mgr->busy = false;
-    spi_bus_try_start(mgr);
+/* Chunking applies to plain TX items of the normal lane only. Items with on_half are never
+   split: their half-transfer callback refers to the whole buffer. */
+static inline bool spi_bus_is_chunked(const spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    if (mgr->chunk_max == 0 || t->kind != SPI_BUS_ITEM_TX || t->dir != SPI_BUS_DIR_TX || t->len <= mgr->chunk_max)
+        return false;
+    const spi_bus_callbacks *cb = spi_bus_cbs(mgr, t);
+    return !(cb && cb->on_half);
 }
 
-/* ------------------------------ Public API -------------------------------- */
+/* Arm the DMA watchdog for a transfer about to start (before the start: it may complete at once). */
+static inline void spi_bus_watchdog_arm(spi_bus_manager *mgr, const spi_bus_device *d)
+{
+    mgr->xfer_start_ms = SPI_BUS_PORT_TICK_MS();
+    mgr->xfer_timeout_ms = (d->spi_timeout != HAL_MAX_DELAY) ? d->spi_timeout : SPI_BUS_MANAGER_DMA_TIMEOUT_MS;
+}
 
-spi_bus_manager spi_bus_manager_create(SPI_HandleTypeDef *spi,
-                                       spi_bus_transaction *storage,
-                                       uint16_t capacity)
+/* Program CR1/CR2, DC, CS and kick DMA for [tx + off, tx + off + len). */
+static HAL_StatusTypeDef spi_bus_start_dma(spi_bus_manager *mgr, const spi_bus_transaction *t, uint16_t off, uint16_t len)
 {
-    spi_dbg_log("mgr_create spi=%p storage=%p cap=%u\n", (void *)spi, (void *)storage, (unsigned)capacity);
+    const spi_bus_device *d = spi_bus_dev(mgr, t);
+    const size_t unit = spi_is_16bit(d->cr2) ? 2u : 1u;
+    const uint8_t *tx = t->tx + (size_t)off * unit;
 
-    spi_bus_manager m;
-    m.spi = spi;
-    m.q = storage;
-    m.q_capacity = capacity;
-    m.q_head = 0;
-    m.q_tail = 0;
-    m.busy = false;
-    m.clean_dcache_before_tx = false;
+    /* Apply SPI registers quickly */
+    spi_bus_apply_device(mgr, t->dev);
 
-    spi_dbg_log("mgr_create done head=%u tail=%u\n", m.q_head, m.q_tail);
-    return m;
+    /* DC first, then CS - very important */
+    spi_bus_dc_apply(&d->dc, (spi_bus_dc_mode)t->dc_mode);
+    spi_bus_cs_assert(&d->cs);
+
+    /* Clean DCache for TX if enabled */
+    if (mgr->clean_dcache_before_tx)
+        spi_bus_clean_dcache_region(tx, (size_t)len * unit);
+
+    spi_bus_watchdog_arm(mgr, d);
+    if (t->dir == SPI_BUS_DIR_TXRX)
+    {
+        return SPI_BUS_PORT_TXRX_DMA(mgr->spi, (uint8_t *)tx, t->rx, len);
+    }
+
+    return SPI_BUS_PORT_TX_DMA(mgr->spi, (uint8_t *)tx, len);
 }
 
-spi_bus_manager_status spi_bus_manager_submit(spi_bus_manager *mgr, const spi_bus_transaction *t)
+typedef enum
+{
+    SPI_BUS_CHAIN_DONE = 0, /* all segments sent (no DMA pending) */
+    SPI_BUS_CHAIN_DMA,      /* a segment is in flight; resume from the completion ISR */
+    SPI_BUS_CHAIN_FAILED,   /* HAL refused a transfer */
+    SPI_BUS_CHAIN_PARKED    /* program stopped on a DELAY / WAIT op; resume from on_tick */
+} spi_bus_chain_step;
+
+/* Run chain segments from mgr->seg_idx on. CS is already asserted and stays asserted.
+   Short segments (command bytes, register payloads) are written by polling: a few bytes take
+   less time on the wire than a DMA start plus its completion interrupt. The first long segment
+   is handed to DMA and the chain continues from its completion callback. */
+static spi_bus_chain_step spi_bus_chain_run(spi_bus_manager *mgr, const spi_bus_transaction *t)
 {
-    spi_dbg_log("submit mgr=%p t=%p\n", (void *)mgr, (void *)t);
+    const spi_bus_device *d = spi_bus_dev(mgr, t);
+    const size_t unit = spi_is_16bit(d->cr2) ? 2u : 1u;
 
-    if (!mgr || !t || !mgr->spi || !mgr->q || mgr->q_capacity == 0)
+    while (mgr->seg_idx < t->seg_count)
     {
-        spi_dbg_log("submit ERR_PARAM (nulls/cap)\n");
-        return SPI_BUS_MANAGER_ERR_PARAM;
+        const spi_bus_segment *seg = &t->segs[mgr->seg_idx];
+        /* Previous segment has fully left the shifter (HAL waits BSY=0), DC may change now */
+        spi_bus_dc_apply(&d->dc, seg->dc_mode);
+
+        if (seg->len <= SPI_BUS_MANAGER_PIO_MAX_UNITS)
+        {
+            spi_trace(SPI_BUS_TRACE_SEG_PIO, spi_bus_active_queue(mgr), mgr->seg_idx, seg->len);
+            spi_stats_bytes(mgr, t, seg->len);
+            if (SPI_BUS_PORT_TX_POLL(mgr->spi, seg->tx, seg->len, SPI_BUS_MANAGER_PIO_SPINS) != HAL_OK)
+                return SPI_BUS_CHAIN_FAILED;
+            mgr->seg_idx++;
+            continue;
+        }
+
+        if (mgr->clean_dcache_before_tx)
+            spi_bus_clean_dcache_region(seg->tx, (size_t)seg->len * unit);
+
+        mgr->cur_len = seg->len;
+        spi_trace(SPI_BUS_TRACE_SEG_DMA, spi_bus_active_queue(mgr), mgr->seg_idx, seg->len);
+        spi_stats_bytes(mgr, t, seg->len);
+        spi_bus_watchdog_arm(mgr, d);
+        if (SPI_BUS_PORT_TX_DMA(mgr->spi, (uint8_t *)seg->tx, seg->len) != HAL_OK)
+            return SPI_BUS_CHAIN_FAILED;
+        return SPI_BUS_CHAIN_DMA;
     }
 
-    if (t->kind != SPI_BUS_ITEM_CALLBACK)
+    return SPI_BUS_CHAIN_DONE;
+}
+
+/* Interpret program ops from mgr->prog_pc on (normal lane only). CMD/DATA ops behave like chain
+   segments: one register apply and CS assertion per run of them, short ones polled, a long one
+   handed to DMA and continued from its completion callback. DELAY, GPIO and WAIT release CS first.
+   GPIO and a WAIT whose device is already ready run inline; otherwise the op is consumed and the
+   caller parks the lane, so the program continues after it once on_tick sees the step over. */
+static spi_bus_chain_step spi_bus_program_run(spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    const spi_bus_device *d = spi_bus_dev(mgr, t);
+    const size_t unit = spi_is_16bit(d->cr2) ? 2u : 1u;
+
+    while (mgr->prog_pc < t->op_count)
     {
-        if (!t->cs.port)
+        const spi_bus_op *op = &t->prog[mgr->prog_pc];
+
+        if (op->op == SPI_BUS_OP_CMD || op->op == SPI_BUS_OP_DATA)
         {
-            spi_dbg_log("submit ERR_PARAM (no CS)\n");
-            return SPI_BUS_MANAGER_ERR_PARAM;
+            spi_bus_dc_mode dc = (op->op == SPI_BUS_OP_CMD) ? SPI_BUS_DC_COMMAND : SPI_BUS_DC_DATA;
+            if (!mgr->prog_cs)
+            {
+                /* Another device may have used the bus while we were parked */
+                spi_bus_apply_device(mgr, t->dev);
+                spi_bus_dc_apply(&d->dc, dc);
+                spi_bus_cs_assert(&d->cs);
+                mgr->prog_cs = true;
+            }
+            else
+            {
+                spi_bus_dc_apply(&d->dc, dc);
+            }
+
+            spi_stats_bytes(mgr, t, op->arg);
+            if (op->arg <= SPI_BUS_MANAGER_PIO_MAX_UNITS)
+            {
+                spi_trace(SPI_BUS_TRACE_SEG_PIO, &mgr->q, (uint8_t)mgr->prog_pc, op->arg);
+                if (SPI_BUS_PORT_TX_POLL(mgr->spi, op->tx, op->arg, SPI_BUS_MANAGER_PIO_SPINS) != HAL_OK)
+                    return SPI_BUS_CHAIN_FAILED;
+                mgr->prog_pc++;
+                continue;
+            }
+
+            if (mgr->clean_dcache_before_tx)
+                spi_bus_clean_dcache_region(op->tx, (size_t)op->arg * unit);
+
+            mgr->cur_len = op->arg;
+            spi_trace(SPI_BUS_TRACE_SEG_DMA, &mgr->q, (uint8_t)mgr->prog_pc, op->arg);
+            spi_bus_watchdog_arm(mgr, d);
+            if (SPI_BUS_PORT_TX_DMA(mgr->spi, (uint8_t *)op->tx, op->arg) != HAL_OK)
+                return SPI_BUS_CHAIN_FAILED;
+            return SPI_BUS_CHAIN_DMA;
         }
-        if (!t->tx || t->len == 0)
+
+        if (mgr->prog_cs)
         {
-            spi_dbg_log("submit ERR_PARAM (tx/len)\n");
-            return SPI_BUS_MANAGER_ERR_PARAM;
+            spi_bus_cs_deassert(&d->cs);
+            mgr->prog_cs = false;
+        }
+
+        mgr->prog_pc++;
+        if (op->op == SPI_BUS_OP_GPIO)
+        {
+            spi_bus_gpio_set(&d->reset, op->arg != 0u);
+            continue;
         }
-        if (t->dir == SPI_BUS_DIR_TXRX && !t->rx)
+        if (op->op == SPI_BUS_OP_WAIT)
         {
-            spi_dbg_log("submit ERR_PARAM (txrx no rx)\n");
-            return SPI_BUS_MANAGER_ERR_PARAM;
+            if (d->wait_ready(t->user))
+                continue;
+            mgr->park = (uint8_t)SPI_BUS_PARK_READY;
+            return SPI_BUS_CHAIN_PARKED;
         }
+        /* SPI_BUS_OP_DELAY */
+        if (op->arg == 0u)
+            continue;
+        mgr->park = (uint8_t)SPI_BUS_PARK_DELAY;
+        mgr->park_ms = op->arg;
+        return SPI_BUS_CHAIN_PARKED;
     }
 
-    if (SPI_Q_FULL(mgr))
+    if (mgr->prog_cs)
     {
-        spi_dbg_log("submit ERR_FULL head=%u tail=%u cap=%u\n", mgr->q_head, mgr->q_tail, mgr->q_capacity);
-        return SPI_BUS_MANAGER_ERR_FULL;
+        spi_bus_cs_deassert(&d->cs);
+        mgr->prog_cs = false;
     }
+    return SPI_BUS_CHAIN_DONE;
+}
 
-    /* Copy by value into queue tail */
-    mgr->q[mgr->q_tail] = *t;
+/* Program stopped on a DELAY / WAIT op (mgr->park says which): free the bus, park the lane. */
+static void spi_bus_program_park(spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    spi_stats_xfer_done(mgr);
+    spi_bus_park_head(mgr, &mgr->q, t, (spi_bus_park)mgr->park);
+    mgr->hq_active = false;
+    mgr->busy = false;
+}
 
-    /* Force kind=TX for normal submissions (backward compat) */
-    if (mgr->q[mgr->q_tail].kind != SPI_BUS_ITEM_CALLBACK)
+/* Drop the head item of @p rq after a failed start/transfer: release CS, report, pop. */
+static void spi_bus_fail_current(spi_bus_manager *mgr, spi_bus_queue *rq, const spi_bus_transaction *t)
+{
+    spi_trace(SPI_BUS_TRACE_FAIL, rq, t->dev, 0u);
+    spi_stats_inc(mgr, failed);
+    mgr->xfer_timeout_ms = 0;
+    /* Deassert CS to avoid holding the bus */
+    spi_bus_cs_deassert(&spi_bus_dev(mgr, t)->cs);
+    if (rq == &mgr->q)
     {
-        mgr->q[mgr->q_tail].kind = SPI_BUS_ITEM_TX;
+        mgr->chunk_off = 0;
+        mgr->prog_pc = 0;
+        mgr->prog_cs = false;
     }
-
-    spi_dbg_log("submit queued at %u len=%u dir=%d user=%p\n", mgr->q_tail, (unsigned)t->len, (int)t->dir, t->user);
-
-    mgr->q_tail = SPI_Q_INCR(mgr->q_tail, mgr->q_capacity);
-
-    /* Try to start immediately if bus idle (works from thread level and ISR) */
-    spi_bus_try_start(mgr);
-
-    return SPI_BUS_MANAGER_OK;
+    spi_bus_notify_error(mgr, t);
+    /* Drop this transaction to avoid stalling the queue */
+    spi_bus_pop(rq);
+    /* Bus is released only now: a preempting kick must not see the popped head */
+    mgr->hq_active = false;
+    mgr->busy = false;
 }
 
-bool spi_bus_manager_is_idle(const spi_bus_manager *mgr)
+/* Wire part of the head item of @p rq is over and CS is released. Either schedule the next
+   chunk, park on the post-transfer wait or report success and pop. Never starts new work:
+   the caller runs spi_bus_try_start() (keeps the call depth flat for inline-completed chains).
+   busy is cleared last, so a submit preempting us never sees a half-retired head. */
+static void spi_bus_tx_done(spi_bus_manager *mgr, spi_bus_queue *rq, const spi_bus_transaction *t)
 {
-    bool idle = (!mgr->busy) && SPI_Q_EMPTY(mgr);
-    spi_dbg_log("is_idle=%d busy=%d head=%u tail=%u\n", (int)idle, (int)mgr->busy, mgr->q_head, mgr->q_tail);
-    return idle;
-}
+    const spi_bus_device *d = spi_bus_dev(mgr, t);
+    bool retire = true;
+
+    if (!mgr->hq_active)
+    {
+        uint16_t next = (uint16_t)(mgr->chunk_off + mgr->cur_len);
+        if (spi_bus_is_chunked(mgr, t) && next < t->len)
+        {
+            /* Chunk boundary: the bus is free, let high-priority work slip in before the next chunk. */
+            mgr->chunk_off = next;
+            spi_trace(SPI_BUS_TRACE_CHUNK, rq, t->dev, next);
+            retire = false;
+        }
+        else
+        {
+            mgr->chunk_off = 0;
+            mgr->prog_pc = 0;
+            /* Post-transfer wait (e.g., device BUSY): check once, never spin in ISR.
+               If not ready yet, park the normal lane and let spi_bus_manager_on_tick() resume it.
+               The bus itself is free meanwhile, so the high-priority lane keeps running. */
+            if (t->wait && !d->wait_ready(t->user))
+            {
+                spi_bus_park_head(mgr, rq, t, SPI_BUS_PARK_RETIRE);
+                retire = false;
+            }
+        }
+    }
+
+    if (retire)
+    {
+        spi_trace(SPI_BUS_TRACE_DONE, rq, t->dev, 0u);
+        spi_stats_inc(mgr, completed);
+        spi_bus_notify_done(mgr, t);
+        spi_bus_pop(rq);
+    }
+
+    mgr->hq_active = false;
+    mgr->busy = false;
+}
+
+/* Start next transaction if any. Caller holds the engine lock.
+   Scheduling: high-priority lane first, at every transaction or chunk boundary.
+   The normal lane is skipped while its head is parked on a post-transfer wait. */
+static void spi_bus_run(spi_bus_manager *mgr)
+{
+    while (!mgr->busy)
+    {
+        /* Bus lease: grant it at this boundary and start nothing until it is released */
+        if (mgr->leased)
+            return;
+        if (mgr->lease_req)
+        {
+            mgr->lease_req = 0U;
+            mgr->leased = true;
+            SPI_BUS_PORT_APPLY_REGS(mgr->spi, mgr->base_cr1, mgr->base_cr2);
+            spi_trace(SPI_BUS_TRACE_LEASE, &mgr->q, 0u, 0u);
+            return;
+        }
+
+        bool hi = true;
+        spi_bus_queue *rq = &mgr->hq;
+        const spi_bus_transaction *t = spi_bus_peek(rq);
+
+        if (!t)
+        {
+            if (mgr->waiting)
+                return;
+            hi = false;
+            rq = &mgr->q;
+            t = spi_bus_peek(rq);
+            if (!t)
+                return;
+        }
+
+        /* Cancelled while queued */
+        if (t->kind == SPI_BUS_ITEM_SKIP)
+        {
+            spi_bus_pop(rq);
+            continue;
+        }
+
+        /* callback-only item – no DMA, no CS/DC */
+        if (t->kind == SPI_BUS_ITEM_CALLBACK)
+        {
+            spi_trace(SPI_BUS_TRACE_CALLBACK, rq, 0u, 0u);
+            if (t->fn)
+                t->fn(mgr, t->user);
+            /* Pop and immediately try the next one (may chain callbacks) */
+            spi_bus_pop(rq);
+            continue;
+        }
+
+        /* Delay item – no bus activity, the lane parks until the delay is over */
+        if (t->kind == SPI_BUS_ITEM_DELAY)
+        {
+            mgr->park_ms = t->delay_ms;
+            spi_bus_park_head(mgr, rq, t, SPI_BUS_PARK_DELAY);
+            continue;
+        }
+
+        mgr->busy = true;
+        mgr->hq_active = hi;
+
+        /* CS-grouped chain: one register apply and one CS assertion for all segments */
+        if (t->kind == SPI_BUS_ITEM_CHAIN)
+        {
+            const spi_bus_device *d = spi_bus_dev(mgr, t);
+            spi_trace(SPI_BUS_TRACE_CHAIN, rq, t->dev, t->seg_count);
+            spi_stats_start(mgr, rq, true);
+            mgr->seg_idx = 0;
+            mgr->cur_len = 0;
+            spi_bus_apply_device(mgr, t->dev);
+            spi_bus_dc_apply(&d->dc, (spi_bus_dc_mode)t->dc_mode);
+            spi_bus_cs_assert(&d->cs);
+
+            spi_bus_chain_step step = spi_bus_chain_run(mgr, t);
+            if (step == SPI_BUS_CHAIN_DMA)
+                return;
+            if (step == SPI_BUS_CHAIN_FAILED)
+            {
+                spi_bus_fail_current(mgr, rq, t);
+                continue;
+            }
+            /* Sent entirely by polling - complete inline, no interrupt taken */
+            spi_bus_cs_deassert(&d->cs);
+            spi_stats_xfer_done(mgr);
+            spi_bus_tx_done(mgr, rq, t);
+            continue;
+        }
+
+        /* Program: start or resume at prog_pc (validation keeps programs on the normal lane) */
+        if (t->kind == SPI_BUS_ITEM_PROGRAM)
+        {
+            spi_trace(SPI_BUS_TRACE_PROGRAM, rq, t->dev, mgr->prog_pc);
+            spi_stats_start(mgr, rq, mgr->prog_pc == 0u);
+            mgr->cur_len = 0;
+
+            spi_bus_chain_step step = spi_bus_program_run(mgr, t);
+            if (step == SPI_BUS_CHAIN_DMA)
+                return;
+            if (step == SPI_BUS_CHAIN_FAILED)
+            {
+                spi_bus_fail_current(mgr, rq, t);
+                continue;
+            }
+            if (step == SPI_BUS_CHAIN_PARKED)
+            {
+                spi_bus_program_park(mgr, t);
+                continue;
+            }
+            spi_stats_xfer_done(mgr);
+            spi_bus_tx_done(mgr, rq, t);
+            continue;
+        }
+
+        uint16_t off = hi ? 0u : mgr->chunk_off;
+        uint16_t len = (uint16_t)(t->len - off);
+        if (!hi && spi_bus_is_chunked(mgr, t) && len > mgr->chunk_max)
+            len = mgr->chunk_max;
+        mgr->cur_len = len;
+        spi_trace(SPI_BUS_TRACE_START, rq, t->dev, len);
+        spi_stats_start(mgr, rq, off == 0u);
+
+        if (spi_bus_start_dma(mgr, t, off, len) == HAL_OK)
+            return;
+
+        spi_bus_fail_current(mgr, rq, t);
+    }
+}
+
+/* An on_tick that found the engine lock held could not end the park, and neither a delay timer nor
+   a BUSY edge comes again: the context that released the lock runs it now */
+static void spi_bus_replay_tick(spi_bus_manager *mgr)
+{
+    if (!mgr->waiting)
+        return;
+    if (mgr->ready_pending || (mgr->timer_fired && mgr->park == SPI_BUS_PARK_DELAY))
+        spi_bus_manager_on_tick(mgr);
+}
+
+/* Kick the engine (called at thread-level and ISR-level). Whoever holds the engine lock
+   serves every kick raised meanwhile, so a preempting submit/completion never waits. */
+static void spi_bus_try_start(spi_bus_manager *mgr)
+{
+    mgr->kick = 1U;
+    while (mgr->kick)
+    {
+        if (!spi_bus_try_lock(&mgr->engine_lock))
+            return; /* owner will see the kick */
+        while (mgr->kick)
+        {
+            mgr->kick = 0U;
+            spi_bus_run(mgr);
+        }
+        spi_bus_unlock(&mgr->engine_lock);
+        /* A kick that raced the unlock is picked up by the outer loop */
+    }
+
+    spi_bus_replay_tick(mgr);
+}
+
+/* Common tail for complete (TX or TXRX) */
+static void spi_bus_on_complete_common(spi_bus_manager *mgr, bool half)
+{
+    spi_bus_queue *rq = spi_bus_active_queue(mgr);
+    const spi_bus_transaction *t = mgr->busy ? spi_bus_peek(rq) : NULL;
+    if (!t)
+    {
+        mgr->busy = false;
+        mgr->hq_active = false;
+        return;
+    }
+
+    if (half)
+    {
+        spi_trace(SPI_BUS_TRACE_HALF, rq, t->dev, 0u);
+        spi_bus_notify_half(mgr, t);
+        return; /* still in progress; don't touch CS or queue */
+    }
+
+    spi_trace(SPI_BUS_TRACE_CPLT, rq, t->dev, mgr->cur_len);
+    mgr->xfer_timeout_ms = 0;
+
+    /* Chain: continue with the next segment under the same CS */
+    if (t->kind == SPI_BUS_ITEM_CHAIN)
+    {
+        mgr->seg_idx++;
+        spi_bus_chain_step step = spi_bus_chain_run(mgr, t);
+        if (step == SPI_BUS_CHAIN_DMA)
+            return;
+        if (step == SPI_BUS_CHAIN_FAILED)
+        {
+            spi_bus_fail_current(mgr, rq, t);
+            spi_bus_try_start(mgr);
+            return;
+        }
+    }
+    /* Program: continue after the op that just finished (CS is released when it ends or parks) */
+    else if (t->kind == SPI_BUS_ITEM_PROGRAM)
+    {
+        mgr->prog_pc++;
+        spi_bus_chain_step step = spi_bus_program_run(mgr, t);
+        if (step == SPI_BUS_CHAIN_DMA)
+            return;
+        if (step == SPI_BUS_CHAIN_FAILED)
+        {
+            spi_bus_fail_current(mgr, rq, t);
+            spi_bus_try_start(mgr);
+            return;
+        }
+        if (step == SPI_BUS_CHAIN_PARKED)
+        {
+            spi_bus_program_park(mgr, t);
+            spi_bus_try_start(mgr);
+            return;
+        }
+    }
+    else
+    {
+        spi_stats_bytes(mgr, t, mgr->cur_len);
+    }
+
+    /* No BSY spin here: with DMA in normal mode HAL has already drained the TX FIFO and
+       waited for BSY=0 (SPI_EndRxTxTransaction) before calling the Cplt callback,
+       so the last bit is on the wire and CS can be released right away. */
+    spi_bus_cs_deassert(&spi_bus_dev(mgr, t)->cs);
+    spi_stats_xfer_done(mgr);
+
+    spi_bus_tx_done(mgr, rq, t);
+    spi_bus_try_start(mgr);
+}
+
+/* -------------------------------- Registry --------------------------------- */
+
+/* One slot per SPI instance; index derived from the peripheral address. */
+static spi_bus_manager *volatile spi_bus_registry[SPI_BUS_MANAGER_MAX_INSTANCES];
+
+static int spi_bus_registry_index(const SPI_HandleTypeDef *hspi)
+{
+    if (!hspi)
+        return -1;
+
+    const SPI_TypeDef *inst = hspi->Instance;
+    int idx = -1;
+#if defined(SPI1)
+    if (inst == SPI1)
+        idx = 0;
+#endif
+#if defined(SPI2)
+    if (inst == SPI2)
+        idx = 1;
+#endif
+#if defined(SPI3)
+    if (inst == SPI3)
+        idx = 2;
+#endif
+#if defined(SPI4)
+    if (inst == SPI4)
+        idx = 3;
+#endif
+    return (idx < SPI_BUS_MANAGER_MAX_INSTANCES) ? idx : -1;
+}
+
+/* ------------------------------ Public API -------------------------------- */
+
+spi_bus_manager spi_bus_manager_create(SPI_HandleTypeDef *spi,
+                                       spi_bus_transaction *storage,
+                                       uint16_t capacity)
+{
+    spi_cyccnt_init();
+
+    spi_bus_manager m;
+    memset(&m, 0, sizeof(m));
+    m.spi = spi;
+    m.q.items = storage;
+    m.q.capacity = capacity;
+    m.q.head = 0;
+    m.q.tail = 0;
+    for (uint16_t i = 0; storage && i < capacity; ++i)
+        storage[i].published = 0U;
+    m.busy = false;
+    m.waiting = false;
+    m.wait_start_ms = 0;
+    m.hq_active = false;
+    m.chunk_max = 0;
+    m.chunk_off = 0;
+    m.cur_len = 0;
+    m.seg_idx = 0;
+    m.prog_pc = 0;
+    m.park = SPI_BUS_PARK_RETIRE;
+    m.prog_cs = false;
+    m.timer_start = NULL;
+    m.timer_ctx = NULL;
+    m.timer_fired = 0;
+    m.engine_lock = 0;
+    m.kick = 0;
+    m.ready_pending = 0;
+    m.clean_dcache_before_tx = false;
+    if (spi)
+        SPI_BUS_PORT_READ_REGS(spi, m.base_cr1, m.base_cr2);
+#if SPI_BUS_MANAGER_STATS
+    m.stats_reset_ms = SPI_BUS_PORT_TICK_MS();
+#endif
+
+    return m;
+}
+
+void spi_bus_manager_set_timer(spi_bus_manager *mgr, spi_bus_timer_start_fn start, void *ctx)
+{
+    if (!mgr)
+        return;
+    mgr->timer_ctx = ctx;
+    mgr->timer_start = start;
+}
+
+void spi_bus_manager_set_priority_queue(spi_bus_manager *mgr,
+                                        spi_bus_transaction *storage,
+                                        uint16_t capacity)
+{
+    if (!mgr)
+        return;
+    mgr->hq.items = storage;
+    mgr->hq.capacity = storage ? capacity : 0;
+    mgr->hq.head = 0;
+    mgr->hq.tail = 0;
+    mgr->hq.lane = 1U;
+    for (uint16_t i = 0; i < mgr->hq.capacity; ++i)
+        storage[i].published = 0U;
+}
+
+/* CR1 of a device: its snapshot, with BR set to the fastest prescaler (/2../256) that keeps SCLK
+   within max_sclk_hz. SCLK = kernel / 2^(BR + 1), rounded up so the limit also holds for kernel
+   clocks that are not a power-of-two multiple; /256 if even that is too fast. */
+static uint32_t spi_bus_device_cr1(const spi_bus_manager *mgr, const spi_bus_device *d)
+{
+    if (d->max_sclk_hz == 0u)
+        return d->cr1;
+
+    uint32_t kernel_hz = SPI_BUS_PORT_KERNEL_HZ(mgr->spi);
+    uint32_t br = 0u;
+    while (br < 7u && ((kernel_hz + (2u << br) - 1u) >> (br + 1u)) > d->max_sclk_hz)
+        br++;
+    return (d->cr1 & ~SPI_CR1_BR_Msk) | (br << SPI_CR1_BR_Pos);
+}
+
+spi_bus_manager_status spi_bus_manager_add_device(spi_bus_manager *mgr,
+                                                  const spi_bus_device *dev,
+                                                  uint8_t *id)
+{
+    if (!mgr || !mgr->spi || !dev || !id || !dev->cs.port)
+        return SPI_BUS_MANAGER_ERR_PARAM;
+
+    /* Re-registering the same profile returns its existing id */
+    for (uint8_t i = 0; i < mgr->device_count; ++i)
+    {
+        if (mgr->devices[i] == dev)
+        {
+            *id = i;
+            return SPI_BUS_MANAGER_OK;
+        }
+    }
+
+    if (mgr->device_count >= SPI_BUS_MANAGER_MAX_DEVICES)
+        return SPI_BUS_MANAGER_ERR_FULL;
+
+    mgr->devices[mgr->device_count] = dev;
+    mgr->dev_cr1[mgr->device_count] = spi_bus_device_cr1(mgr, dev);
+    *id = mgr->device_count;
+    mgr->device_count++;
+    return SPI_BUS_MANAGER_OK;
+}
+
+void spi_bus_manager_update_clocks(spi_bus_manager *mgr)
+{
+    if (!mgr || !mgr->spi)
+        return;
+
+    for (uint8_t i = 0; i < mgr->device_count; ++i)
+        mgr->dev_cr1[i] = spi_bus_device_cr1(mgr, mgr->devices[i]);
+}
+
+uint32_t spi_bus_manager_device_sclk_hz(const spi_bus_manager *mgr, uint8_t id)
+{
+    if (!mgr || !mgr->spi || id >= mgr->device_count)
+        return 0u;
+
+    uint32_t br = (mgr->dev_cr1[id] & SPI_CR1_BR_Msk) >> SPI_CR1_BR_Pos;
+    return SPI_BUS_PORT_KERNEL_HZ(mgr->spi) >> (br + 1u);
+}
+
+/* Validate a descriptor and pick its lane. */
+static spi_bus_manager_status spi_bus_validate(spi_bus_manager *mgr, const spi_bus_transaction *t, spi_bus_queue **lane)
+{
+    if (!mgr || !t || !mgr->spi || !SPI_Q_VALID(&mgr->q))
+    {
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_NULL);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+
+    *lane = &mgr->q;
+
+    if (t->kind == SPI_BUS_ITEM_REF || t->kind > SPI_BUS_ITEM_DELAY)
+    {
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_REF);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+
+    if (t->kind == SPI_BUS_ITEM_CALLBACK)
+    {
+        if (t->fn)
+            return SPI_BUS_MANAGER_OK;
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_CALLBACK);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+
+    /* Delays park, so like waits they stay on the normal lane */
+    if (t->kind == SPI_BUS_ITEM_DELAY)
+    {
+        if (t->delay_ms != 0u && !(t->priority == SPI_BUS_PRIO_HIGH && SPI_Q_VALID(&mgr->hq)))
+            return SPI_BUS_MANAGER_OK;
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_DELAY);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+
+    if (t->dev >= mgr->device_count)
+    {
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_DEVICE);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+    const spi_bus_device *d = spi_bus_dev(mgr, t);
+
+    if (t->kind == SPI_BUS_ITEM_CHAIN)
+    {
+        if (!t->segs || t->seg_count == 0 || t->dir != SPI_BUS_DIR_TX)
+        {
+            spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_CHAIN);
+            return SPI_BUS_MANAGER_ERR_PARAM;
+        }
+        for (uint16_t i = 0; i < t->seg_count; ++i)
+        {
+            if (!t->segs[i].tx || t->segs[i].len == 0)
+            {
+                spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_CHAIN);
+                return SPI_BUS_MANAGER_ERR_PARAM;
+            }
+        }
+    }
+    else if (t->kind == SPI_BUS_ITEM_PROGRAM)
+    {
+        if (!t->prog || t->op_count == 0 || t->dir != SPI_BUS_DIR_TX)
+        {
+            spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_PROGRAM);
+            return SPI_BUS_MANAGER_ERR_PARAM;
+        }
+        for (uint16_t i = 0; i < t->op_count; ++i)
+        {
+            const spi_bus_op *op = &t->prog[i];
+            bool ok;
+            switch (op->op)
+            {
+            case SPI_BUS_OP_CMD:
+            case SPI_BUS_OP_DATA:
+                ok = op->tx && op->arg != 0u;
+                break;
+            case SPI_BUS_OP_DELAY:
+                ok = true;
+                break;
+            case SPI_BUS_OP_GPIO:
+                ok = d->reset.port != NULL;
+                break;
+            case SPI_BUS_OP_WAIT:
+                ok = d->wait_ready != NULL;
+                break;
+            default:
+                ok = false;
+                break;
+            }
+            if (!ok)
+            {
+                spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_PROGRAM);
+                return SPI_BUS_MANAGER_ERR_PARAM;
+            }
+        }
+    }
+    else if (!t->tx || t->len == 0)
+    {
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_BUFFER);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+    if (t->dir == SPI_BUS_DIR_TXRX && !t->rx)
+    {
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_RX);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+    if (t->wait && !d->wait_ready)
+    {
+        spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_WAIT);
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    }
+
+    /* High-priority items go to their own lane when one is configured. */
+    if (t->priority == SPI_BUS_PRIO_HIGH && SPI_Q_VALID(&mgr->hq))
+    {
+        if (t->wait || t->kind == SPI_BUS_ITEM_PROGRAM)
+        {
+            spi_trace_reject(mgr, SPI_BUS_TRACE_REJ_WAIT_HIGH);
+            return SPI_BUS_MANAGER_ERR_PARAM;
+        }
+        *lane = &mgr->hq;
+    }
+    return SPI_BUS_MANAGER_OK;
+}
+
+spi_bus_manager_status spi_bus_manager_submit(spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    spi_bus_queue *rq;
+    spi_bus_manager_status st = spi_bus_validate(mgr, t, &rq);
+    if (st != SPI_BUS_MANAGER_OK)
+    {
+        spi_stats_reject(mgr);
+        return st;
+    }
+
+    st = spi_bus_push(rq, t);
+    if (st != SPI_BUS_MANAGER_OK)
+    {
+        spi_stats_reject(mgr);
+        return st;
+    }
+    spi_stats_pushed(mgr, rq);
+
+    /* Try to start immediately if bus idle (works from thread level and ISR) */
+    spi_bus_try_start(mgr);
+
+    return SPI_BUS_MANAGER_OK;
+}
+
+spi_bus_manager_status spi_bus_manager_submit_ref(spi_bus_manager *mgr, const spi_bus_transaction *t)
+{
+    spi_bus_queue *rq;
+    spi_bus_manager_status st = spi_bus_validate(mgr, t, &rq);
+    if (st != SPI_BUS_MANAGER_OK)
+    {
+        spi_stats_reject(mgr);
+        return st;
+    }
+
+    /* The slot only carries the pointer; the engine reads everything else from *t */
+    spi_bus_transaction slot = {0};
+    slot.kind = SPI_BUS_ITEM_REF;
+    slot.ref = t;
+    st = spi_bus_push(rq, &slot);
+    if (st != SPI_BUS_MANAGER_OK)
+    {
+        spi_stats_reject(mgr);
+        return st;
+    }
+    spi_stats_pushed(mgr, rq);
+
+    spi_bus_try_start(mgr);
+
+    return SPI_BUS_MANAGER_OK;
+}
+
+bool spi_bus_manager_is_idle(const spi_bus_manager *mgr)
+{
+    bool idle = (!mgr->busy) && (!mgr->waiting) && (!mgr->leased) && SPI_Q_EMPTY(&mgr->q) && SPI_Q_EMPTY(&mgr->hq);
+    return idle;
+}
+
+#if SPI_BUS_MANAGER_STATS
+void spi_bus_manager_get_stats(const spi_bus_manager *mgr, spi_bus_stats *out)
+{
+    if (!mgr || !out)
+        return;
+
+    /* Consistent copy: completions update several fields at once */
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+    *out = mgr->stats;
+    out->elapsed_ms = SPI_BUS_PORT_TICK_MS() - mgr->stats_reset_ms;
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+}
+
+void spi_bus_manager_reset_stats(spi_bus_manager *mgr)
+{
+    if (!mgr)
+        return;
+
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+    memset(&mgr->stats, 0, sizeof(mgr->stats));
+    mgr->stats_reset_ms = SPI_BUS_PORT_TICK_MS();
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+}
+#endif
+
+spi_bus_manager_status spi_bus_manager_acquire(spi_bus_manager *mgr, uint32_t timeout_ms)
+{
+    if (!mgr)
+        return SPI_BUS_MANAGER_ERR_PARAM;
+    if (mgr->leased || mgr->lease_req)
+        return SPI_BUS_MANAGER_ERR_BUSY;
+
+    uint32_t start = SPI_BUS_PORT_TICK_MS();
+    mgr->lease_req = 1U;
+    /* Granted right here if nothing is in flight; otherwise by the completion that ends it */
+    spi_bus_try_start(mgr);
+
+    while (!mgr->leased)
+    {
+        /* Keep waits and the DMA watchdog running: a stuck transfer must not hold us forever */
+        spi_bus_manager_on_tick(mgr);
+
+        if (timeout_ms != HAL_MAX_DELAY && (SPI_BUS_PORT_TICK_MS() - start) >= timeout_ms)
+        {
+            /* Withdraw, unless the grant raced the timeout */
+            uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+            bool granted = mgr->leased;
+            mgr->lease_req = 0U;
+            SPI_BUS_PORT_IRQ_RESTORE(irq);
+            if (!granted)
+                return SPI_BUS_MANAGER_ERR_BUSY;
+        }
+    }
+    return SPI_BUS_MANAGER_OK;
+}
+
+void spi_bus_manager_release(spi_bus_manager *mgr)
+{
+    if (!mgr || !mgr->leased)
+        return;
+
+    spi_trace(SPI_BUS_TRACE_RELEASE, &mgr->q, 0u, 0u);
+    mgr->leased = false;
+    spi_bus_try_start(mgr);
+}
+
+/* Drop every item of @p rq behind head (and head itself unless @p keep_head). Interrupts off. */
+static void spi_bus_truncate(spi_bus_queue *rq, bool keep_head)
+{
+    if (!SPI_Q_VALID(rq))
+        return;
+    uint16_t new_tail = rq->head;
+    if (keep_head && !SPI_Q_EMPTY(rq))
+        new_tail = SPI_Q_INCR(rq->head, rq->capacity);
+    /* Dropped slots must read as unpublished when the ring wraps onto them again */
+    for (uint16_t i = new_tail; i != rq->tail; i = SPI_Q_INCR(i, rq->capacity))
+        rq->items[i].published = 0U;
+    rq->tail = new_tail;
+}
 
 void spi_bus_manager_cancel_pending(spi_bus_manager *mgr)
 {
-    spi_dbg_log("cancel_pending head=%u tail=%u\n", mgr->q_head, mgr->q_tail);
-    /* Do not touch current in-flight; just drop everything behind it */
-    mgr->q_tail = mgr->q_head;
+    spi_trace(SPI_BUS_TRACE_CANCEL, &mgr->q, 0u, 0u);
+
+    /* Thread-level only, so no producer is half-way through a slot while IRQs are off */
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+
+    /* Do not touch current in-flight / parked / partially sent item; just drop everything behind it */
+    spi_bus_truncate(&mgr->q, spi_bus_normal_head_active(mgr));
+    spi_bus_truncate(&mgr->hq, mgr->busy && mgr->hq_active);
+
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+}
+
+/* Selection of spi_bus_manager_cancel(); device-less items match only a wildcard device */
+static inline bool spi_bus_cancel_match(const spi_bus_transaction *t, uint8_t dev, uint8_t tag)
+{
+    if (tag != SPI_BUS_MATCH_ANY && t->tag != tag)
+        return false;
+    if (dev == SPI_BUS_MATCH_ANY)
+        return true;
+    return t->kind != SPI_BUS_ITEM_CALLBACK && t->kind != SPI_BUS_ITEM_DELAY && t->dev == dev;
+}
+
+/* Drop the started head item of @p rq for spi_bus_manager_cancel(): unpark the lane and pop.
+   Engine lock held, interrupts off. A transfer on the wire is only claimed here (its interrupts
+   masked, busy cleared); returns its CS, to be released once the caller has stopped it with
+   SPI_BUS_PORT_ABORT with interrupts back on; NULL otherwise (CS already released). */
+static const spi_bus_gpio *spi_bus_abort_head(spi_bus_manager *mgr, spi_bus_queue *rq, const spi_bus_transaction *t)
+{
+    bool hi = (rq == &mgr->hq);
+    bool on_wire = mgr->busy && mgr->hq_active == hi;
+    const spi_bus_gpio *cs = (t->kind != SPI_BUS_ITEM_DELAY) ? &spi_bus_dev(mgr, t)->cs : NULL;
+
+    spi_trace(SPI_BUS_TRACE_ABORT, rq, t->dev, on_wire ? 1u : 0u);
+    if (on_wire)
+    {
+        /* No completion is raised for a claimed transfer */
+        SPI_BUS_PORT_QUIESCE(mgr->spi);
+        mgr->xfer_timeout_ms = 0;
+        spi_stats_xfer_done(mgr);
+    }
+    else if (cs)
+    {
+        spi_bus_cs_deassert(cs);
+        cs = NULL;
+    }
+    if (!hi)
+    {
+        mgr->chunk_off = 0;
+        mgr->prog_pc = 0;
+        mgr->prog_cs = false;
+        mgr->waiting = false;
+    }
+    spi_bus_pop(rq);
+    if (on_wire)
+    {
+        mgr->hq_active = false;
+        mgr->busy = false;
+    }
+    return cs;
+}
+
+/* Turn every queued match of @p rq into a SKIP slot; the started head (if any) is left alone */
+static uint16_t spi_bus_cancel_lane(spi_bus_queue *rq, bool head_started, uint8_t dev, uint8_t tag)
+{
+    uint16_t n = 0;
+    if (!SPI_Q_VALID(rq))
+        return 0;
+
+    uint16_t i = rq->head;
+    if (head_started && !SPI_Q_EMPTY(rq))
+        i = SPI_Q_INCR(i, rq->capacity);
+    for (; i != rq->tail; i = SPI_Q_INCR(i, rq->capacity))
+    {
+        spi_bus_transaction *slot = &rq->items[i];
+        if (!slot->published || slot->kind == SPI_BUS_ITEM_SKIP)
+            continue;
+        const spi_bus_transaction *t = (slot->kind == SPI_BUS_ITEM_REF) ? slot->ref : slot;
+        if (spi_bus_cancel_match(t, dev, tag))
+        {
+            slot->kind = SPI_BUS_ITEM_SKIP;
+            n++;
+        }
+    }
+    return n;
+}
+
+/* Count the published, not cancelled matches of @p rq from head on. Interrupts off. */
+static uint16_t spi_bus_count_lane(const spi_bus_queue *rq, uint8_t dev, uint8_t tag)
+{
+    uint16_t n = 0;
+    if (!SPI_Q_VALID(rq))
+        return 0;
+
+    for (uint16_t i = rq->head; i != rq->tail; i = SPI_Q_INCR(i, rq->capacity))
+    {
+        const spi_bus_transaction *slot = &rq->items[i];
+        if (!slot->published || slot->kind == SPI_BUS_ITEM_SKIP)
+            continue;
+        const spi_bus_transaction *t = (slot->kind == SPI_BUS_ITEM_REF) ? slot->ref : slot;
+        if (spi_bus_cancel_match(t, dev, tag))
+            n++;
+    }
+    return n;
+}
+
+uint16_t spi_bus_manager_pending(spi_bus_manager *mgr, uint8_t dev, uint8_t tag)
+{
+    if (!mgr)
+        return 0;
+
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+    uint16_t n = spi_bus_count_lane(&mgr->q, dev, tag);
+    n += spi_bus_count_lane(&mgr->hq, dev, tag);
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+    return n;
+}
+
+uint16_t spi_bus_manager_cancel(spi_bus_manager *mgr, uint8_t dev, uint8_t tag, bool abort)
+{
+    if (!mgr)
+        return 0;
+
+    /* Only the started heads need the engine; without the lock (called from a callback) they stay */
+    bool locked = spi_bus_try_lock(&mgr->engine_lock);
+    uint16_t n = 0;
+    const spi_bus_gpio *wire_cs = NULL; /* CS of a head aborted on the wire (at most one) */
+
+    /* Thread-level only, so no producer is half-way through a slot while IRQs are off */
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+
+    bool q_started = spi_bus_normal_head_active(mgr);
+    bool hq_started = mgr->busy && mgr->hq_active;
+    n += spi_bus_cancel_lane(&mgr->q, q_started, dev, tag);
+    n += spi_bus_cancel_lane(&mgr->hq, hq_started, dev, tag);
+
+    if (abort && locked)
+    {
+        const spi_bus_transaction *t = hq_started ? spi_bus_peek(&mgr->hq) : NULL;
+        if (t && spi_bus_cancel_match(t, dev, tag))
+        {
+            wire_cs = spi_bus_abort_head(mgr, &mgr->hq, t);
+            n++;
+        }
+        t = q_started ? spi_bus_peek(&mgr->q) : NULL;
+        if (t && spi_bus_cancel_match(t, dev, tag))
+        {
+            const spi_bus_gpio *cs = spi_bus_abort_head(mgr, &mgr->q, t);
+            if (cs)
+                wire_cs = cs;
+            n++;
+        }
+    }
+
+    spi_trace(SPI_BUS_TRACE_CANCEL, &mgr->q, tag, n);
+    spi_stats_add(mgr, cancelled, n);
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+
+    /* HAL's abort waits on FIFO and BSY flags: interrupts on, the engine lock keeps the bus ours */
+    if (wire_cs)
+    {
+        SPI_BUS_PORT_ABORT(mgr->spi);
+        spi_bus_cs_deassert(wire_cs);
+    }
+
+    if (locked)
+    {
+        spi_bus_unlock(&mgr->engine_lock);
+        /* The bus may be free now, and skipped slots at the heads must be drained */
+        spi_bus_try_start(mgr);
+    }
+    return n;
 }
 
 /* -------------------------- HAL integration hooks ------------------------- */
 
 void spi_bus_manager_on_tx_half(spi_bus_manager *mgr, SPI_HandleTypeDef *hspi)
 {
-    spi_dbg_log("cb_tx_half mgr=%p hspi=%p\n", (void *)mgr, (void *)hspi);
     if (!mgr || hspi != mgr->spi)
         return;
-    spi_bus_on_complete_common(mgr, true, false);
+    spi_bus_on_complete_common(mgr, true);
 }
 
 void spi_bus_manager_on_txrx_half(spi_bus_manager *mgr, SPI_HandleTypeDef *hspi)
 {
-    spi_dbg_log("cb_txrx_half mgr=%p hspi=%p\n", (void *)mgr, (void *)hspi);
     if (!mgr || hspi != mgr->spi)
         return;
-    spi_bus_on_complete_common(mgr, true, true);
+    spi_bus_on_complete_common(mgr, true);
 }
 
 void spi_bus_manager_on_tx_cplt(spi_bus_manager *mgr, SPI_HandleTypeDef *hspi)
 {
-    spi_dbg_log("cb_tx_cplt mgr=%p hspi=%p\n", (void *)mgr, (void *)hspi);
     if (!mgr || hspi != mgr->spi)
         return;
-    spi_bus_on_complete_common(mgr, false, false);
+    uint32_t prof = spi_prof_begin();
+    spi_bus_on_complete_common(mgr, false);
+    spi_prof_end(prof);
 }
 
 void spi_bus_manager_on_txrx_cplt(spi_bus_manager *mgr, SPI_HandleTypeDef *hspi)
 {
-    spi_dbg_log("cb_txrx_cplt mgr=%p hspi=%p\n", (void *)mgr, (void *)hspi);
     if (!mgr || hspi != mgr->spi)
         return;
-    spi_bus_on_complete_common(mgr, false, true);
+    uint32_t prof = spi_prof_begin();
+    spi_bus_on_complete_common(mgr, false);
+    spi_prof_end(prof);
 }
 
 void spi_bus_manager_on_error(spi_bus_manager *mgr, SPI_HandleTypeDef *hspi)
 {
-    spi_dbg_log("cb_error mgr=%p hspi=%p\n", (void *)mgr, (void *)hspi);
     if (!mgr || hspi != mgr->spi)
         return;
 
-    spi_bus_transaction *t = spi_bus_peek_current(mgr);
+    spi_bus_queue *rq = spi_bus_active_queue(mgr);
+    spi_trace(SPI_BUS_TRACE_HAL_ERROR, rq, 0u, mgr->cur_len);
+    const spi_bus_transaction *t = mgr->busy ? spi_bus_peek(rq) : NULL;
     if (t)
     {
-        spi_dbg_log("cb_error: deassert CS; user=%p\n", t->user);
-        spi_bus_cs_deassert(&t->cs);
-        if (t->on_error)
-            t->on_error(mgr, t->user);
-        spi_bus_pop(mgr);
+        spi_bus_fail_current(mgr, rq, t);
+    }
+    else
+    {
+        mgr->busy = false;
+        mgr->hq_active = false;
     }
-    mgr->busy = false;
+    spi_bus_try_start(mgr);
+}
+
+/* DMA watchdog: recover from a transfer whose completion never came (lost DMA/SPI interrupt,
+   peripheral stuck). Claim the transfer, reset the SPI, release CS, fail the item and restart the queue. */
+static void spi_bus_watchdog(spi_bus_manager *mgr)
+{
+    uint32_t timeout = mgr->xfer_timeout_ms;
+    if (!mgr->busy || timeout == 0U || (SPI_BUS_PORT_TICK_MS() - mgr->xfer_start_ms) <= timeout)
+        return;
+
+    /* The engine owner (if any) is running right now, so the transfer is not lost: retry next tick */
+    if (!spi_bus_try_lock(&mgr->engine_lock))
+        return;
+
+    /* Re-check with interrupts off: the completion may have arrived since the first look. The claim
+       only masks the transfer's interrupts and clears busy, so a late completion finds nothing to
+       finish; the reset itself (HAL waits on FIFO and BSY flags, MSP re-init) runs with interrupts on,
+       still under the engine lock, so nothing starts on the bus meanwhile. */
+    spi_bus_queue *rq = NULL;
+    const spi_bus_transaction *t = NULL;
+    uint32_t irq = SPI_BUS_PORT_IRQ_SAVE();
+    bool expired = mgr->busy && mgr->xfer_timeout_ms != 0U &&
+                   (SPI_BUS_PORT_TICK_MS() - mgr->xfer_start_ms) > mgr->xfer_timeout_ms;
+    if (expired)
+    {
+        SPI_BUS_PORT_QUIESCE(mgr->spi);
+        mgr->xfer_timeout_ms = 0;
+        rq = spi_bus_active_queue(mgr);
+        t = spi_bus_peek(rq);
+        mgr->busy = false;
+    }
+    SPI_BUS_PORT_IRQ_RESTORE(irq);
+
+    if (expired)
+    {
+        SPI_BUS_PORT_RECOVER(mgr->spi);
+        spi_trace(SPI_BUS_TRACE_WATCHDOG, rq, t ? t->dev : 0u, mgr->cur_len);
+        mgr->recoveries++;
+        spi_stats_inc(mgr, recoveries);
+        if (t)
+            spi_bus_fail_current(mgr, rq, t);
+        mgr->hq_active = false;
+    }
+
+    spi_bus_unlock(&mgr->engine_lock);
+    if (expired)
+        spi_bus_try_start(mgr);
+}
+
+void spi_bus_manager_on_tick(spi_bus_manager *mgr)
+{
+    if (!mgr)
+        return;
+
+    spi_bus_watchdog(mgr);
+
+    if (!mgr->waiting)
+        return;
+
+    /* Claim the parked transaction through the engine lock: tick and BUSY EXTI may race.
+       If the lock is taken, latch the call for the owner to replay once it unlocks. */
+    if (!spi_bus_try_lock(&mgr->engine_lock))
+    {
+        mgr->ready_pending = 1U;
+        return;
+    }
+    mgr->ready_pending = 0U;
+
+    const spi_bus_transaction *t = mgr->waiting ? spi_bus_peek(&mgr->q) : NULL;
+    const spi_bus_device *d = t ? spi_bus_dev(mgr, t) : NULL;
+    const uint32_t waited = SPI_BUS_PORT_TICK_MS() - mgr->wait_start_ms;
+    bool ready = true;
+    bool timed_out = false;
+    if (t && mgr->park == SPI_BUS_PARK_DELAY)
+    {
+        /* Tick fallback uses '>': the HAL tick may advance right after the delay started */
+        ready = mgr->timer_fired || waited > mgr->park_ms;
+    }
+    else if (t && (mgr->park == SPI_BUS_PARK_READY || t->wait))
+    {
+        ready = d->wait_ready(t->user);
+        timed_out = !ready && d->wait_timeout_ms > 0U && waited >= d->wait_timeout_ms;
+    }
+
+    if (!mgr->waiting || (!ready && !timed_out))
+    {
+        spi_bus_unlock(&mgr->engine_lock);
+        /* An edge latched meanwhile may have come after the predicate was read */
+        spi_bus_replay_tick(mgr);
+        return;
+    }
+
+    /* Delay or program step over: a delay item retires silently (no device), a program
+       is unparked and the engine continues it at prog_pc */
+    if (t && ready && mgr->park != SPI_BUS_PARK_RETIRE)
+    {
+        if (mgr->park == SPI_BUS_PARK_DELAY)
+            mgr->timer_fired = 0U;
+        if (t->kind == SPI_BUS_ITEM_DELAY)
+        {
+            spi_trace(SPI_BUS_TRACE_DONE, &mgr->q, 0u, 0u);
+            spi_bus_pop(&mgr->q);
+        }
+        else
+        {
+            spi_trace(SPI_BUS_TRACE_RESUME, &mgr->q, t->dev, mgr->prog_pc);
+            if (mgr->park == SPI_BUS_PARK_READY)
+                spi_stats_post_wait(mgr, waited);
+        }
+        mgr->park = SPI_BUS_PARK_RETIRE;
+        mgr->waiting = false;
+        spi_bus_unlock(&mgr->engine_lock);
+        spi_bus_try_start(mgr);
+        return;
+    }
+
+    if (t)
+    {
+        spi_trace(ready ? SPI_BUS_TRACE_DONE : SPI_BUS_TRACE_WAIT_TIMEOUT, &mgr->q, t->dev, 0u);
+        spi_stats_post_wait(mgr, waited);
+        if (ready)
+        {
+            spi_stats_inc(mgr, completed);
+            spi_bus_notify_done(mgr, t);
+        }
+        else
+        {
+            spi_stats_inc(mgr, failed);
+            spi_bus_notify_error(mgr, t);
+        }
+        mgr->prog_pc = 0;
+        spi_bus_pop(&mgr->q);
+    }
+
+    /* Unpark only after the pop, so the normal lane never restarts the finished head */
+    mgr->waiting = false;
+    spi_bus_unlock(&mgr->engine_lock);
+
     spi_bus_try_start(mgr);
 }
 
@@ -509,25 +1882,130 @@ spi_bus_manager_status spi_bus_manager_enqueue_callback(spi_bus_manager *mgr,
                                                         spi_bus_done_cb cb,
                                                         void *user)
 {
-    spi_dbg_log("enqueue_cb mgr=%p cb=%p user=%p\n", (void *)mgr, (void *)cb, user);
-    if (!mgr || !cb || !mgr->q || mgr->q_capacity == 0)
+    if (!mgr || !cb || !SPI_Q_VALID(&mgr->q))
         return SPI_BUS_MANAGER_ERR_PARAM;
-    if (SPI_Q_FULL(mgr))
-        return SPI_BUS_MANAGER_ERR_FULL;
 
     spi_bus_transaction t;
     /* Zero everything, then set only what callback needs */
     memset(&t, 0, sizeof(t));
     t.kind = SPI_BUS_ITEM_CALLBACK;
-    t.on_done = cb;
+    t.fn = cb;
     t.user = user;
 
     /* Push like normal submit: copy by value */
-    mgr->q[mgr->q_tail] = t;
-    spi_dbg_log("enqueue_cb queued at %u\n", mgr->q_tail);
-    mgr->q_tail = SPI_Q_INCR(mgr->q_tail, mgr->q_capacity);
+    spi_bus_manager_status st = spi_bus_push(&mgr->q, &t);
+    if (st != SPI_BUS_MANAGER_OK)
+    {
+        spi_stats_reject(mgr);
+        return st;
+    }
+    spi_stats_pushed(mgr, &mgr->q);
 
     /* Kick the engine (works from ISR or thread) */
     spi_bus_try_start(mgr);
     return SPI_BUS_MANAGER_OK;
 }
+
+void spi_bus_manager_on_timer(spi_bus_manager *mgr)
+{
+    if (!mgr)
+        return;
+    mgr->timer_fired = 1U;
+    spi_bus_manager_on_tick(mgr);
+}
+
+spi_bus_manager_status spi_bus_manager_enqueue_delay(spi_bus_manager *mgr, uint16_t ms)
+{
+    if (!mgr || ms == 0u || !SPI_Q_VALID(&mgr->q))
+        return SPI_BUS_MANAGER_ERR_PARAM;
+
+    spi_bus_transaction t;
+    memset(&t, 0, sizeof(t));
+    t.kind = SPI_BUS_ITEM_DELAY;
+    t.delay_ms = ms;
+
+    spi_bus_manager_status st = spi_bus_push(&mgr->q, &t);
+    if (st != SPI_BUS_MANAGER_OK)
+    {
+        spi_stats_reject(mgr);
+        return st;
+    }
+    spi_stats_pushed(mgr, &mgr->q);
+
+    spi_bus_try_start(mgr);
+    return SPI_BUS_MANAGER_OK;
+}
+
+/* -------------------------------- Registry --------------------------------- */
+
+spi_bus_manager_status spi_bus_manager_register(spi_bus_manager *mgr)
+{
+    if (!mgr)
+        return SPI_BUS_MANAGER_ERR_PARAM;
+
+    int idx = spi_bus_registry_index(mgr->spi);
+    if (idx < 0)
+        return SPI_BUS_MANAGER_ERR_PARAM;
+
+    if (spi_bus_registry[idx] && spi_bus_registry[idx] != mgr)
+        return SPI_BUS_MANAGER_ERR_BUSY;
+
+    spi_bus_registry[idx] = mgr;
+    return SPI_BUS_MANAGER_OK;
+}
+
+void spi_bus_manager_unregister(spi_bus_manager *mgr)
+{
+    if (!mgr)
+        return;
+
+    int idx = spi_bus_registry_index(mgr->spi);
+    if (idx >= 0 && spi_bus_registry[idx] == mgr)
+        spi_bus_registry[idx] = NULL;
+}
+
+spi_bus_manager *spi_bus_manager_lookup(const SPI_HandleTypeDef *hspi)
+{
+    int idx = spi_bus_registry_index(hspi);
+    if (idx < 0)
+        return NULL;
+
+    spi_bus_manager *mgr = spi_bus_registry[idx];
+    /* Guard against a different handle bound to the same instance */
+    return (mgr && mgr->spi == hspi) ? mgr : NULL;
+}
+
+void spi_bus_manager_dispatch_tx_cplt(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_manager_on_tx_cplt(spi_bus_manager_lookup(hspi), hspi);
+}
+
+void spi_bus_manager_dispatch_txrx_cplt(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_manager_on_txrx_cplt(spi_bus_manager_lookup(hspi), hspi);
+}
+
+void spi_bus_manager_dispatch_tx_half(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_manager_on_tx_half(spi_bus_manager_lookup(hspi), hspi);
+}
+
+void spi_bus_manager_dispatch_txrx_half(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_manager_on_txrx_half(spi_bus_manager_lookup(hspi), hspi);
+}
+
+void spi_bus_manager_dispatch_error(SPI_HandleTypeDef *hspi)
+{
+    spi_bus_manager_on_error(spi_bus_manager_lookup(hspi), hspi);
+}
+
+void spi_bus_manager_tick_all(void)
+{
+    for (int i = 0; i < SPI_BUS_MANAGER_MAX_INSTANCES; ++i)
+    {
+        spi_bus_manager *mgr = spi_bus_registry[i];
+        if (mgr)
+            spi_bus_manager_on_tick(mgr);
+    }
+}